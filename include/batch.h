@@ -0,0 +1,11 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+/* Mutating commands between snapshot checkpoints in batch mode */
+#define BATCH_CHECKPOINT_DEFAULT 10000
+
+int run_batch(FILE *in, long checkpoint_every);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <stdbool.h>
+
+/* Rows are "id,name,grade1,grade2,..."; the grade list may be empty and
+ * ragged. Names containing ',' or '"' are quoted with "" escapes. */
+
+/* First N rejected rows are reported individually, the rest only counted */
+#define CSV_MAX_WARNINGS 10
+
+bool import_csv(const char *path, int *imported, int *skipped);
+bool export_csv(const char *path);
+
+#endif
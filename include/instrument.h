@@ -0,0 +1,78 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+/* Hot-path counters and timers. Build with -DSMS_NO_INSTRUMENT to compile
+ * every hook down to nothing. Counters use relaxed atomics so the
+ * parallel sort and other threads can update them safely. */
+
+typedef enum
+{
+    INSTR_ID_LOOKUP = 0,    /* index_of_id() calls */
+    INSTR_ID_PROBE,         /* hash buckets examined by those lookups */
+    INSTR_STUDENT_REALLOC,  /* students[] reallocations */
+    INSTR_GRADE_REALLOC,    /* grade array resizes */
+    INSTR_GRADE_POOL_CHUNK, /* grade pool chunks allocated */
+    INSTR_SORT,             /* sort_students() calls */
+    INSTR_SORT_COMPARE,     /* key comparisons made while sorting */
+    INSTR_SEARCH,           /* find_student_index() calls */
+    INSTR_BSEARCH_STEP,     /* binary_search_by_id_recursive() steps */
+    INSTR_SAVE,             /* snapshot saves */
+    INSTR_SAVE_BYTES,       /* bytes written by snapshot saves */
+    INSTR_SAVE_PATCH,       /* binary snapshots patched in place */
+    INSTR_LOAD,             /* snapshot loads */
+    INSTR_LOAD_BYTES,       /* bytes read by snapshot loads */
+    INSTR_JOURNAL_APPEND,   /* journal records appended */
+    INSTR_JOURNAL_BYTES,    /* bytes appended to the journal */
+    INSTR_SERVER_CONN,      /* connections accepted by run_server() */
+    INSTR_SERVER_REQUEST,   /* request lines answered by run_server() */
+    INSTR_SERVER_BYTES,     /* response bytes sent by run_server() */
+    INSTR_BACKGROUND_SAVE,  /* snapshots written by the background writer */
+    INSTR_COUNTER_COUNT
+} InstrCounter;
+
+typedef enum
+{
+    INSTR_T_SORT = 0,
+    INSTR_T_SAVE,
+    INSTR_T_LOAD,
+    INSTR_T_JOURNAL,
+    INSTR_T_SNAPSHOT_COPY,
+    INSTR_TIMER_COUNT
+} InstrTimer;
+
+/* Environment variable that makes the process dump counters at exit */
+#define INSTR_ENV "SMS_INSTRUMENT"
+
+/* Request latency histogram: log2 buckets split into 2^INSTR_LAT_SUB_BITS
+ * linear sub-buckets, so percentiles are within 1/8 of the true value */
+#define INSTR_LAT_SUB_BITS 3
+#define INSTR_LAT_BUCKETS ((64 - INSTR_LAT_SUB_BITS + 1) << INSTR_LAT_SUB_BITS)
+
+extern _Atomic uint64_t instr_counters[INSTR_COUNTER_COUNT];
+
+uint64_t instr_now_ns(void);
+void instr_time(InstrTimer t, uint64_t ns);
+void instr_latency(uint64_t ns);
+void instr_reset(void);
+void instr_dump(FILE *out);
+void instr_init_from_env(void);
+
+#ifndef SMS_NO_INSTRUMENT
+#define INSTR_ADD(c, n) atomic_fetch_add_explicit(&instr_counters[(c)], (uint64_t)(n), memory_order_relaxed)
+#define INSTR_INC(c) INSTR_ADD((c), 1)
+#define INSTR_TIMER_START(var) uint64_t var = instr_now_ns()
+#define INSTR_TIMER_STOP(t, var) instr_time((t), instr_now_ns() - (var))
+#define INSTR_LATENCY_STOP(var) instr_latency(instr_now_ns() - (var))
+#else
+#define INSTR_ADD(c, n) ((void)0)
+#define INSTR_INC(c) ((void)0)
+#define INSTR_TIMER_START(var) ((void)0)
+#define INSTR_TIMER_STOP(t, var) ((void)0)
+#define INSTR_LATENCY_STOP(var) ((void)0)
+#endif
+
+#endif
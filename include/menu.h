@@ -2,6 +2,7 @@
 #define MENU_H
 
 void show_help(void);
+void set_page_size(int rows);
 void run_menu(void);
 
 #endif
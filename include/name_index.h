@@ -0,0 +1,38 @@
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include "student.h"
+
+/* Sorted (case-folded name, ID) table behind search_by_name_prefix().
+ * Built on the first query; the insert/remove hooks keep it current
+ * afterwards. Each StudentRegistry embeds one; used by student.c only. */
+
+/* Inserts since the last build that are kept in a small sorted side
+ * table; one more drops the index until the next query rebuilds it */
+#define NAME_INDEX_DELTA_MAX 1024
+
+/* Folded name bytes kept per entry, including the NUL. Names agreeing on
+ * the first NAME_INDEX_KEY_LEN - 1 bytes are ordered by ID, and longer
+ * prefixes are checked against the registry's full names */
+#define NAME_INDEX_KEY_LEN 64
+
+typedef struct NameEntry NameEntry;
+
+typedef struct
+{
+    NameEntry *tab;   /* every student at build time, sorted by (key, id) */
+    int tab_len;
+    int tab_dead;
+    NameEntry *delta; /* inserted since, also sorted; queries merge both */
+    int delta_len;
+    bool built;
+} NameIndex;
+
+void name_index_init(NameIndex *ix);
+void name_index_insert(NameIndex *ix, int id, const char *name);
+void name_index_remove(NameIndex *ix, int id, const char *name);
+void name_index_reset(NameIndex *ix);
+bool name_index_build(NameIndex *ix, StudentRegistry *r);
+int name_index_search(NameIndex *ix, StudentRegistry *r, const char *prefix, int *ids, int max);
+
+#endif
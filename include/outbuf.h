@@ -0,0 +1,34 @@
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Bytes buffered before an OutBuf bound to a FILE is flushed */
+#define OUTBUF_FLUSH_SIZE (256 * 1024)
+
+/* Growable byte buffer with printf-free number writers. Bound to a FILE
+ * it flushes in large fwrite() calls; with fp == NULL it only grows. */
+typedef struct
+{
+    FILE *fp;
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed; /* allocation or write error seen */
+} OutBuf;
+
+void ob_init(OutBuf *b, FILE *fp);
+bool ob_flush(OutBuf *b);
+bool ob_finish(OutBuf *b);
+
+void ob_write(OutBuf *b, const void *src, size_t n);
+void ob_puts(OutBuf *b, const char *s);
+void ob_putc(OutBuf *b, char c);
+void ob_pad(OutBuf *b, const char *s, int width);
+void ob_int(OutBuf *b, long long v);
+void ob_uint(OutBuf *b, unsigned long long v);
+void ob_fixed2(OutBuf *b, double v);
+
+#endif
@@ -5,8 +5,77 @@
 
 #define DATA_FILE "data/students.json"
 
+/* Each data file keeps its own journal, named like it with this suffix
+ * (data/students.json.journal) */
+#define JOURNAL_SUFFIX ".journal"
+
+/* Suffix of the journal's records moved aside while a background save runs */
+#define JOURNAL_OLD_SUFFIX ".old"
+
+/* Files with this extension use the binary snapshot format; anything
+ * else is read and written as JSON. Binary files have fixed-size
+ * records with room to grow, so once the active data file is loaded a
+ * save rewrites only the records and grades of changed students in
+ * place; a full rewrite happens when too much changed or the file ran
+ * out of free records. */
+#define BINARY_EXTENSION ".bin"
+
+/* Compact once the journal holds this many records (or as many records
+ * as there are students, whichever is larger) */
+#define JOURNAL_COMPACT_THRESHOLD 1024
+
+bool set_data_file(const char *path);
+const char *get_data_file(void);
+
+/* Lazy grades: binary snapshots stay mapped and each student's grades
+ * are read from the mapping on first touch. JSON still loads eagerly. */
+void set_lazy_grades(bool enabled);
+
+/* Sharded storage: with n > 1 the data file is split into n files named
+ * like it with ".<k>" before the extension (data/students.0.json ...),
+ * each holding the students whose ID hashes to k. Shards load in
+ * parallel, and saves rewrite only shards whose students changed. */
+#define SHARD_MAX 64
+bool set_shard_count(int n);
+
 bool save_students_to_file(void);
+bool save_students_to_path(const char *path);
 
 bool load_students_from_file(void);
+bool load_students_from_path(const char *path);
+
+/* Write-ahead journal: one appended record per mutation */
+bool journal_add_student(int id, const char *name);
+bool journal_add_grade(int id, float grade);
+bool journal_rename_student(int id, const char *name);
+bool journal_delete_student(int id);
+
+bool replay_journal(void);
+bool compact_journal(void);
+void close_journal(void);
+
+/* Background saves: a journal append that triggers compaction copies
+ * the registry instead (registry_clone()) and a writer thread saves the
+ * copy while edits go on. A save starts once every records are pending
+ * (0 = the JOURNAL_COMPACT_THRESHOLD rule), checked as records arrive,
+ * or once the oldest pending record is delay_ms old (0 = no time
+ * limit), which the writer thread waits for itself; records appended
+ * during a save wait for the next one. Only one save runs at a time.
+ * save_students_to_file() and compact_journal() wait for it first;
+ * stop_background_save() also ends the thread and must run before
+ * free_students(). */
+void set_background_save(bool enabled, long every, long delay_ms);
+void flush_background_save(void);
+void stop_background_save(void);
+
+/* A timed save copies the registry from the writer thread. Callers that
+ * journal changes hold journal_lock() around each change (or reorder,
+ * or compaction) together with its journal_*() record and around their
+ * own save_students_to_file() / compact_journal() calls, so the copy
+ * never sees half a change. Taken after any lock of the caller's own,
+ * never while waiting for input, and not around stop_background_save(),
+ * whose join may wait for a timed save that needs it. */
+void journal_lock(void);
+void journal_unlock(void);
 
 #endif
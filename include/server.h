@@ -0,0 +1,24 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/* Longest request line accepted; longer lines close the connection */
+#define SERVER_LINE_MAX 4096
+
+/* Rows returned by one list/top/bottom/name reply */
+#define SERVER_LIST_MAX 1000
+
+/* Unsent reply bytes at which a connection stops reading new requests */
+#define SERVER_OUT_MAX (1024 * 1024)
+
+/* Event loops started when --serve-threads is not given (0 = one per CPU) */
+#define SERVER_THREADS_DEFAULT 0
+
+/* Upper bound on event loop threads */
+#define SERVER_THREADS_MAX 64
+
+/* Serve the line protocol on endpoint until SIGINT or SIGTERM.
+ * "PORT" listens on 127.0.0.1, "ADDR:PORT" on that IPv4 address, and
+ * anything else is a unix socket path. Returns 0 on a clean shutdown. */
+int run_server(const char *endpoint, int threads);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include "student.h"
+
+/* Averages at or above this count as passing in stats_menu() (grades are 0-100) */
+#define STATS_PASS_MARK 50.0f
+
+/* Length of the leaderboards printed by stats_menu() */
+#define STATS_TOP_K 10
+
+/* Rows (each HIST_MAX / STATS_HIST_ROWS points) and widest bar of the
+ * histograms printed by stats_menu() */
+#define STATS_HIST_ROWS 10
+#define STATS_HIST_BAR 40
+
+typedef struct
+{
+    int count;            /* students scanned */
+    int ungraded;         /* students with no grades */
+    long long totalGrades;
+    float highest;
+    int highestIdx;       /* first student with the highest average */
+    float lowest;
+    int lowestIdx;        /* first student with the lowest average */
+    double mean;          /* mean of the averages */
+    double variance;      /* population variance of the averages */
+    float threshold;
+    int atOrAbove;        /* students whose average >= threshold */
+} ClassStats;
+
+bool class_stats(float threshold, ClassStats *out);
+bool class_highest_lowest(float *highest, int *h_idx, float *lowest, int *l_idx);
+
+/* Histogram queries, exact to HIST_BUCKET_WIDTH: values in [lo, hi)
+ * (hi above HIST_MAX takes the last bucket too), and the pct-th
+ * percentile interpolated within its bucket */
+long long histogram_count_range(const Histogram *h, float lo, float hi);
+bool histogram_percentile(const Histogram *h, float pct, float *out);
+
+#endif
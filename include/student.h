@@ -2,31 +2,221 @@
 #define STUDENT_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-#define NAME_LEN 50
+/* Longest name kept, including the terminating NUL; longer names are
+ * truncated. Names live in a per-registry arena, so a student only
+ * pays for its own name's bytes. */
+#define NAME_LEN 256
 
+/* Bytes a name of len characters takes in a name arena and in binary
+ * snapshots: the NUL included, zero-padded to a multiple of 4 */
+#define NAME_STORED_SIZE(len) (((uint32_t)(len) + 4u) & ~3u)
+
+/* Stored form of one grade. Built with -DSMS_QUANTIZED_GRADES a grade
+ * is a uint16_t count of hundredths of a point (grades are entered and
+ * saved to two decimals anyway): half the memory of a float, running
+ * sums and averages computed exactly from integers, and compact binary
+ * snapshots. The float functions below convert on the way in and out. */
+#ifdef SMS_QUANTIZED_GRADES
+typedef uint16_t GradeValue;
+#else
+typedef float GradeValue;
+#endif
+
+/* Quantized grade units per point, also used by packed snapshots */
+#define GRADE_SCALE 100
+
+/**
+ * grade_quantize - Stored form of a grade
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Quantized builds round to the nearest hundredth and clamp to
+ * [0, 655.35]; NaN stores as 0. Otherwise the float is kept as is.
+ *
+ * Overall: O(1)
+ */
+static inline GradeValue grade_quantize(float g)
+{
+#ifdef SMS_QUANTIZED_GRADES
+    if (!(g > 0.0f))
+        return 0;
+    if (g >= 65535.0f / GRADE_SCALE)
+        return UINT16_MAX;
+    return (GradeValue)(g * GRADE_SCALE + 0.5f);
+#else
+    return g;
+#endif
+}
+
+/**
+ * grade_value - A stored grade as a float
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static inline float grade_value(GradeValue g)
+{
+#ifdef SMS_QUANTIZED_GRADES
+    return (float)g / GRADE_SCALE;
+#else
+    return g;
+#endif
+}
+
+/* Grades per grade pool chunk (runs larger than this get their own chunk) */
+#define GRADE_POOL_CHUNK 65536
+
+/* Grades kept inside a student's cold record (its 32 bytes of inline
+ * storage); a student with more takes a heap (or pooled) run instead */
+#define GRADE_INLINE (32 / (int)sizeof(GradeValue))
+
+/* Who owns a student's grade array */
+typedef enum
+{
+    GRADES_HEAP = 0, /* malloc'ed, freed with the student */
+    GRADES_POOLED,   /* carved from the grade pool */
+    GRADES_MAPPED,   /* read-only view into an adopted snapshot mapping */
+    GRADES_INLINE    /* StudentCold.inline_grades */
+} GradeStorage;
+
+/* Cold half of a student: only read to print, save or grade one student.
+ * Registries allocate these from fixed slabs, so the address never
+ * changes while students[] is sorted, compacted or grown, and grades
+ * may point into inline_grades. */
+typedef struct
+{
+    GradeValue *grades; /* inline_grades, or a heap, pooled or mapped run */
+    int gradeCapacity;
+    unsigned char gradeStorage; /* GradeStorage of grades */
+#ifdef SMS_QUANTIZED_GRADES
+    uint64_t gradeSum;  /* exact sum of grades, in hundredths */
+#else
+    float gradeSum;     /* running (Kahan-compensated) sum of grades */
+    float gradeSumComp; /* Kahan compensation term for gradeSum */
+#endif
+    GradeValue inline_grades[GRADE_INLINE];
+    uint32_t name_off; /* name's bytes in the registry's name arena */
+    uint32_t name_len; /* without the NUL */
+} StudentCold;
+
+/* Hot half: the fields sorting, ranking and the ID index read, 24 bytes
+ * a slot. Sorts and compaction move only this. */
 typedef struct
 {
     int id;
-    char name[NAME_LEN];
-    float *grades;
     int gradeCount;
     float average;
+    unsigned char dead;  /* tombstone left by delete_student() */
+    unsigned char dirty; /* changed since the last save (dirty tracking) */
+    StudentCold *cold;   /* name and grades; NULL once dead */
 } Student;
 
+/**
+ * student_grades - A live student's gradeCount grades
+ *
+ * Time Complexity: O(1) - the first GRADE_INLINE grades share the cold
+ *                  record's cache lines
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static inline const GradeValue *student_grades(const Student *s)
+{
+    return s->cold->grades;
+}
+
+/**
+ * student_grade - A live student's j-th grade as a float
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static inline float student_grade(const Student *s, int j)
+{
+    return grade_value(s->cold->grades[j]);
+}
+
+/* Distribution histograms, kept current on every change: HIST_BUCKETS
+ * buckets of HIST_BUCKET_WIDTH points, bucket k holding [k × width,
+ * (k + 1) × width) and the last one exactly HIST_MAX. Values outside
+ * [0, HIST_MAX] count in the end buckets. */
+#define HIST_MAX 100.0f
+#define HIST_BUCKET_WIDTH 0.5f
+#define HIST_BUCKETS 201
+
+typedef struct
+{
+    long long count[HIST_BUCKETS];
+    long long total;
+} Histogram;
+
+/**
+ * histogram_bucket - Bucket a value falls into
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) - NaN goes to bucket 0
+ */
+static inline int histogram_bucket(float v)
+{
+    if (!(v > 0.0f))
+        return 0;
+    if (v >= HIST_MAX)
+        return HIST_BUCKETS - 1;
+    int k = (int)(v / HIST_BUCKET_WIDTH);
+    return k < HIST_BUCKETS - 1 ? k : HIST_BUCKETS - 2;
+}
+
+/* verify_averages() reports students whose running average differs from a
+ * full recompute by more than this */
+#define AVERAGE_DRIFT_TOLERANCE 0.005f
+
+/* delete_student() only marks its slot dead; the live slots are packed
+ * once at least this percentage of slots, and TOMBSTONE_COMPACT_MIN
+ * slots, are tombstones */
+#define TOMBSTONE_COMPACT_PERCENT 25
+#define TOMBSTONE_COMPACT_MIN 64
+
 void init_students(void);
 void free_students(void);
 
+void set_grade_pool_enabled(bool enabled);
+
 bool add_student(int id, const char *name);
+bool add_student_with_grades(int id, const char *name, const float *grades, int count);
+bool add_student_with_grade_values(int id, const char *name, const GradeValue *grades, int count);
+bool add_student_with_mapped_grades(int id, const char *name, const GradeValue *grades, int count, float average);
+void adopt_grade_mapping(void *base, size_t size, void (*release)(void *base, size_t size));
+void reserve_students(int count);
 bool delete_student(int id);
+void compact_students(void);
+void shrink_students_to_fit(void);
 bool update_student_name(int id, const char *newname);
 
 bool add_grade_to_student(int id, float grade);
+bool add_grades_to_student(int id, const float *grades, int count);
+float sum_grades(const float *grades, int n);
 float sum_grades_recursive(const float *grades, int n);
+#ifdef SMS_QUANTIZED_GRADES
+uint64_t sum_grade_values(const GradeValue *grades, int n);
+#endif
 void recalc_average(Student *s);
+int verify_averages(void);
 
 void display_all_students(void);
 void display_grade_matrix(void);
+/* Rows [first, first + count) only; count <= 0 shows the rest */
+void display_students_page(int first, int count);
+void display_grade_matrix_page(int first, int count);
 
 typedef enum
 {
@@ -37,16 +227,137 @@ typedef enum
 {
     BUBBLE = 1,
     INSERTION = 2,
-    MERGE = 3
+    MERGE = 3,
+    RADIX = 4
 } SortMethod;
 
+/* MERGE uses the multi-threaded path from this many students up */
+#define PARALLEL_SORT_THRESHOLD 65536
+#define MAX_SORT_THREADS 64
+
 void sort_students(SortMethod method, SortKey key);
+void set_sort_threads(int threads);
 
 int binary_search_by_id_recursive(int target_id, int left, int right);
+int find_student_index(int id);
+
+/* Case-insensitive name prefix lookup over a sorted name index; writes
+ * at most max IDs in name order and returns how many */
+int search_by_name_prefix(const char *prefix, int *ids, int max);
+
+/* Queries compact tombstones and build the name index on demand, so they
+ * may write. Once prepare_student_reads() has run they only read until
+ * the next add, rename or delete, and may then share a reader lock. */
+bool student_reads_ready(void);
+void prepare_student_reads(void);
 
-bool class_highest_lowest(float *highest, int *h_idx, float *lowest, int *l_idx);
+/* Ranking queries over averages; students[] order is left untouched.
+ * top/bottom write at most k slots to out and return how many. */
+int top_k_by_average(int k, int *out);
+int bottom_k_by_average(int k, int *out);
+bool kth_smallest_average(int k, float *out);
+bool average_percentile(float pct, float *out);
 
+/* Histograms of every grade and of every student's average (ungraded
+ * students count at 0). Read-only; valid until the next change. */
+const Histogram *grade_histogram(void);
+const Histogram *average_histogram(void);
+
+/* A live student's name; valid until the next add, rename or delete */
+const char *student_name(const Student *s);
+
+/* students_count() is the number of live students; slots run up to
+ * student_slots() and get_student_by_index() is NULL for a tombstone */
 int students_count(void);
+int student_slots(void);
 Student *get_student_by_index(int idx);
 
+/* Columnar views of the hot fields, element i mirrors student i.
+ * Tombstones are compacted away first. Read-only; valid until the next
+ * insertion or delete. */
+const int *student_id_column(void);
+const float *student_average_column(void);
+const int *student_grade_count_column(void);
+
+/* Registry handles. A StudentRegistry owns its students, indexes, grade
+ * pool and sort buffers; registries share nothing, so each may be used
+ * from its own thread (calls on one registry must not overlap). Every
+ * function above is registry_<name>() applied to default_registry();
+ * init_students() and free_students() are registry_init() and
+ * registry_free(). */
+typedef struct StudentRegistry StudentRegistry;
+
+StudentRegistry *registry_create(void);
+void registry_destroy(StudentRegistry *r);
+StudentRegistry *default_registry(void);
+
+void registry_init(StudentRegistry *r);
+void registry_free(StudentRegistry *r);
+void registry_set_grade_pool_enabled(StudentRegistry *r, bool enabled);
+bool registry_grade_pool_enabled(StudentRegistry *r);
+void registry_set_change_hook(StudentRegistry *r, void (*fn)(int id, void *ctx), void *ctx);
+
+/* Dirty tracking for incremental saves: changed students get their
+ * dirty bit set and their ID listed once until registry_clear_dirty().
+ * registry_dirty_ids() returns -1 if every student must count as dirty. */
+void registry_set_dirty_tracking(StudentRegistry *r, bool enabled);
+int registry_dirty_ids(StudentRegistry *r, const int **ids);
+void registry_clear_dirty(StudentRegistry *r);
+
+bool registry_add_student(StudentRegistry *r, int id, const char *name);
+bool registry_add_student_with_grades(StudentRegistry *r, int id, const char *name, const float *grades, int count);
+bool registry_add_student_with_grade_values(StudentRegistry *r, int id, const char *name, const GradeValue *grades,
+                                            int count);
+bool registry_add_student_with_mapped_grades(StudentRegistry *r, int id, const char *name, const GradeValue *grades,
+                                             int count, float average);
+void registry_adopt_grade_mapping(StudentRegistry *r, void *base, size_t size,
+                                  void (*release)(void *base, size_t size));
+void registry_reserve_students(StudentRegistry *r, int count);
+bool registry_delete_student(StudentRegistry *r, int id);
+void registry_compact_students(StudentRegistry *r);
+void registry_shrink_students_to_fit(StudentRegistry *r);
+bool registry_update_student_name(StudentRegistry *r, int id, const char *newname);
+int registry_merge(StudentRegistry *dst, StudentRegistry *src);
+StudentRegistry *registry_clone(StudentRegistry *src);
+
+bool registry_add_grade_to_student(StudentRegistry *r, int id, float grade);
+bool registry_add_grades_to_student(StudentRegistry *r, int id, const float *grades, int count);
+void registry_recalc_average(StudentRegistry *r, Student *s);
+int registry_verify_averages(StudentRegistry *r);
+
+void registry_display_all_students(StudentRegistry *r);
+void registry_display_grade_matrix(StudentRegistry *r);
+void registry_display_students_page(StudentRegistry *r, int first, int count);
+void registry_display_grade_matrix_page(StudentRegistry *r, int first, int count);
+
+void registry_sort_students(StudentRegistry *r, SortMethod method, SortKey key);
+int registry_binary_search_by_id_recursive(StudentRegistry *r, int target_id, int left, int right);
+int registry_find_student_index(StudentRegistry *r, int id);
+int registry_search_by_name_prefix(StudentRegistry *r, const char *prefix, int *ids, int max);
+bool registry_reads_ready(StudentRegistry *r);
+void registry_prepare_reads(StudentRegistry *r);
+
+int registry_top_k_by_average(StudentRegistry *r, int k, int *out);
+int registry_bottom_k_by_average(StudentRegistry *r, int k, int *out);
+bool registry_kth_smallest_average(StudentRegistry *r, int k, float *out);
+bool registry_average_percentile(StudentRegistry *r, float pct, float *out);
+const Histogram *registry_grade_histogram(StudentRegistry *r);
+const Histogram *registry_average_histogram(StudentRegistry *r);
+
+int registry_students_count(StudentRegistry *r);
+int registry_student_slots(StudentRegistry *r);
+Student *registry_get_student_by_index(StudentRegistry *r, int idx);
+
+const char *registry_student_name(StudentRegistry *r, const Student *s);
+
+/* The name arena: StudentCold.name_off indexes it, every name starts on
+ * a 4-byte boundary and is NUL-padded up to the next one, so it can be
+ * written to a file as is. *garbage is the bytes of names no student
+ * uses any more. */
+const char *registry_name_arena(StudentRegistry *r, uint32_t *used, uint32_t *garbage);
+
+const int *registry_student_id_column(StudentRegistry *r);
+const float *registry_student_average_column(StudentRegistry *r);
+const int *registry_student_grade_count_column(StudentRegistry *r);
+
 #endif
@@ -0,0 +1,320 @@
+#define _POSIX_C_SOURCE 200809L
+#include "batch.h"
+#include "student.h"
+#include "persistence.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* Consecutive grade commands for one ID, applied with a single lookup */
+typedef struct
+{
+    int id;
+    long line; /* first input line contributing to the run */
+    float *grades;
+    int count;
+    int cap;
+} GradeRun;
+
+/**
+ * skip_space - Advance past blanks
+ *
+ * Time Complexity: O(k) where k is blanks skipped
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k)
+ */
+static char *skip_space(char *p)
+{
+    while (isspace((unsigned char)*p))
+        p++;
+    return p;
+}
+
+/**
+ * parse_id - Parse the student ID argument of a command
+ *
+ * Time Complexity: O(k) where k is token length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. strtol() - O(k)
+ * 2. Range and terminator check - O(1): Must be followed by a blank
+ *    or end of line
+ *
+ * Overall: O(k)
+ */
+static bool parse_id(char **p, int *id)
+{
+    char *end;
+    long v = strtol(*p, &end, 10);
+    if (end == *p || v < 0 || v > 0x7fffffffL || (*end && !isspace((unsigned char)*end)))
+        return false;
+    *id = (int)v;
+    *p = skip_space(end);
+    return true;
+}
+
+/**
+ * parse_name - Take the rest of the line as a name
+ *
+ * Time Complexity: O(k) where k is remaining length
+ * Space Complexity: O(1) - trims in place
+ *
+ * Complexity Analysis:
+ * 1. strlen() + trim trailing blanks - O(k)
+ *
+ * Names may contain spaces; add_student() truncates to NAME_LEN - 1.
+ *
+ * Overall: O(k)
+ */
+static bool parse_name(char *p)
+{
+    size_t n = strlen(p);
+    while (n > 0 && isspace((unsigned char)p[n - 1]))
+        p[--n] = '\0';
+    return n > 0;
+}
+
+/**
+ * flush_grades - Apply the pending grade run
+ *
+ * Time Complexity: O(c) amortized where c is grades in the run
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. add_grades_to_student() - O(c): One lookup and at most one
+ *    grade array growth for the whole run
+ * 2. Reset the run - O(1)
+ *
+ * Returns false if the student did not exist.
+ *
+ * Overall: O(c) amortized
+ */
+static bool flush_grades(GradeRun *run)
+{
+    if (run->count == 0)
+        return true;
+    bool ok = add_grades_to_student(run->id, run->grades, run->count);
+    if (!ok)
+        fprintf(stderr, "line %ld: student with ID %d not found\n", run->line, run->id);
+    run->count = 0;
+    return ok;
+}
+
+/**
+ * queue_grade - Add one grade to the pending run
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(c) for the run buffer, reused across runs
+ *
+ * Complexity Analysis:
+ * 1. Different ID - flush_grades() first, O(c)
+ * 2. Grow the run buffer geometrically - amortized O(1)
+ * 3. Store the grade - O(1)
+ *
+ * Overall: O(1) amortized
+ */
+static bool queue_grade(GradeRun *run, int id, float grade, long line, int *failed)
+{
+    if (run->count > 0 && run->id != id && !flush_grades(run))
+        (*failed)++;
+    if (run->count == 0)
+    {
+        run->id = id;
+        run->line = line;
+    }
+    if (run->count == run->cap)
+    {
+        int newcap = run->cap ? run->cap * 2 : 16;
+        float *tmp = realloc(run->grades, (size_t)newcap * sizeof(float));
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed (batch grades).\n");
+            return false;
+        }
+        run->grades = tmp;
+        run->cap = newcap;
+    }
+    run->grades[run->count++] = grade;
+    return true;
+}
+
+/**
+ * print_student - Print one "find" result
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void print_student(int id)
+{
+    int idx = find_student_index(id);
+    if (idx == -1)
+    {
+        printf("%d not found\n", id);
+        return;
+    }
+    Student *s = get_student_by_index(idx);
+    printf("ID=%d Name=%s Avg=%.2f #grades=%d\n", s->id, student_name(s), s->average, s->gradeCount);
+}
+
+/**
+ * run_batch - Execute line commands without prompts, persisting in bulk
+ *
+ * Time Complexity: O(L + c × n × g) where L is input size and c is
+ *                  number of checkpoints
+ * Space Complexity: O(l + r) for the longest line and grade run
+ *
+ * Complexity Analysis:
+ * 1. getline() per command - O(l)
+ * 2. Dispatch on the command word:
+ *    - add <id> <name>        add_student() - O(1) amortized
+ *    - grade <id> <g> [g...]  queued: consecutive grades for the same
+ *                             ID are applied with one lookup
+ *    - rename <id> <name>     update_student_name() - O(1)
+ *    - del <id>               delete_student() - O(1) amortized
+ *    - find <id>              find_student_index() - O(1) expected
+ *    - save                   checkpoint now
+ *    - compact                shrink_students_to_fit() - O(n), after
+ *                             a purge
+ *    Blank lines and lines starting with '#' are ignored.
+ * 3. Any command other than grade flushes the pending run first, so
+ *    commands take effect in input order
+ * 4. Checkpoint every checkpoint_every mutations - O(n × g):
+ *    compact_journal() writes one snapshot; no per-command journal
+ *    records are written in batch mode
+ * 5. Final checkpoint - O(n × g)
+ *
+ * Commands after the last checkpoint are lost if the process dies, in
+ * exchange for one snapshot write per checkpoint instead of per edit.
+ * checkpoint_every ≤ 0 saves only at the end.
+ *
+ * Overall: returns the number of failed commands
+ */
+int run_batch(FILE *in, long checkpoint_every)
+{
+    GradeRun run = {0};
+    char *line = NULL;
+    size_t linecap = 0;
+    long lineno = 0, pending = 0;
+    int failed = 0;
+
+    while (getline(&line, &linecap, in) != -1)
+    {
+        lineno++;
+        char *p = skip_space(line);
+        if (*p == '\0' || *p == '#')
+            continue;
+        char *cmd = p;
+        while (*p && !isspace((unsigned char)*p))
+            p++;
+        size_t cmdlen = (size_t)(p - cmd);
+        p = skip_space(p);
+
+        bool is_grade = cmdlen == 5 && strncmp(cmd, "grade", 5) == 0;
+        if (!is_grade && !flush_grades(&run))
+            failed++;
+
+        int id = 0;
+        bool ok = true;
+        bool mutation = true;
+        if (is_grade)
+        {
+            ok = parse_id(&p, &id) && *p != '\0';
+            /* validate the whole line first so a bad token applies nothing */
+            for (char *q = p; ok && *q;)
+            {
+                char *end;
+                float g = strtof(q, &end);
+                ok = end != q && g >= 0.0f && g <= 100.0f;
+                q = skip_space(end);
+            }
+            while (ok && *p)
+            {
+                char *end;
+                float g = strtof(p, &end);
+                ok = queue_grade(&run, id, g, lineno, &failed);
+                p = skip_space(end);
+            }
+            if (!ok)
+                fprintf(stderr, "line %ld: usage: grade <id> <0-100> [...]\n", lineno);
+        }
+        else if (cmdlen == 3 && strncmp(cmd, "add", 3) == 0)
+        {
+            ok = parse_id(&p, &id) && parse_name(p);
+            if (!ok)
+                fprintf(stderr, "line %ld: usage: add <id> <name>\n", lineno);
+            else if (!(ok = add_student(id, p)))
+                fprintf(stderr, "line %ld: ID %d already exists\n", lineno, id);
+        }
+        else if (cmdlen == 6 && strncmp(cmd, "rename", 6) == 0)
+        {
+            ok = parse_id(&p, &id) && parse_name(p);
+            if (!ok)
+                fprintf(stderr, "line %ld: usage: rename <id> <name>\n", lineno);
+            else if (!(ok = update_student_name(id, p)))
+                fprintf(stderr, "line %ld: student with ID %d not found\n", lineno, id);
+        }
+        else if (cmdlen == 3 && strncmp(cmd, "del", 3) == 0)
+        {
+            ok = parse_id(&p, &id) && *p == '\0';
+            if (!ok)
+                fprintf(stderr, "line %ld: usage: del <id>\n", lineno);
+            else if (!(ok = delete_student(id)))
+                fprintf(stderr, "line %ld: student with ID %d not found\n", lineno, id);
+        }
+        else if (cmdlen == 4 && strncmp(cmd, "find", 4) == 0)
+        {
+            mutation = false;
+            ok = parse_id(&p, &id) && *p == '\0';
+            if (ok)
+                print_student(id);
+            else
+                fprintf(stderr, "line %ld: usage: find <id>\n", lineno);
+        }
+        else if (cmdlen == 7 && strncmp(cmd, "compact", 7) == 0)
+        {
+            mutation = false;
+            shrink_students_to_fit();
+        }
+        else if (cmdlen == 4 && strncmp(cmd, "save", 4) == 0)
+        {
+            mutation = false;
+            if (!compact_journal())
+                failed++;
+            pending = 0;
+        }
+        else
+        {
+            ok = false;
+            fprintf(stderr, "line %ld: unknown command '%.*s'\n", lineno, (int)cmdlen, cmd);
+        }
+
+        if (!ok)
+        {
+            failed++;
+            continue;
+        }
+        if (!mutation)
+            continue;
+        if (checkpoint_every > 0 && ++pending >= checkpoint_every)
+        {
+            if (!flush_grades(&run))
+                failed++;
+            if (!compact_journal())
+                failed++;
+            pending = 0;
+        }
+    }
+
+    if (!flush_grades(&run))
+        failed++;
+    if (!compact_journal())
+        failed++;
+    fprintf(stderr, "batch: %ld line(s) read, %d failed\n", lineno, failed);
+    free(run.grades);
+    free(line);
+    return failed;
+}
@@ -0,0 +1,397 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "student.h"
+#include "persistence.h"
+#include "stats.h"
+#include "csv.h"
+
+/* Bubble and insertion sort are skipped above this many students */
+#define BENCH_QUADRATIC_LIMIT 20000
+
+typedef struct
+{
+    int students;
+    int grades;
+    uint64_t seed;
+    const char *dir;
+} BenchConfig;
+
+static uint64_t rng_state;
+
+/**
+ * rng_next - xorshift64* pseudo-random generator
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Seeded once per run so every run generates the same registry.
+ *
+ * Overall: O(1)
+ */
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+/**
+ * now_ns - Read the monotonic clock in nanoseconds
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * peak_rss_kb - Peak resident set size of this process so far
+ *
+ * Time Complexity: O(1) - one getrusage() call
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static long peak_rss_kb(void)
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return -1;
+    return ru.ru_maxrss;
+}
+
+/**
+ * report - Print one CSV result row
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Columns: op,students,grades,ops,total_ns,ns_per_op,ops_per_sec,peak_rss_kb
+ *
+ * Overall: O(1)
+ */
+static void report(const char *op, const BenchConfig *cfg, long ops, uint64_t ns)
+{
+    double per = ops > 0 ? (double)ns / (double)ops : 0.0;
+    double rate = ns > 0 ? (double)ops * 1e9 / (double)ns : 0.0;
+    printf("%s,%d,%d,%ld,%llu,%.1f,%.0f,%ld\n", op, cfg->students, cfg->grades, ops,
+           (unsigned long long)ns, per, rate, peak_rss_kb());
+    fflush(stdout);
+}
+
+/**
+ * shuffled_ids - Build a seeded random permutation of IDs 1..n
+ *
+ * Time Complexity: O(n) - Fisher-Yates shuffle
+ * Space Complexity: O(n)
+ *
+ * Overall: O(n)
+ */
+static int *shuffled_ids(int n)
+{
+    int *ids = malloc(n * sizeof(int));
+    if (!ids)
+    {
+        fprintf(stderr, "Memory allocation failed (bench IDs).\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; ++i)
+        ids[i] = i + 1;
+    for (int i = n - 1; i > 0; --i)
+    {
+        int j = (int)(rng_next() % (uint64_t)(i + 1));
+        int t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+    return ids;
+}
+
+/**
+ * bench_build - Time add_student and add_grade_to_student on a fresh registry
+ *
+ * Time Complexity: O(n × g) for the measured operations
+ * Space Complexity: O(n × g) for the registry
+ *
+ * Complexity Analysis:
+ * 1. add_student() n times in shuffled ID order - timed
+ * 2. add_grade_to_student() n × g times, one grade per student per
+ *    round, so grade arrays grow interleaved like a real term - timed
+ *
+ * Overall: O(n × g)
+ */
+static void bench_build(const BenchConfig *cfg, const int *ids)
+{
+    char name[NAME_LEN];
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < cfg->students; ++i)
+    {
+        snprintf(name, sizeof(name), "Student %d", ids[i]);
+        add_student(ids[i], name);
+    }
+    report("add_student", cfg, cfg->students, now_ns() - t0);
+
+    t0 = now_ns();
+    for (int r = 0; r < cfg->grades; ++r)
+        for (int i = 0; i < cfg->students; ++i)
+            add_grade_to_student(ids[i], (float)(rng_next() % 10001) / 100.0f);
+    report("add_grade_to_student", cfg, (long)cfg->students * cfg->grades, now_ns() - t0);
+}
+
+/**
+ * bench_sorts - Time every SortMethod × SortKey combination
+ *
+ * Time Complexity: O(n²) for bubble/insertion (capped), O(n log n) otherwise
+ * Space Complexity: O(n) sort buffers
+ *
+ * Complexity Analysis:
+ * 1. For each method and key:
+ *    - Untimed radix sort by the other key first, so the input is
+ *      not already in target order
+ *    - sort_students() - timed
+ * 2. BUBBLE and INSERTION skipped above BENCH_QUADRATIC_LIMIT
+ *
+ * Overall: dominated by the slowest enabled method
+ */
+static void bench_sorts(const BenchConfig *cfg)
+{
+    static const struct
+    {
+        SortMethod method;
+        const char *name;
+    } methods[] = {{BUBBLE, "bubble"}, {INSERTION, "insertion"}, {MERGE, "merge"}, {RADIX, "radix"}};
+    static const struct
+    {
+        SortKey key;
+        const char *name;
+    } keys[] = {{SORT_BY_ID, "id"}, {SORT_BY_AVG, "avg"}};
+    char op[64];
+
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+    {
+        if ((methods[m].method == BUBBLE || methods[m].method == INSERTION) &&
+            cfg->students > BENCH_QUADRATIC_LIMIT)
+            continue;
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); ++k)
+        {
+            sort_students(RADIX, keys[k].key == SORT_BY_ID ? SORT_BY_AVG : SORT_BY_ID);
+            snprintf(op, sizeof(op), "sort_%s_%s", methods[m].name, keys[k].name);
+            uint64_t t0 = now_ns();
+            sort_students(methods[m].method, keys[k].key);
+            report(op, cfg, 1, now_ns() - t0);
+        }
+    }
+}
+
+/**
+ * bench_lookups - Time ID lookups and the class statistics scan
+ *
+ * Time Complexity: O(n log n) for binary search, O(n) for the hash index
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Sort by ID (untimed) - binary search prerequisite
+ * 2. binary_search_by_id_recursive() n times - timed
+ * 3. find_student_index() n times - timed
+ * 4. class_stats(), top_k_by_average() and the median once each - timed
+ *
+ * Overall: O(n log n)
+ */
+static void bench_lookups(const BenchConfig *cfg, const int *ids)
+{
+    sort_students(RADIX, SORT_BY_ID);
+    int n = students_count();
+    long found = 0;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < cfg->students; ++i)
+        found += binary_search_by_id_recursive(ids[i], 0, n - 1) >= 0;
+    report("binary_search_by_id_recursive", cfg, cfg->students, now_ns() - t0);
+
+    t0 = now_ns();
+    for (int i = 0; i < cfg->students; ++i)
+        found += find_student_index(ids[i]) >= 0;
+    report("find_student_index", cfg, cfg->students, now_ns() - t0);
+
+    if (found != 2L * cfg->students)
+        fprintf(stderr, "bench: lookup mismatch (%ld found)\n", found);
+
+    ClassStats st;
+    t0 = now_ns();
+    class_stats(STATS_PASS_MARK, &st);
+    report("class_stats", cfg, 1, now_ns() - t0);
+
+    int top[STATS_TOP_K];
+    t0 = now_ns();
+    top_k_by_average(STATS_TOP_K, top);
+    report("top_k_by_average", cfg, 1, now_ns() - t0);
+
+    float median;
+    t0 = now_ns();
+    average_percentile(50.0f, &median);
+    report("average_percentile", cfg, 1, now_ns() - t0);
+}
+
+/**
+ * load_csv - import_csv() with the load_students_from_path() signature
+ *
+ * Time Complexity: O(B + n × g)
+ * Space Complexity: O(n × g)
+ *
+ * Overall: O(B + n × g)
+ */
+static bool load_csv(const char *path)
+{
+    int imported, skipped;
+    return import_csv(path, &imported, &skipped) && skipped == 0;
+}
+
+/**
+ * bench_persistence - Time save and load for each snapshot format and CSV
+ *
+ * Time Complexity: O(n × g) per format
+ * Space Complexity: O(n × g) - registry is reloaded from each file
+ *
+ * Complexity Analysis:
+ * 1. Save (save_students_to_path() / export_csv()) - timed, ops =
+ *    students written
+ * 2. free_students() + init_students() - untimed
+ * 3. Load (load_students_from_path() / import_csv()) - timed, ops =
+ *    students read
+ * 4. Temporary file removed afterwards
+ *
+ * Overall: O(n × g)
+ */
+static void bench_persistence(const BenchConfig *cfg)
+{
+    static const struct
+    {
+        const char *ext;
+        bool (*save)(const char *path);
+        bool (*load)(const char *path);
+    } formats[] = {
+        {".json", save_students_to_path, load_students_from_path},
+        {BINARY_EXTENSION, save_students_to_path, load_students_from_path},
+        {".csv", export_csv, load_csv},
+    };
+    char path[512], op[64];
+    for (size_t e = 0; e < sizeof(formats) / sizeof(formats[0]); ++e)
+    {
+        const char *fmt = formats[e].ext + 1;
+        snprintf(path, sizeof(path), "%s/sms-bench-%ld%s", cfg->dir, (long)getpid(), formats[e].ext);
+
+        snprintf(op, sizeof(op), "save_%s", fmt);
+        uint64_t t0 = now_ns();
+        bool ok = formats[e].save(path);
+        report(op, cfg, students_count(), now_ns() - t0);
+
+        free_students();
+        init_students();
+        snprintf(op, sizeof(op), "load_%s", fmt);
+        t0 = now_ns();
+        ok = ok && formats[e].load(path);
+        report(op, cfg, students_count(), now_ns() - t0);
+
+        struct stat st;
+        if (stat(path, &st) == 0)
+            printf("# %s file size: %lld bytes\n", fmt, (long long)st.st_size);
+        remove(path);
+        if (!ok || students_count() != cfg->students)
+            fprintf(stderr, "bench: %s round trip lost students\n", fmt);
+    }
+}
+
+/**
+ * print_usage - Print command-line usage
+ *
+ * Time Complexity: O(1) - constant number of print operations
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void print_usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [--preset 1k|100k|1M] [-n STUDENTS] [-g GRADES] [--seed S] [--dir DIR]\n", prog);
+}
+
+/**
+ * main - Benchmark driver: build, sort, search and persist a synthetic registry
+ *
+ * Time Complexity: O(n × g + n log n), plus O(n²) quadratic sorts for small n
+ * Space Complexity: O(n × g)
+ *
+ * Complexity Analysis:
+ * 1. Parse options - O(a)
+ * 2. shuffled_ids() - O(n)
+ * 3. bench_build(), bench_sorts(), bench_lookups(), bench_persistence()
+ *
+ * Output is CSV on stdout; lines starting with '#' are comments.
+ *
+ * Overall: O(n × g + n log n)
+ */
+int main(int argc, char **argv)
+{
+    BenchConfig cfg = {1000, 5, 42, "/tmp"};
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--preset") == 0 && i + 1 < argc)
+        {
+            const char *p = argv[++i];
+            if (strcmp(p, "1k") == 0)
+                cfg.students = 1000;
+            else if (strcmp(p, "100k") == 0)
+                cfg.students = 100000;
+            else if (strcmp(p, "1M") == 0)
+                cfg.students = 1000000;
+            else
+            {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            cfg.students = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+            cfg.grades = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            cfg.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+            cfg.dir = argv[++i];
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.students <= 0 || cfg.grades < 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    rng_state = cfg.seed ? cfg.seed : 1;
+    int *ids = shuffled_ids(cfg.students);
+
+    printf("op,students,grades,ops,total_ns,ns_per_op,ops_per_sec,peak_rss_kb\n");
+    init_students();
+    bench_build(&cfg, ids);
+    bench_sorts(&cfg);
+    bench_lookups(&cfg, ids);
+    bench_persistence(&cfg);
+    free_students();
+    free(ids);
+    return 0;
+}
@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+#include "instrument.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+_Atomic uint64_t instr_counters[INSTR_COUNTER_COUNT];
+
+/* Accumulated nanoseconds and number of timed calls per timer */
+static _Atomic uint64_t instr_timer_ns[INSTR_TIMER_COUNT];
+static _Atomic uint64_t instr_timer_calls[INSTR_TIMER_COUNT];
+
+/* Request latencies: bucket counts, and the clock at the first and the
+ * latest sample so the dump can turn the count into a rate */
+static _Atomic uint64_t instr_lat_buckets[INSTR_LAT_BUCKETS];
+static _Atomic uint64_t instr_lat_total_ns;
+static _Atomic uint64_t instr_lat_max_ns;
+static _Atomic uint64_t instr_lat_first_ns;
+static _Atomic uint64_t instr_lat_last_ns;
+
+#ifndef SMS_NO_INSTRUMENT
+static const char *const counter_names[INSTR_COUNTER_COUNT] = {
+    "id lookups",
+    "id index probes",
+    "students[] reallocs",
+    "grade array reallocs",
+    "grade pool chunks",
+    "sorts",
+    "sort comparisons",
+    "id searches",
+    "binary search steps",
+    "saves",
+    "bytes saved",
+    "patched saves",
+    "loads",
+    "bytes loaded",
+    "journal appends",
+    "journal bytes",
+    "server connections",
+    "server requests",
+    "server bytes sent",
+    "background saves",
+};
+
+static const char *const timer_names[INSTR_TIMER_COUNT] = {
+    "sort",
+    "save",
+    "load",
+    "journal append",
+    "snapshot copy",
+};
+#endif
+
+/**
+ * instr_now_ns - Read the monotonic clock in nanoseconds
+ *
+ * Time Complexity: O(1) - one clock_gettime() (vDSO, no syscall)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+uint64_t instr_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * instr_time - Add one timed call to a timer
+ *
+ * Time Complexity: O(1) - two relaxed atomic adds
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void instr_time(InstrTimer t, uint64_t ns)
+{
+    atomic_fetch_add_explicit(&instr_timer_ns[t], ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&instr_timer_calls[t], 1, memory_order_relaxed);
+}
+
+/**
+ * lat_bucket - Histogram bucket of a latency
+ *
+ * Time Complexity: O(1) - one count-leading-zeros
+ * Space Complexity: O(1)
+ *
+ * Values below 2^INSTR_LAT_SUB_BITS get a bucket each; above that the
+ * top bit picks the power of two and the next INSTR_LAT_SUB_BITS bits
+ * the linear sub-bucket.
+ *
+ * Overall: O(1)
+ */
+static int lat_bucket(uint64_t ns)
+{
+    const uint64_t sub = 1u << INSTR_LAT_SUB_BITS;
+    if (ns < sub)
+        return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - INSTR_LAT_SUB_BITS;
+    return ((shift + 1) << INSTR_LAT_SUB_BITS) + (int)((ns >> shift) & (sub - 1));
+}
+
+/**
+ * instr_latency - Record one request latency
+ *
+ * Time Complexity: O(1) - a handful of relaxed atomics
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. lat_bucket() and one bucket increment - O(1)
+ * 2. Total and running maximum (CAS loop, rarely retried) - O(1)
+ * 3. First-sample clock set once, latest-sample clock stored - O(1)
+ *
+ * Overall: O(1)
+ */
+void instr_latency(uint64_t ns)
+{
+    atomic_fetch_add_explicit(&instr_lat_buckets[lat_bucket(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&instr_lat_total_ns, ns, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&instr_lat_max_ns, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&instr_lat_max_ns, &max, ns, memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+    uint64_t now = instr_now_ns();
+    uint64_t zero = 0;
+    atomic_compare_exchange_strong_explicit(&instr_lat_first_ns, &zero, now, memory_order_relaxed,
+                                            memory_order_relaxed);
+    atomic_store_explicit(&instr_lat_last_ns, now, memory_order_relaxed);
+}
+
+/**
+ * instr_reset - Zero every counter and timer
+ *
+ * Time Complexity: O(c) where c is number of counters and timers
+ * Space Complexity: O(1)
+ *
+ * Overall: O(c)
+ */
+void instr_reset(void)
+{
+    for (int i = 0; i < INSTR_COUNTER_COUNT; ++i)
+        atomic_store_explicit(&instr_counters[i], 0, memory_order_relaxed);
+    for (int i = 0; i < INSTR_TIMER_COUNT; ++i)
+    {
+        atomic_store_explicit(&instr_timer_ns[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&instr_timer_calls[i], 0, memory_order_relaxed);
+    }
+    for (int i = 0; i < INSTR_LAT_BUCKETS; ++i)
+        atomic_store_explicit(&instr_lat_buckets[i], 0, memory_order_relaxed);
+    atomic_store_explicit(&instr_lat_total_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&instr_lat_max_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&instr_lat_first_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&instr_lat_last_ns, 0, memory_order_relaxed);
+}
+
+#ifndef SMS_NO_INSTRUMENT
+/**
+ * ratio - Safe division for derived metrics
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static double ratio(uint64_t a, uint64_t b)
+{
+    return b ? (double)a / (double)b : 0.0;
+}
+
+/**
+ * lat_bucket_high - Largest latency that falls in a bucket
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Inverse of lat_bucket(); percentiles report this upper edge, so they
+ * never understate.
+ *
+ * Overall: O(1)
+ */
+static uint64_t lat_bucket_high(int b)
+{
+    const int sub = 1 << INSTR_LAT_SUB_BITS;
+    if (b < sub)
+        return (uint64_t)b;
+    int shift = (b >> INSTR_LAT_SUB_BITS) - 1;
+    uint64_t low = (uint64_t)(sub + (b & (sub - 1))) << shift;
+    return low + ((1ull << shift) - 1);
+}
+
+/**
+ * lat_percentile - Latency at or below which pct percent of samples fall
+ *
+ * Time Complexity: O(B) where B is INSTR_LAT_BUCKETS
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Rank = ceil(pct/100 · count) - O(1)
+ * 2. Walk the copied buckets until the running sum reaches it - O(B)
+ *
+ * Overall: O(B)
+ */
+static uint64_t lat_percentile(const uint64_t *buckets, uint64_t count, double pct)
+{
+    uint64_t rank = (uint64_t)ceil(pct / 100.0 * (double)count);
+    if (rank == 0)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < INSTR_LAT_BUCKETS; ++b)
+    {
+        seen += buckets[b];
+        if (seen >= rank)
+            return lat_bucket_high(b);
+    }
+    return lat_bucket_high(INSTR_LAT_BUCKETS - 1);
+}
+
+/**
+ * dump_latency - Print request count, rate and latency percentiles
+ *
+ * Time Complexity: O(B) where B is INSTR_LAT_BUCKETS
+ * Space Complexity: O(B) - a snapshot of the buckets on the stack
+ *
+ * Complexity Analysis:
+ * 1. Copy the buckets and their total - O(B): Concurrent samples may
+ *    land mid-copy; they are counted or not, never half counted
+ * 2. Rate over the first-to-latest sample window - O(1)
+ * 3. lat_percentile() for p50, p90, p99 and p99.9 - O(B) each
+ *
+ * Nothing is printed before the first sample.
+ *
+ * Overall: O(B)
+ */
+static void dump_latency(FILE *out)
+{
+    uint64_t buckets[INSTR_LAT_BUCKETS];
+    uint64_t count = 0;
+    for (int b = 0; b < INSTR_LAT_BUCKETS; ++b)
+    {
+        buckets[b] = atomic_load_explicit(&instr_lat_buckets[b], memory_order_relaxed);
+        count += buckets[b];
+    }
+    if (count == 0)
+        return;
+    uint64_t total = atomic_load_explicit(&instr_lat_total_ns, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&instr_lat_max_ns, memory_order_relaxed);
+    uint64_t first = atomic_load_explicit(&instr_lat_first_ns, memory_order_relaxed);
+    uint64_t last = atomic_load_explicit(&instr_lat_last_ns, memory_order_relaxed);
+    double window = last > first ? (double)(last - first) / 1e9 : 0.0;
+
+    fprintf(out, "Request latency:\n");
+    fprintf(out, "  %-22s %llu in %.3f s, %.0f req/s\n", "requests", (unsigned long long)count, window,
+            window > 0.0 ? (double)count / window : 0.0);
+    fprintf(out, "  %-22s %.1f us\n", "mean", ratio(total, count) / 1e3);
+    static const double pcts[] = {50.0, 90.0, 99.0, 99.9};
+    static const char *const pct_names[] = {"p50", "p90", "p99", "p99.9"};
+    for (int i = 0; i < 4; ++i)
+    {
+        /* a bucket's upper edge may lie past the largest sample */
+        uint64_t v = lat_percentile(buckets, count, pcts[i]);
+        fprintf(out, "  %-22s %.1f us\n", pct_names[i], (v < max ? v : max) / 1e3);
+    }
+    fprintf(out, "  %-22s %.1f us\n", "max", max / 1e3);
+}
+#endif
+
+/**
+ * instr_dump - Print counters, timers and derived per-call metrics
+ *
+ * Time Complexity: O(c) where c is number of counters and timers
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Raw counters - O(c)
+ * 2. Timers with call count and mean - O(t)
+ * 3. Derived: probes per lookup, comparisons per sort, bytes per save,
+ *    load time per MB - O(1)
+ * 4. dump_latency() once server requests were recorded - O(B)
+ *
+ * Overall: O(c + B)
+ */
+void instr_dump(FILE *out)
+{
+#ifdef SMS_NO_INSTRUMENT
+    fprintf(out, "Instrumentation was disabled at compile time (SMS_NO_INSTRUMENT).\n");
+#else
+    uint64_t c[INSTR_COUNTER_COUNT];
+    for (int i = 0; i < INSTR_COUNTER_COUNT; ++i)
+        c[i] = atomic_load_explicit(&instr_counters[i], memory_order_relaxed);
+
+    fprintf(out, "Counters:\n");
+    for (int i = 0; i < INSTR_COUNTER_COUNT; ++i)
+        fprintf(out, "  %-22s %llu\n", counter_names[i], (unsigned long long)c[i]);
+
+    fprintf(out, "Timers:\n");
+    for (int i = 0; i < INSTR_TIMER_COUNT; ++i)
+    {
+        uint64_t ns = atomic_load_explicit(&instr_timer_ns[i], memory_order_relaxed);
+        uint64_t calls = atomic_load_explicit(&instr_timer_calls[i], memory_order_relaxed);
+        fprintf(out, "  %-22s %llu calls, %.3f ms total, %.1f us/call\n", timer_names[i],
+                (unsigned long long)calls, ns / 1e6, ratio(ns, calls) / 1e3);
+    }
+
+    uint64_t load_ns = atomic_load_explicit(&instr_timer_ns[INSTR_T_LOAD], memory_order_relaxed);
+    fprintf(out, "Derived:\n");
+    fprintf(out, "  %-22s %.2f\n", "probes per lookup", ratio(c[INSTR_ID_PROBE], c[INSTR_ID_LOOKUP]));
+    fprintf(out, "  %-22s %.0f\n", "comparisons per sort", ratio(c[INSTR_SORT_COMPARE], c[INSTR_SORT]));
+    fprintf(out, "  %-22s %.0f\n", "bytes per save", ratio(c[INSTR_SAVE_BYTES], c[INSTR_SAVE] + c[INSTR_SAVE_PATCH]));
+    fprintf(out, "  %-22s %.3f\n", "load ms per MB",
+            ratio(load_ns, c[INSTR_LOAD_BYTES]) * (1024.0 * 1024.0) / 1e6);
+    dump_latency(out);
+#endif
+}
+
+/**
+ * dump_at_exit - atexit() hook that prints counters to stderr
+ *
+ * Time Complexity: O(c)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(c)
+ */
+static void dump_at_exit(void)
+{
+    fprintf(stderr, "\n--- %s ---\n", INSTR_ENV);
+    instr_dump(stderr);
+}
+
+/**
+ * instr_init_from_env - Register an exit-time dump if INSTR_ENV is set
+ *
+ * Time Complexity: O(1) - one getenv()
+ * Space Complexity: O(1)
+ *
+ * Any value other than empty or "0" enables the dump.
+ *
+ * Overall: O(1)
+ */
+void instr_init_from_env(void)
+{
+    const char *v = getenv(INSTR_ENV);
+    if (v && *v && strcmp(v, "0") != 0)
+        atexit(dump_at_exit);
+}
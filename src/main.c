@@ -1,7 +1,58 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "student.h"
 #include "menu.h"
 #include "persistence.h"
+#include "instrument.h"
+#include "batch.h"
+#include "csv.h"
+#include "server.h"
+
+/**
+ * print_usage - Print command-line usage
+ *
+ * Time Complexity: O(1) - constant number of print operations
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void print_usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [--data FILE] [--export FILE] [--import-csv FILE] [--export-csv FILE]\n"
+                    "          [--batch FILE] [--checkpoint N] [--limit N] [--grade-pool] [--lazy-grades]\n"
+                    "          [--sort-threads N] [--shards N] [--serve ENDPOINT] [--serve-threads N]\n"
+                    "          [--background-save] [--save-every N] [--save-delay MS]\n", prog);
+    fprintf(stderr, "  --data FILE    data file to use (default %s);\n", DATA_FILE);
+    fprintf(stderr, "                 files ending in %s use the binary snapshot format\n", BINARY_EXTENSION);
+    fprintf(stderr, "  --shards N     split the data file into N shard files STEM.K.EXT loaded in parallel\n");
+    fprintf(stderr, "                 (1-%d; an unsharded file is read once and split on the next save)\n",
+            SHARD_MAX);
+    fprintf(stderr, "  --export FILE  write the loaded registry to FILE (JSON or binary by extension) and exit\n");
+    fprintf(stderr, "  --import-csv FILE  add the rows of a CSV roster (id,name,grade,...) and save\n");
+    fprintf(stderr, "  --export-csv FILE  write the loaded registry as CSV and exit\n");
+    fprintf(stderr, "  --batch FILE   run line commands from FILE ('-' for stdin) without prompts:\n");
+    fprintf(stderr, "                 add ID NAME | grade ID G... | rename ID NAME | del ID | find ID | save\n");
+    fprintf(stderr, "                 | compact (return memory after mass deletes)\n");
+    fprintf(stderr, "  --checkpoint N save a snapshot every N batch changes (default %d, 0 = only at the end)\n",
+            BATCH_CHECKPOINT_DEFAULT);
+    fprintf(stderr, "  --limit N      page the student and grade listings N rows at a time\n");
+    fprintf(stderr, "  --grade-pool   allocate grade arrays from a pooled arena (faster bulk loads)\n");
+    fprintf(stderr, "  --lazy-grades  keep a %s snapshot mapped and read grades on first use\n", BINARY_EXTENSION);
+    fprintf(stderr, "  --sort-threads N  threads for large merge sorts (0 = one per CPU, 1 = off)\n");
+    fprintf(stderr, "  --serve ENDPOINT  answer line commands on a socket until SIGINT/SIGTERM:\n");
+    fprintf(stderr, "                 PORT (127.0.0.1), ADDR:PORT, or a unix socket path; commands are\n");
+    fprintf(stderr, "                 the batch ones plus grades ID | count | stats | top K | bottom K\n");
+    fprintf(stderr, "                 | median | pct P | list FIRST N | name PREFIX | metrics | quit\n");
+    fprintf(stderr, "  --serve-threads N  event loop threads for --serve (0 = one per CPU, max %d)\n",
+            SERVER_THREADS_MAX);
+    fprintf(stderr, "  --background-save  compact the journal from a copy on a writer thread, so edits\n");
+    fprintf(stderr, "                 never wait for a snapshot write\n");
+    fprintf(stderr, "  --save-every N  background save after N journal records (0 = max(%d, students))\n",
+            JOURNAL_COMPACT_THRESHOLD);
+    fprintf(stderr, "  --save-delay MS  also background save once the oldest unsaved record is MS old\n");
+    fprintf(stderr, "Set %s=1 to print instrumentation counters to stderr on exit.\n", INSTR_ENV);
+}
 
 /**
  * main - Entry point of the Student Management System
@@ -10,17 +61,118 @@
  * Space Complexity: O(1) - only uses constant extra space
  *
  * Complexity Analysis:
- * 1. init_students() - O(1): Initialize empty data structures
- * 2. load_students_from_file() - O(n): Load n students from file
- * 3. students_count() - O(1): Return stored count
- * 4. printf() - O(1): Constant time output
- * 5. show_help() - O(1): Print fixed menu
- * 6. run_menu() - O(m): Where m is user operations (varies)
+ * 1. Parse options - O(a): a command-line arguments
+ * 2. instr_init_from_env() - O(1): Arm the counter dump on exit
+ * 3. init_students() - O(1): Initialize empty data structures
+ * 4. load_students_from_file() - O(n): Load n students from file
+ * 5. students_count() - O(1): Return stored count
+ * 6. printf() - O(1): Constant time output
+ * 7. --import-csv / --export-csv / --export: one bulk transfer and
+ *    exit - O(B + n)
+ * 8. --batch: run_batch() and exit - O(m) commands, one snapshot per
+ *    checkpoint instead of one journal record per edit
+ * 9. --serve: run_server() until a stop signal, then stop the
+ *    background writer, compact the journal and exit - O(m) requests
+ * 10. show_help() - O(1): Print fixed menu
+ * 11. run_menu() - O(m): Where m is user operations (varies)
  *
  * Overall: O(n) dominated by file loading operation
  */
-int main(void)
+int main(int argc, char **argv)
 {
+    const char *export_path = NULL;
+    const char *batch_path = NULL;
+    const char *import_csv_path = NULL;
+    const char *export_csv_path = NULL;
+    const char *serve_endpoint = NULL;
+    int serve_threads = SERVER_THREADS_DEFAULT;
+    long checkpoint_every = BATCH_CHECKPOINT_DEFAULT;
+    bool background_save = false;
+    long save_every = 0;
+    long save_delay_ms = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--data") == 0 && i + 1 < argc)
+        {
+            if (!set_data_file(argv[++i]))
+            {
+                fprintf(stderr, "Data file path too long.\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc)
+        {
+            export_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--import-csv") == 0 && i + 1 < argc)
+        {
+            import_csv_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--export-csv") == 0 && i + 1 < argc)
+        {
+            export_csv_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            batch_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+        {
+            checkpoint_every = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc)
+        {
+            set_page_size(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--grade-pool") == 0)
+        {
+            set_grade_pool_enabled(true);
+        }
+        else if (strcmp(argv[i], "--lazy-grades") == 0)
+        {
+            set_lazy_grades(true);
+        }
+        else if (strcmp(argv[i], "--sort-threads") == 0 && i + 1 < argc)
+        {
+            set_sort_threads(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc)
+        {
+            if (!set_shard_count(atoi(argv[++i])))
+            {
+                fprintf(stderr, "Shard count must be 1-%d.\n", SHARD_MAX);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+        {
+            serve_endpoint = argv[++i];
+        }
+        else if (strcmp(argv[i], "--serve-threads") == 0 && i + 1 < argc)
+        {
+            serve_threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--background-save") == 0)
+        {
+            background_save = true;
+        }
+        else if (strcmp(argv[i], "--save-every") == 0 && i + 1 < argc)
+        {
+            save_every = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--save-delay") == 0 && i + 1 < argc)
+        {
+            save_delay_ms = atol(argv[++i]);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    set_background_save(background_save, save_every, save_delay_ms);
+    instr_init_from_env();
     init_students();
 
     /* Load existing data if available */
@@ -29,8 +181,68 @@ int main(void)
         int count = students_count();
         if (count > 0)
         {
-            printf("Loaded %d student(s) from %s\n", count, DATA_FILE);
+            printf("Loaded %d student(s) from %s\n", count, get_data_file());
+        }
+    }
+
+    if (import_csv_path)
+    {
+        int imported, skipped;
+        bool ok = import_csv(import_csv_path, &imported, &skipped);
+        if (ok)
+            printf("Imported %d student(s) from %s, skipped %d row(s)\n", imported, import_csv_path, skipped);
+        ok = ok && compact_journal();
+        close_journal();
+        free_students();
+        return ok ? 0 : 1;
+    }
+
+    if (export_csv_path)
+    {
+        bool ok = export_csv(export_csv_path);
+        if (ok)
+            printf("Exported %d student(s) to %s\n", students_count(), export_csv_path);
+        close_journal();
+        free_students();
+        return ok ? 0 : 1;
+    }
+
+    if (export_path)
+    {
+        bool ok = save_students_to_path(export_path);
+        if (ok)
+            printf("Exported %d student(s) to %s\n", students_count(), export_path);
+        close_journal();
+        free_students();
+        return ok ? 0 : 1;
+    }
+
+    if (batch_path)
+    {
+        FILE *in = strcmp(batch_path, "-") == 0 ? stdin : fopen(batch_path, "r");
+        if (!in)
+        {
+            perror(batch_path);
+            free_students();
+            return 1;
         }
+        int failed = run_batch(in, checkpoint_every);
+        if (in != stdin)
+            fclose(in);
+        close_journal();
+        free_students();
+        return failed ? 1 : 0;
+    }
+
+    if (serve_endpoint)
+    {
+        int rc = run_server(serve_endpoint, serve_threads);
+        stop_background_save();
+        if (!compact_journal())
+            rc = 1;
+        close_journal();
+        free_students();
+        return rc;
     }
 
     puts("Student Management System (C) - Final Project");
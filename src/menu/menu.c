@@ -2,10 +2,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
 #include "student.h"
 #include "menu.h"
 #include "persistence.h"
 #include "utils.h"
+#include "stats.h"
+#include "csv.h"
+#include "instrument.h"
+
+/* Matches listed by name_search_menu() */
+#define NAME_SEARCH_SHOW 20
 
 /**
  * add_student_menu - Interactive menu to add a new student
@@ -17,10 +24,10 @@
  * 1. read_int() - O(1): Read user input
  * 2. read_line() - O(1): Read user input (fixed buffer)
  * 3. strlen() - O(k): Where k is length of name (bounded by NAME_LEN)
- * 4. add_student() - O(n): Linear search to check for duplicate ID
- * 5. save_students_to_file() - O(n): Write all n students to file
+ * 4. add_student() - O(1) expected: Hash lookup to check for duplicate ID
+ * 5. journal_add_student() - O(1) amortized: Append one journal record
  *
- * Overall: O(n) due to duplicate check and file save
+ * Overall: O(1) amortized expected
  */
 static void add_student_menu(void)
 {
@@ -33,6 +40,7 @@ static void add_student_menu(void)
         printf("Name cannot be empty.\n");
         return;
     }
+    journal_lock();
     if (!add_student(id, name))
     {
         printf("Student with ID %d already exists.\n", id);
@@ -40,25 +48,26 @@ static void add_student_menu(void)
     else
     {
         printf("Student added.\n");
-        save_students_to_file();
+        journal_add_student(id, name);
     }
+    journal_unlock();
 }
 
 /**
  * add_grade_menu - Interactive menu to add a grade to an existing student
  *
- * Time Complexity: O(n + g) where n is students, g is grades for that student
+ * Time Complexity: O(1) amortized expected
  * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
  * 1. read_int() - O(1): Read student ID
  * 2. read_float() - O(1): Read grade value
- * 3. add_grade_to_student() - O(n + g):
- *    - O(n): Linear search to find student by ID
- *    - O(g): Recursive sum to recalculate average
- * 4. save_students_to_file() - O(n): Save all students
+ * 3. add_grade_to_student() - O(1) amortized expected:
+ *    - O(1) expected: Hash lookup to find student by ID
+ *    - O(1): Running sum updates the average
+ * 4. journal_add_grade() - O(1) amortized: Append one journal record
  *
- * Overall: O(n + g) where g is typically small
+ * Overall: O(1) amortized expected
  */
 static void add_grade_menu(void)
 {
@@ -69,6 +78,7 @@ static void add_grade_menu(void)
         printf("Grade must be between 0 and 100.\n");
         return;
     }
+    journal_lock();
     if (!add_grade_to_student(id, grade))
     {
         printf("Student with ID %d not found.\n", id);
@@ -76,15 +86,16 @@ static void add_grade_menu(void)
     else
     {
         printf("Grade added and average recalculated.\n");
-        save_students_to_file();
+        journal_add_grade(id, grade);
     }
+    journal_unlock();
 }
 
 /**
  * sort_menu - Interactive menu to sort students by different criteria
  *
  * Time Complexity: O(n²) or O(n log n) depending on sort method
- * Space Complexity: O(n) for merge sort, O(1) for bubble/insertion
+ * Space Complexity: O(n) for merge/radix sort, O(1) for bubble/insertion
  *
  * Complexity Analysis:
  * 1. read_int() calls - O(1): Read user choices
@@ -92,43 +103,46 @@ static void add_grade_menu(void)
  *    - Bubble Sort: O(n²) time, O(1) space
  *    - Insertion Sort: O(n²) time, O(1) space
  *    - Merge Sort: O(n log n) time, O(n) space
+ *    - Radix Sort: O(n) time, O(n) space
  *
- * Overall: Best case O(n log n), Worst case O(n²)
+ * Overall: Best case O(n), Worst case O(n²)
  */
 static void sort_menu(void)
 {
-    printf("Choose sorting method:\n1. Bubble Sort\n2. Insertion Sort\n3. Merge Sort\nChoose: ");
+    printf("Choose sorting method:\n1. Bubble Sort\n2. Insertion Sort\n3. Merge Sort\n4. Radix Sort\nChoose: ");
     int m = read_int("");
-    SortMethod method = (m == 1) ? BUBBLE : (m == 2) ? INSERTION
-                                                     : MERGE;
+    SortMethod method = (m == 1)   ? BUBBLE
+                        : (m == 2) ? INSERTION
+                        : (m == 4) ? RADIX
+                                   : MERGE;
     printf("Sort by:\n1. ID\n2. Average\nChoose: ");
     int k = read_int("");
     SortKey key = (k == 1) ? SORT_BY_ID : SORT_BY_AVG;
+    journal_lock();
     sort_students(method, key);
+    journal_unlock();
     printf("Sorted.\n");
 }
 
 /**
- * search_menu - Interactive menu to search for a student by ID using binary search
+ * search_menu - Interactive menu to search for a student by ID using the ID index
  *
- * Time Complexity: O(n log n) due to sorting requirement
- * Space Complexity: O(n) for merge sort
+ * Time Complexity: O(g) where g is grades for the found student
+ * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
  * 1. read_int() - O(1): Read target ID
- * 2. sort_students(MERGE, SORT_BY_ID) - O(n log n): Pre-sort for binary search
- * 3. binary_search_by_id_recursive() - O(log n): Binary search in sorted array
- * 4. get_student_by_index() - O(1): Direct array access
- * 5. Display loop - O(g): Print g grades (typically small)
+ * 2. find_student_index() - O(1) expected: Hash index lookup, the
+ *    current display order of students is left untouched
+ * 3. get_student_by_index() - O(1): Direct array access
+ * 4. Display loop - O(g): Print g grades (typically small)
  *
- * Overall: O(n log n) dominated by sorting step
+ * Overall: O(g) - independent of the number of students
  */
 static void search_menu(void)
 {
     int id = read_int("Enter ID to search: ");
-    /* must sort by ID before searching */
-    sort_students(MERGE, SORT_BY_ID);
-    int idx = binary_search_by_id_recursive(id, 0, students_count() - 1);
+    int idx = find_student_index(id);
     if (idx == -1)
     {
         printf("Student with ID %d not found.\n", id);
@@ -136,13 +150,13 @@ static void search_menu(void)
     else
     {
         Student *s = get_student_by_index(idx);
-        printf("Found: ID=%d Name=%s Avg=%.2f #grades=%d\n", s->id, s->name, s->average, s->gradeCount);
+        printf("Found: ID=%d Name=%s Avg=%.2f #grades=%d\n", s->id, student_name(s), s->average, s->gradeCount);
         if (s->gradeCount > 0)
         {
             printf("Grades: ");
             for (int i = 0; i < s->gradeCount; ++i)
             {
-                printf("%.2f", s->grades[i]);
+                printf("%.2f", student_grade(s, i));
                 if (i + 1 < s->gradeCount)
                     printf(", ");
             }
@@ -152,82 +166,228 @@ static void search_menu(void)
 }
 
 /**
- * stats_menu - Display class statistics (highest and lowest averages)
+ * name_search_menu - List students whose name starts with a prefix
  *
- * Time Complexity: O(n) where n is the number of students
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(log n + k) where k ≤ NAME_SEARCH_SHOW
+ * Space Complexity: O(k) - fixed result array
+ *
+ * Complexity Analysis:
+ * 1. read_line() - O(1): Read the prefix (bounded buffer)
+ * 2. search_by_name_prefix() - O(log n + k): Sorted name index, the
+ *    first query after bulk changes rebuilds it in O(n log n)
+ * 3. find_student_index() + printf() per match - O(1) expected
+ *
+ * Overall: O(log n + k)
+ */
+static void name_search_menu(void)
+{
+    char prefix[NAME_LEN];
+    printf("Enter name prefix: ");
+    read_line(prefix, sizeof(prefix));
+    int ids[NAME_SEARCH_SHOW + 1];
+    journal_lock(); /* may rebuild the name index */
+    int k = search_by_name_prefix(prefix, ids, NAME_SEARCH_SHOW + 1);
+    journal_unlock();
+    if (k == 0)
+    {
+        printf("No student name starts with \"%s\".\n", prefix);
+        return;
+    }
+    int shown = k > NAME_SEARCH_SHOW ? NAME_SEARCH_SHOW : k;
+    for (int i = 0; i < shown; ++i)
+    {
+        Student *s = get_student_by_index(find_student_index(ids[i]));
+        printf("  ID=%d Name=%s Avg=%.2f #grades=%d\n", s->id, student_name(s), s->average, s->gradeCount);
+    }
+    if (k > NAME_SEARCH_SHOW)
+        printf("  ... more than %d matches, type a longer prefix.\n", NAME_SEARCH_SHOW);
+}
+
+/**
+ * print_ranking - Print a numbered list of students by slot
+ *
+ * Time Complexity: O(k) where k is list length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. get_student_by_index() + printf() per entry - O(1)
+ *
+ * Overall: O(k)
+ */
+static void print_ranking(const char *title, const int *slots, int k)
+{
+    printf("%s:\n", title);
+    for (int i = 0; i < k; ++i)
+    {
+        Student *s = get_student_by_index(slots[i]);
+        printf("  %2d. ID=%d Name=%s Avg=%.2f\n", i + 1, s->id, student_name(s), s->average);
+    }
+}
+
+/**
+ * print_histogram - Print a histogram in STATS_HIST_ROWS rows
+ *
+ * Time Complexity: O(HIST_BUCKETS)
+ * Space Complexity: O(1)
  *
  * Complexity Analysis:
- * 1. class_highest_lowest() - O(n): Single pass through all students
- *    - Initialize with first student: O(1)
- *    - Iterate remaining n-1 students: O(n)
- *    - Each comparison: O(1)
+ * 1. histogram_count_range() per row - O(HIST_BUCKETS) in total; the
+ *    last row includes HIST_MAX
+ * 2. printf() a bar scaled to the fullest row - O(STATS_HIST_BAR) per row
+ *
+ * Overall: O(1) - fixed number of rows and buckets
+ */
+static void print_histogram(const char *title, const Histogram *h)
+{
+    const float step = HIST_MAX / STATS_HIST_ROWS;
+    long long rows[STATS_HIST_ROWS], widest = 1;
+    for (int i = 0; i < STATS_HIST_ROWS; ++i)
+    {
+        float hi = i + 1 < STATS_HIST_ROWS ? (i + 1) * step : HIST_MAX + 1.0f;
+        rows[i] = histogram_count_range(h, i * step, hi);
+        if (rows[i] > widest)
+            widest = rows[i];
+    }
+    printf("%s (%lld):\n", title, h->total);
+    for (int i = 0; i < STATS_HIST_ROWS; ++i)
+    {
+        printf("  %5.1f-%-5.1f %8lld ", i * step, (i + 1) * step, rows[i]);
+        for (long long b = rows[i] * STATS_HIST_BAR / widest; b > 0; --b)
+            putchar('#');
+        putchar('\n');
+    }
+}
+
+/**
+ * print_stats - Display class statistics
+ *
+ * Time Complexity: O(n log k) where n is students, k is STATS_TOP_K
+ * Space Complexity: O(n) for the percentile scratch copy
+ *
+ * Complexity Analysis:
+ * 1. class_stats() - O(n): One columnar pass computes extremes with
+ *    their indices, mean, variance and the pass count together
  * 2. get_student_by_index() calls - O(1): Direct array access (2 times)
- * 3. printf() calls - O(1): Output operations
+ * 3. sqrt() + printf() calls - O(1): Output operations
+ * 4. average_percentile() x3 - O(n) expected each: Quartiles and median
+ *    by selection
+ * 5. top_k_by_average() / bottom_k_by_average() - O(n log k): Bounded
+ *    heaps; no sort, students[] keeps its order
+ * 6. grade_histogram() / average_histogram() - O(1): Maintained on
+ *    every change; the count below the pass mark, grade percentiles
+ *    and both print_histogram() tables read only the buckets
  *
- * Overall: O(n) - linear scan through students
+ * Overall: O(n log k)
  */
-static void stats_menu(void)
+static void print_stats(void)
 {
-    float hi, lo;
-    int hi_idx, lo_idx;
-    if (!class_highest_lowest(&hi, &hi_idx, &lo, &lo_idx))
+    ClassStats st;
+    if (!class_stats(STATS_PASS_MARK, &st))
     {
         puts("No students.");
         return;
     }
-    Student *h = get_student_by_index(hi_idx);
-    Student *l = get_student_by_index(lo_idx);
-    printf("Highest average: ID=%d Name=%s Avg=%.2f\n", h->id, h->name, h->average);
-    printf("Lowest average:  ID=%d Name=%s Avg=%.2f\n", l->id, l->name, l->average);
+    Student *h = get_student_by_index(st.highestIdx);
+    Student *l = get_student_by_index(st.lowestIdx);
+    printf("Students: %d (%d without grades), %lld grade(s) in total\n",
+           st.count, st.ungraded, st.totalGrades);
+    printf("Highest average: ID=%d Name=%s Avg=%.2f\n", h->id, student_name(h), h->average);
+    printf("Lowest average:  ID=%d Name=%s Avg=%.2f\n", l->id, student_name(l), l->average);
+    printf("Mean average: %.2f  Variance: %.2f  Std dev: %.2f\n",
+           st.mean, st.variance, sqrt(st.variance));
+    printf("At or above %.2f: %d (%.1f%%)\n", st.threshold, st.atOrAbove,
+           100.0 * st.atOrAbove / st.count);
+
+    float q1, median, q3;
+    if (average_percentile(25.0f, &q1) && average_percentile(50.0f, &median) &&
+        average_percentile(75.0f, &q3))
+        printf("Quartiles: Q1=%.2f  Median=%.2f  Q3=%.2f\n", q1, median, q3);
+
+    int slots[STATS_TOP_K];
+    int k = top_k_by_average(STATS_TOP_K, slots);
+    print_ranking("Top averages", slots, k);
+    k = bottom_k_by_average(STATS_TOP_K, slots);
+    print_ranking("Bottom averages", slots, k);
+
+    const Histogram *ah = average_histogram();
+    const Histogram *gh = grade_histogram();
+    printf("Averages below %.2f (histogram): %lld\n", STATS_PASS_MARK,
+           histogram_count_range(ah, 0.0f, STATS_PASS_MARK));
+    float p10, p50, p90;
+    if (histogram_percentile(gh, 10.0f, &p10) && histogram_percentile(gh, 50.0f, &p50) &&
+        histogram_percentile(gh, 90.0f, &p90))
+        printf("Grade percentiles (histogram): P10=%.2f  P50=%.2f  P90=%.2f\n", p10, p50, p90);
+    print_histogram("Averages", ah);
+    print_histogram("Grades", gh);
+}
+
+/**
+ * stats_menu - print_stats() under journal_lock()
+ *
+ * Time Complexity: O(n log k) - see print_stats()
+ * Space Complexity: O(n) - see print_stats()
+ *
+ * The histograms may be recounted on the way, so a timed background
+ * save waits; no input is read meanwhile.
+ *
+ * Overall: O(n log k)
+ */
+static void stats_menu(void)
+{
+    journal_lock();
+    print_stats();
+    journal_unlock();
 }
 
 /**
  * delete_menu - Interactive menu to delete a student by ID
  *
- * Time Complexity: O(n) where n is the number of students
+ * Time Complexity: O(log n) amortized expected
  * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
  * 1. read_int() - O(1): Read student ID to delete
- * 2. delete_student() - O(n):
- *    - index_of_id(): O(n) linear search for ID
+ * 2. delete_student() - O(log n) amortized:
+ *    - index_of_id(): O(1) expected hash lookup for ID
  *    - free(): O(1) free grades array
- *    - Shift elements left: O(n) in worst case
- * 3. save_students_to_file() - O(n): Write all remaining students
+ *    - Tombstone the slot; compaction is deferred and amortized
+ *    - name_index_remove(): O(log n) once the name index exists
+ * 3. journal_delete_student() - O(1) amortized: Append one journal record
  *
- * Overall: O(n) due to search and shift operations
+ * Overall: O(log n) amortized expected
  */
 static void delete_menu(void)
 {
     int id = read_int("Enter ID to delete: ");
+    journal_lock();
     if (delete_student(id))
     {
         printf("Deleted student %d.\n", id);
-        save_students_to_file();
+        journal_delete_student(id);
     }
     else
     {
         printf("Student %d not found.\n", id);
     }
+    journal_unlock();
 }
 
 /**
  * update_menu - Interactive menu to update a student's name
  *
- * Time Complexity: O(n) where n is the number of students
+ * Time Complexity: O(1) amortized expected
  * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
  * 1. read_int() - O(1): Read student ID
  * 2. read_line() - O(1): Read new name (bounded buffer)
  * 3. strlen() - O(k): Where k ≤ NAME_LEN (bounded constant)
- * 4. update_student_name() - O(n):
- *    - index_of_id(): O(n) linear search for student
+ * 4. update_student_name() - O(1) expected:
+ *    - index_of_id(): O(1) expected hash lookup for student
  *    - strncpy(): O(k) where k ≤ NAME_LEN
- * 5. save_students_to_file() - O(n): Write all students
+ * 5. journal_rename_student() - O(1) amortized: Append one journal record
  *
- * Overall: O(n) dominated by linear search
+ * Overall: O(1) amortized expected
  */
 static void update_menu(void)
 {
@@ -240,15 +400,137 @@ static void update_menu(void)
         printf("Name cannot be empty.\n");
         return;
     }
+    journal_lock();
     if (update_student_name(id, name))
     {
         printf("Updated.\n");
-        save_students_to_file();
+        journal_rename_student(id, name);
     }
     else
     {
         printf("Student %d not found.\n", id);
     }
+    journal_unlock();
+}
+
+/**
+ * import_csv_menu - Interactive bulk import from a CSV roster
+ *
+ * Time Complexity: O(B + n × g) where B is file size
+ * Space Complexity: O(n × g) for the imported students
+ *
+ * Complexity Analysis:
+ * 1. read_line() - O(1): Read the file path
+ * 2. import_csv() - O(B + n × g): Buffered parse into the bulk-insert path
+ * 3. compact_journal() - O(n × g): One snapshot for the whole import
+ *    instead of one journal record per row
+ *
+ * Overall: O(B + n × g)
+ */
+static void import_csv_menu(void)
+{
+    char path[512];
+    printf("CSV file to import: ");
+    read_line(path, sizeof(path));
+    if (strlen(path) == 0)
+    {
+        printf("Path cannot be empty.\n");
+        return;
+    }
+    int imported, skipped;
+    journal_lock();
+    if (import_csv(path, &imported, &skipped))
+    {
+        printf("Imported %d student(s), skipped %d row(s).\n", imported, skipped);
+        if (imported > 0)
+            compact_journal();
+    }
+    journal_unlock();
+}
+
+/**
+ * export_csv_menu - Interactive export of the registry to CSV
+ *
+ * Time Complexity: O(n × g)
+ * Space Complexity: O(1) beyond the fixed output buffer
+ *
+ * Complexity Analysis:
+ * 1. read_line() - O(1): Read the file path
+ * 2. export_csv() - O(n × g): Stream rows out
+ *
+ * Overall: O(n × g)
+ */
+static void export_csv_menu(void)
+{
+    char path[512];
+    printf("CSV file to write: ");
+    read_line(path, sizeof(path));
+    if (strlen(path) == 0)
+    {
+        printf("Path cannot be empty.\n");
+        return;
+    }
+    if (export_csv(path))
+        printf("Exported %d student(s) to %s\n", students_count(), path);
+}
+
+/* Rows per page for the display options; 0 shows everything at once */
+static int page_size = 0;
+
+/**
+ * set_page_size - Set rows per page for the display options (--limit)
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void set_page_size(int rows)
+{
+    page_size = rows > 0 ? rows : 0;
+}
+
+/**
+ * page_through - Show a listing one page at a time
+ *
+ * Time Complexity: O(p × f) where p is pages viewed, f the page cost
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. compact_students() - O(n) only after deletes, so pages hold
+ *    exactly page_size rows
+ * 2. No page size or small registry - one call over all rows
+ * 3. Otherwise for each page:
+ *    - show(first, page_size) - O(page_size) rows formatted
+ *    - read_line() - O(1): Enter continues, 'q' (or end of input) stops
+ *
+ * Only the pages actually viewed are formatted.
+ *
+ * Overall: O(p × f)
+ */
+static void page_through(void (*show)(int first, int count))
+{
+    journal_lock();
+    compact_students();
+    journal_unlock();
+    int n = students_count();
+    if (page_size == 0 || n <= page_size)
+    {
+        show(0, 0);
+        return;
+    }
+    char buf[16];
+    for (int first = 0; first < n; first += page_size)
+    {
+        show(first, page_size);
+        int last = first + page_size < n ? first + page_size : n;
+        if (last == n)
+            break;
+        printf("-- rows %d-%d of %d, Enter for more, q to stop -- ", first + 1, last, n);
+        read_line(buf, sizeof(buf));
+        if (buf[0] == 'q' || buf[0] == 'Q' || feof(stdin))
+            break;
+    }
 }
 
 /**
@@ -258,7 +540,7 @@ static void update_menu(void)
  * Space Complexity: O(1) - no additional space used
  *
  * Complexity Analysis:
- * 1. puts() calls - O(1) each, fixed number (11 calls)
+ * 1. puts() calls - O(1) each, fixed number (15 calls)
  *
  * Overall: O(1) - constant time operation
  */
@@ -270,10 +552,14 @@ void show_help(void)
     puts("3 - Display all students (summary)");
     puts("4 - Display grade matrix (detailed)");
     puts("5 - Sort students (choose method and key)");
-    puts("6 - Search student by ID (binary search)");
+    puts("6 - Search student by ID");
     puts("7 - Class statistics (highest/lowest average)");
     puts("8 - Delete student");
     puts("9 - Update student name");
+    puts("10 - Instrumentation counters");
+    puts("11 - Import students from CSV");
+    puts("12 - Export students to CSV");
+    puts("13 - Search students by name prefix");
     puts("0 - Exit");
 }
 
@@ -288,18 +574,25 @@ void show_help(void)
  * 2. read_line() - O(1): Read user input
  * 3. strcmp() - O(1): Check for help command
  * 4. strtol() - O(k): Parse input (k ≤ buffer size)
- * 5. Switch statement - O(1): Constant time dispatch
+ * 5. Switch statement - O(1): Constant time dispatch; each action
+ *    takes journal_lock() only around its change and journal record,
+ *    never while waiting for input
  * 6. Individual operations vary:
- *    - Case 1 (add): O(n) - add_student_menu()
- *    - Case 2 (grade): O(n+g) - add_grade_menu()
- *    - Case 3 (display): O(n) - display_all_students()
- *    - Case 4 (matrix): O(n×g) - display_grade_matrix()
- *    - Case 5 (sort): O(n²) or O(n log n) - sort_menu()
- *    - Case 6 (search): O(n log n) - search_menu()
- *    - Case 7 (stats): O(n) - stats_menu()
- *    - Case 8 (delete): O(n) - delete_menu()
- *    - Case 9 (update): O(n) - update_menu()
- *    - Case 0 (exit): O(n) - cleanup
+ *    - Case 1 (add): O(1) - add_student_menu()
+ *    - Case 2 (grade): O(1) - add_grade_menu()
+ *    - Case 3 (display): O(n) - display_students_page(), paged
+ *    - Case 4 (matrix): O(n×g) - display_grade_matrix_page(), paged
+ *    - Case 5 (sort): O(n²), O(n log n) or O(n) - sort_menu()
+ *    - Case 6 (search): O(g) - search_menu()
+ *    - Case 7 (stats): O(n log k) - stats_menu()
+ *    - Case 8 (delete): O(1) amortized - delete_menu()
+ *    - Case 9 (update): O(1) - update_menu()
+ *    - Case 10 (counters): O(1) - instr_dump()
+ *    - Case 11 (import): O(B + n×g) - import_csv_menu()
+ *    - Case 12 (export): O(n×g) - export_csv_menu()
+ *    - Case 13 (name search): O(log n + k) - name_search_menu()
+ *    - Case 0 (exit): O(n) - stop_background_save() first, so no timed
+ *      save starts behind it, then compact journal into snapshot, cleanup
  *
  * Overall: O(m × f(n)) where f(n) is the most expensive operation chosen
  */
@@ -323,7 +616,7 @@ void run_menu(void)
         long v = strtol(buf, &endptr, 10);
         if (endptr == buf || *endptr != '\0')
         {
-            puts("Invalid choice. Enter 0-9 or 'h' for help.");
+            puts("Invalid choice. Enter 0-13 or 'h' for help.");
             continue;
         }
 
@@ -337,10 +630,10 @@ void run_menu(void)
             add_grade_menu();
             break;
         case 3:
-            display_all_students();
+            page_through(display_students_page);
             break;
         case 4:
-            display_grade_matrix();
+            page_through(display_grade_matrix_page);
             break;
         case 5:
             sort_menu();
@@ -357,13 +650,28 @@ void run_menu(void)
         case 9:
             update_menu();
             break;
+        case 10:
+            instr_dump(stdout);
+            break;
+        case 11:
+            import_csv_menu();
+            break;
+        case 12:
+            export_csv_menu();
+            break;
+        case 13:
+            name_search_menu();
+            break;
         case 0:
-            save_students_to_file();
+            stop_background_save(); /* not under journal_lock(), see persistence.h */
+            journal_lock();
+            compact_journal();
+            journal_unlock();
             free_students();
             puts("Goodbye.");
             return;
         default:
-            puts("Invalid choice. Enter 0-9 or 'h' for help.");
+            puts("Invalid choice. Enter 0-13 or 'h' for help.");
             break;
         }
     }
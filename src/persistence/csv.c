@@ -0,0 +1,483 @@
+#include "csv.h"
+#include "student.h"
+#include "outbuf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* Bytes per fread() call */
+#define CSV_IO_SIZE (256 * 1024)
+
+/* Line-oriented reader over large buffered reads. A line that does not
+ * fit in the buffer grows it. */
+typedef struct
+{
+    FILE *fp;
+    char *buf;
+    size_t cap;
+    size_t pos;
+    size_t len;
+    bool eof;
+} CsvReader;
+
+/**
+ * csv_next_line - Return the next line, NUL-terminated in place
+ *
+ * Time Complexity: O(l) amortized where l is line length
+ * Space Complexity: O(l) - buffer grows only for lines longer than it
+ *
+ * Complexity Analysis:
+ * 1. memchr() for '\n' in the buffered bytes - O(l)
+ * 2. Refill when no newline is buffered - O(CSV_IO_SIZE):
+ *    - Move the partial line to the front - O(l)
+ *    - Double the buffer if the partial line fills it - amortized O(1)
+ *    - fread() the free space
+ * 3. Strip "\r\n" / "\n" - O(1)
+ *
+ * The last line may lack a newline. Returns NULL at end of file.
+ *
+ * Overall: O(l) amortized
+ */
+static char *csv_next_line(CsvReader *r, size_t *out_len)
+{
+    for (;;)
+    {
+        char *start = r->buf + r->pos;
+        size_t avail = r->len - r->pos;
+        char *nl = avail ? memchr(start, '\n', avail) : NULL;
+        if (nl || (r->eof && avail > 0))
+        {
+            size_t n = nl ? (size_t)(nl - start) : avail;
+            r->pos += nl ? n + 1 : n;
+            if (n > 0 && start[n - 1] == '\r')
+                n--;
+            start[n] = '\0'; /* buffer keeps one spare byte for this */
+            *out_len = n;
+            return start;
+        }
+        if (r->eof)
+            return NULL;
+
+        memmove(r->buf, start, avail);
+        r->len = avail;
+        r->pos = 0;
+        if (r->cap - 1 - r->len < CSV_IO_SIZE / 2)
+        {
+            size_t newcap = r->cap * 2;
+            char *tmp = realloc(r->buf, newcap);
+            if (!tmp)
+            {
+                fprintf(stderr, "Memory allocation failed (CSV reader).\n");
+                return NULL;
+            }
+            r->buf = tmp;
+            r->cap = newcap;
+        }
+        size_t got = fread(r->buf + r->len, 1, r->cap - 1 - r->len, r->fp);
+        r->len += got;
+        if (got == 0)
+            r->eof = true;
+    }
+}
+
+/**
+ * parse_int_field - Parse a decimal integer without sscanf()/strtol()
+ *
+ * Time Complexity: O(k) where k is digit count
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Skip blanks, optional sign - O(1)
+ * 2. Accumulate digits with overflow check - O(k)
+ *
+ * Overall: O(k)
+ */
+static bool parse_int_field(const char **pp, const char *end, int *out)
+{
+    const char *p = *pp;
+    while (p < end && *p == ' ')
+        p++;
+    bool neg = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p++ - '0');
+        if (v > (long long)INT_MAX + 1)
+            return false;
+    }
+    if (!neg && v > INT_MAX)
+        return false;
+    while (p < end && *p == ' ')
+        p++;
+    *out = (int)(neg ? -v : v);
+    *pp = p;
+    return true;
+}
+
+/* Exact powers of ten for the fractional part of a grade */
+static const double csv_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+/**
+ * parse_grade_field - Parse "[-]digits[.digits]" without strtod()
+ *
+ * Time Complexity: O(k) where k is field length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Skip blanks, optional sign - O(1)
+ * 2. Accumulate up to 18 significant digits as an integer - O(k)
+ * 3. One division by an exact power of ten - O(1): Correctly rounded
+ *    for every grade with up to 9 decimals
+ *
+ * Exponents are not accepted; grades are plain decimals.
+ *
+ * Overall: O(k)
+ */
+static bool parse_grade_field(const char **pp, const char *end, float *out)
+{
+    const char *p = *pp;
+    while (p < end && *p == ' ')
+        p++;
+    bool neg = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+        p++;
+    long long mant = 0;
+    int digits = 0, frac = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        if (digits < 18)
+            mant = mant * 10 + (*p - '0');
+        else
+            return false;
+        digits++;
+        p++;
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            if (frac < 9 && digits < 18)
+            {
+                mant = mant * 10 + (*p - '0');
+                frac++;
+            }
+            digits++;
+            p++;
+        }
+    }
+    if (digits == 0)
+        return false;
+    while (p < end && *p == ' ')
+        p++;
+    double v = (double)mant / csv_pow10[frac];
+    *out = (float)(neg ? -v : v);
+    *pp = p;
+    return true;
+}
+
+/**
+ * parse_name_field - Copy a plain or quoted name field
+ *
+ * Time Complexity: O(k) where k is field length
+ * Space Complexity: O(1) - writes into caller's NAME_LEN buffer
+ *
+ * Complexity Analysis:
+ * 1. Quoted: copy until the closing quote, "" becomes " - O(k)
+ * 2. Plain: copy until ',' or end of line - O(k)
+ * 3. Truncate to NAME_LEN - 1 - O(1)
+ *
+ * Overall: O(k)
+ */
+static bool parse_name_field(const char **pp, const char *end, char *name)
+{
+    const char *p = *pp;
+    size_t n = 0;
+    if (p < end && *p == '"')
+    {
+        p++;
+        for (;;)
+        {
+            if (p == end)
+                return false; /* unterminated quote */
+            if (*p == '"')
+            {
+                if (p + 1 < end && p[1] == '"')
+                    p++;
+                else
+                {
+                    p++;
+                    break;
+                }
+            }
+            if (n < NAME_LEN - 1)
+                name[n++] = *p;
+            p++;
+        }
+    }
+    else
+    {
+        while (p < end && *p != ',')
+        {
+            if (n < NAME_LEN - 1)
+                name[n++] = *p;
+            p++;
+        }
+    }
+    name[n] = '\0';
+    *pp = p;
+    return n > 0;
+}
+
+/**
+ * parse_row - Split one CSV row into id, name and grades
+ *
+ * Time Complexity: O(l) where l is line length
+ * Space Complexity: O(g) - grades buffer grows geometrically, reused
+ *
+ * Complexity Analysis:
+ * 1. parse_int_field() for the ID - O(k)
+ * 2. parse_name_field() - O(k)
+ * 3. parse_grade_field() per remaining field - O(l)
+ *    - Empty fields (padding of ragged rows) are skipped
+ *    - Grades outside 0-100 reject the row
+ *
+ * Overall: O(l)
+ */
+static bool parse_row(const char *p, const char *end, int *id, char *name,
+                      float **grades, int *cap, int *count)
+{
+    if (!parse_int_field(&p, end, id) || p == end || *p++ != ',')
+        return false;
+    if (!parse_name_field(&p, end, name))
+        return false;
+    int n = 0;
+    while (p < end)
+    {
+        if (*p++ != ',')
+            return false;
+        const char *q = p;
+        while (q < end && *q == ' ')
+            q++;
+        if (q == end || *q == ',')
+        {
+            p = q;
+            continue;
+        }
+        float g;
+        if (!parse_grade_field(&p, end, &g) || g < 0.0f || g > 100.0f)
+            return false;
+        if (n == *cap)
+        {
+            int newcap = *cap ? *cap * 2 : 16;
+            float *tmp = realloc(*grades, (size_t)newcap * sizeof(float));
+            if (!tmp)
+                return false;
+            *grades = tmp;
+            *cap = newcap;
+        }
+        (*grades)[n++] = g;
+    }
+    *count = n;
+    return true;
+}
+
+/**
+ * import_csv - Bulk-insert students from a CSV roster
+ *
+ * Time Complexity: O(B + n × g) where B is file size
+ * Space Complexity: O(CSV_IO_SIZE + g) beyond the registry itself
+ *
+ * Complexity Analysis:
+ * 1. fopen() + CSV_IO_SIZE buffer - O(1)
+ * 2. csv_next_line() per row - O(l) amortized
+ * 3. First row whose ID does not parse is taken as a header - O(1)
+ * 4. parse_row() - O(l): Hand-written integer/decimal parsing
+ * 5. add_student_with_grades() - O(g): Bulk-insert path, one
+ *    allocation and one average computation per student
+ * 6. Rejected rows (syntax, range, duplicate ID) are counted, the
+ *    first CSV_MAX_WARNINGS reported with their line number
+ *
+ * The caller persists the result (compact_journal()); imports are
+ * not journaled row by row.
+ *
+ * Overall: O(B + n × g)
+ */
+bool import_csv(const char *path, int *imported, int *skipped)
+{
+    *imported = *skipped = 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+    {
+        perror(path);
+        return false;
+    }
+    CsvReader r = {fp, malloc(CSV_IO_SIZE + 1), CSV_IO_SIZE + 1, 0, 0, false};
+    if (!r.buf)
+    {
+        fclose(fp);
+        fprintf(stderr, "Memory allocation failed (CSV reader).\n");
+        return false;
+    }
+
+    float *grades = NULL;
+    int grades_cap = 0;
+    long lineno = 0;
+    size_t len;
+    char *line;
+    while ((line = csv_next_line(&r, &len)) != NULL)
+    {
+        lineno++;
+        if (len == 0)
+            continue;
+        int id = 0, count = 0;
+        char name[NAME_LEN];
+        bool ok = parse_row(line, line + len, &id, name, &grades, &grades_cap, &count);
+        if (!ok && lineno == 1)
+            continue; /* header row */
+        const char *why = "malformed row";
+        if (ok && !(ok = add_student_with_grades(id, name, grades, count)))
+            why = "duplicate ID";
+        if (ok)
+        {
+            (*imported)++;
+            continue;
+        }
+        if (++*skipped <= CSV_MAX_WARNINGS)
+            fprintf(stderr, "%s:%ld: %s, skipped\n", path, lineno, why);
+    }
+    if (*skipped > CSV_MAX_WARNINGS)
+        fprintf(stderr, "%s: %d more row(s) skipped\n", path, *skipped - CSV_MAX_WARNINGS);
+
+    bool ok = !ferror(fp);
+    if (!ok)
+        perror(path);
+    free(grades);
+    free(r.buf);
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * put_grade - Append a grade rounded to hundredths, trailing zeros dropped
+ *
+ * Time Complexity: O(1) - at most a handful of digits
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Round to integer hundredths - O(1)
+ * 2. Integer part via ob_uint() - O(d)
+ * 3. Up to two decimals, "80", "80.5", "80.25" - O(1)
+ *
+ * Same precision as the JSON snapshot's two decimals.
+ *
+ * Overall: O(1)
+ */
+static void put_grade(OutBuf *out, float g)
+{
+    double v = g;
+    if (v < 0.0)
+    {
+        ob_putc(out, '-');
+        v = -v;
+    }
+    unsigned long long h = (unsigned long long)(v * 100.0 + 0.5);
+    ob_uint(out, h / 100);
+    unsigned cents = (unsigned)(h % 100);
+    if (cents == 0)
+        return;
+    char frac[3] = {'.', (char)('0' + cents / 10), (char)('0' + cents % 10)};
+    ob_write(out, frac, cents % 10 ? 3 : 2);
+}
+
+/**
+ * put_name - Append a name, quoted only when it contains ',' or '"'
+ *
+ * Time Complexity: O(k) where k ≤ NAME_LEN
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. strcspn() for special characters - O(k)
+ * 2. Plain: one ob_write() - O(k)
+ * 3. Quoted: copy with "" for each quote - O(k)
+ *
+ * Overall: O(k)
+ */
+static void put_name(OutBuf *out, const char *name)
+{
+    size_t n = strlen(name);
+    if (strcspn(name, ",\"") == n)
+    {
+        ob_write(out, name, n);
+        return;
+    }
+    ob_putc(out, '"');
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (name[i] == '"')
+            ob_putc(out, '"');
+        ob_putc(out, name[i]);
+    }
+    ob_putc(out, '"');
+}
+
+/**
+ * export_csv - Stream the registry out as CSV
+ *
+ * Time Complexity: O(n × g) where n is students, g is avg grades
+ * Space Complexity: O(OUTBUF_FLUSH_SIZE) - one output buffer
+ *
+ * Complexity Analysis:
+ * 1. fopen() + header row - O(1)
+ * 2. For each student - O(g):
+ *    - ob_int() ID, put_name(), put_grade() per grade, all formatted
+ *      directly into the output buffer
+ * 3. fwrite() once per OUTBUF_FLUSH_SIZE bytes
+ * 4. ob_finish() + fclose() - O(1)
+ *
+ * No printf() and no per-record temporary strings.
+ *
+ * Overall: O(n × g)
+ */
+bool export_csv(const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        perror(path);
+        return false;
+    }
+    OutBuf out;
+    ob_init(&out, fp);
+    ob_puts(&out, "id,name,grades...\n");
+
+    int slots = student_slots();
+    for (int i = 0; i < slots; i++)
+    {
+        Student *s = get_student_by_index(i);
+        if (!s)
+            continue;
+        ob_int(&out, s->id);
+        ob_putc(&out, ',');
+        put_name(&out, student_name(s));
+        for (int j = 0; j < s->gradeCount; j++)
+        {
+            ob_putc(&out, ',');
+            put_grade(&out, student_grade(s, j));
+        }
+        ob_putc(&out, '\n');
+    }
+
+    bool ok = ob_finish(&out);
+    if (fclose(fp) != 0 || !ok)
+    {
+        perror("Error writing CSV file");
+        return false;
+    }
+    return true;
+}
@@ -1,200 +1,3391 @@
+#define _POSIX_C_SOURCE 200809L
 #include "persistence.h"
 #include "student.h"
+#include "instrument.h"
+#include "outbuf.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Active data file; its extension selects the snapshot format */
+static char data_file[512] = DATA_FILE;
+
+/* Journal of the active data file, and its records moved aside for a
+ * background save; both follow set_data_file() */
+static char journal_file[sizeof(data_file) + sizeof(JOURNAL_SUFFIX)] = DATA_FILE JOURNAL_SUFFIX;
+static char journal_old_file[sizeof(journal_file) + sizeof(JOURNAL_OLD_SUFFIX)] =
+    DATA_FILE JOURNAL_SUFFIX JOURNAL_OLD_SUFFIX;
+
+/* Journal state: sequence numbers order every record ever appended.
+ * The snapshot remembers the last sequence it contains, so records at
+ * or below snapshot_seq are skipped on replay even if the journal was
+ * not truncated (e.g. crash between snapshot write and truncation). */
+static FILE *journal_fp = NULL;
+static unsigned long journal_seq = 0;
+static unsigned long snapshot_seq = 0;
+
+/* Keep binary snapshots mapped instead of copying grades at load */
+static bool lazy_grades = false;
+
+/* Sharded storage (shard_count > 1): shard k is the file shard_path(k)
+ * and holds the students with shard_of(id) == k. shard_seq[k] is the
+ * journal sequence that file contains, so replay can skip per shard;
+ * shard_dirty[k] marks shards changed since they were last written.
+ * stale_shards counts files past the last shard, left by a run with
+ * more shards; they are loaded, then removed after the next save. */
+static int shard_count = 1;
+static unsigned long shard_seq[SHARD_MAX];
+static bool shard_dirty[SHARD_MAX];
+static int stale_shards = 0;
+
+/* Room for the data file path plus ".<k>" */
+#define SHARD_PATH_MAX (512 + 16)
+
+/* Background saves (set_background_save()): a journal append that
+ * reaches the threshold hands a registry_clone() to writer_thread,
+ * which saves it while edits continue. With a save delay the writer
+ * also wakes once the oldest pending record is that old and hands the
+ * copy over itself, under journal_mutex. writer_job belongs to the
+ * writer while WRITER_BUSY and to whoever holds journal_mutex
+ * otherwise; writer_lock guards writer_state, writer_stop and
+ * first_pending_ms, when the oldest record not yet handed to a save was
+ * appended (0 = none). journal_mutex guards the journal, its sequence
+ * numbers and shard_dirty; see journal_lock(). */
+typedef enum
+{
+    WRITER_IDLE = 0,
+    WRITER_BUSY, /* copy handed over, being written */
+    WRITER_DONE  /* written; result not yet taken by reap_background_save() */
+} WriterState;
+
+typedef struct
+{
+    StudentRegistry *reg;  /* the copy, freed by the writer */
+    unsigned long seq;     /* last journal record the copy contains */
+    bool dirty[SHARD_MAX]; /* shards to write; left set for those that failed */
+    bool ok;
+} BackgroundSave;
+
+static bool background_save = false;
+static unsigned long save_every = 0; /* 0 = the JOURNAL_COMPACT_THRESHOLD rule */
+static long save_delay_ms = 0;       /* 0 = no time limit */
+static long long first_pending_ms = 0;
+static pthread_mutex_t journal_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t writer_thread;
+static bool writer_started = false;
+static bool writer_stop = false;
+static WriterState writer_state = WRITER_IDLE;
+static BackgroundSave writer_job;
+
+/* Binary snapshot layout (host byte order), version 3:
+ *   SnapshotHeader
+ *   SnapshotStudent[record_capacity]   at students_offset
+ *   float[heap_end]                    at grades_offset
+ * Records [0, record_count) are in use; SNAPSHOT_DEAD ones are skipped.
+ * A record's grades are [grade_first, grade_first + grade_count) of the
+ * heap, inside a run of grade_cap floats reserved for it. Its name is
+ * name_len bytes and a NUL at heap float name_first, padded like the
+ * name arena (NAME_STORED_SIZE), so a full save can write the arena
+ * after the grades as one block. Free slots and run slack let
+ * save_binary_patch() rewrite single records in place; each record
+ * carries the journal sequence it is current to.
+ * Versions 1 and 2 (names inline in SnapshotStudentV1 / V2) still load
+ * and are rewritten as version 3; version 1 has a 48-byte header, every
+ * slot live and grades packed. */
+#define SNAPSHOT_MAGIC "SMSB"
+#define SNAPSHOT_VERSION 3
+#define SNAPSHOT_V1_HEADER_SIZE 48
+#define SNAPSHOT_DEAD 1u
+
+/* Version 4, written by SMS_QUANTIZED_GRADES builds, is packed:
+ *   SnapshotHeader
+ *   record stream                   at students_offset
+ *   uint16_t[grade_count]           at grades_offset, 8-byte aligned
+ * A record is four varints (LEB128): zigzag ID delta from the previous
+ * record, grade count, exact grade sum in hundredths, name length, and
+ * then the name bytes. Grades follow in record order, so a quantized
+ * build can map them for lazy loading. With no free slots or per-record
+ * seq it is always rewritten whole. Every build loads every version. */
+#define SNAPSHOT_VERSION_PACKED 4
+#define SNAPSHOT_PACKED_ALIGN 8
+
+#ifdef SMS_QUANTIZED_GRADES
+#define SNAPSHOT_WRITE_VERSION SNAPSHOT_VERSION_PACKED
+#else
+#define SNAPSHOT_WRITE_VERSION SNAPSHOT_VERSION
+#endif
+
+/* Name field of version 1 and 2 records */
+#define SNAPSHOT_NAME_LEN 50
+
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t student_count; /* live records */
+    uint32_t reserved;
+    uint64_t grade_count;   /* grades of live records */
+    uint64_t journal_seq;
+    uint64_t students_offset;
+    uint64_t grades_offset;
+    /* version 2 and later */
+    uint32_t record_count;    /* slots in use, dead ones included */
+    uint32_t record_capacity; /* slots between the two offsets */
+    uint64_t heap_end;        /* floats allocated in the heap, grades and names */
+    uint64_t heap_garbage;    /* floats in runs and names no live record uses */
+} SnapshotHeader;
+
+typedef struct
+{
+    int32_t id;
+    uint32_t grade_count;
+    uint64_t grade_first;
+    float average;
+    uint32_t grade_cap;
+    uint64_t seq;
+    uint32_t flags;
+    uint32_t name_len;   /* bytes, without the NUL */
+    uint64_t name_first; /* heap float the name starts at */
+} SnapshotStudent;
+
+typedef struct
+{
+    int32_t id;
+    uint32_t grade_count;
+    uint64_t grade_first;
+    float average;
+    uint32_t grade_cap;
+    uint64_t seq;
+    uint32_t flags;
+    char name[SNAPSHOT_NAME_LEN];
+} SnapshotStudentV2;
+
+typedef struct
+{
+    int32_t id;
+    uint32_t grade_count;
+    uint64_t grade_first;
+    float average;
+    char name[SNAPSHOT_NAME_LEN];
+} SnapshotStudentV1;
+
+_Static_assert(sizeof(SnapshotHeader) == 72, "snapshot header layout");
+_Static_assert(sizeof(SnapshotStudent) == 48, "snapshot record layout");
+_Static_assert(sizeof(SnapshotStudentV2) == 88, "version 2 record layout");
+_Static_assert(sizeof(SnapshotStudentV1) == 72, "version 1 record layout");
+
+/* Record slots a full save reserves beyond the students it writes:
+ * count / SNAPSHOT_SLACK_DIV + SNAPSHOT_SLACK_MIN */
+#define SNAPSHOT_SLACK_DIV 8
+#define SNAPSHOT_SLACK_MIN 64
+
+/* A save patches records in place while at most 1 / SNAPSHOT_PATCH_DIV
+ * of the file's records changed and under half its grade region is
+ * garbage; otherwise it rewrites the file */
+#define SNAPSHOT_PATCH_DIV 4
+
+/* Where each ID's record is in a binary snapshot this process loaded or
+ * wrote, plus that file's header, so saves can patch it. slots is an
+ * open-addressing table of 2 × record_capacity rounded up to a power of
+ * two, linear probing; a deleted student's bucket keeps its ID with
+ * slot -1. newer holds records patched after the header was last
+ * written (a crash mid-patch), sorted by ID, until replay is done. */
+#define DISK_SLOT_EMPTY (-2)
+
+typedef struct
+{
+    int32_t id;
+    int32_t slot;
+} DiskSlot;
+
+typedef struct
+{
+    int32_t id;
+    uint64_t seq;
+} RecordSeq;
+
+typedef struct
+{
+    bool valid;
+    SnapshotHeader h;
+    DiskSlot *slots;
+    uint32_t slots_mask;
+    RecordSeq *newer;
+    int newer_len; /* -1 after running out of memory */
+    int newer_cap;
+} DiskFile;
+
+/* disk_files[0] is the unsharded data file, disk_files[k] shard k.
+ * Owned by the loader thread of that file, then by whichever thread
+ * saves (the writer while a background save runs). */
+static DiskFile disk_files[SHARD_MAX];
+
+/**
+ * set_data_file - Select the file used by save/load_students_from_file
+ *
+ * Time Complexity: O(k) where k is path length
+ * Space Complexity: O(1) - fixed buffer
+ *
+ * Complexity Analysis:
+ * 1. Length check - O(k): Reject paths that do not fit
+ * 2. strcpy() - O(k): Copy path
+ * 3. snprintf() the journal paths next to it - O(k)
+ *
+ * Must be called before the journal is opened or replayed.
+ *
+ * Overall: O(k)
+ */
+bool set_data_file(const char *path)
+{
+    if (!path || strlen(path) >= sizeof(data_file))
+        return false;
+    strcpy(data_file, path);
+    snprintf(journal_file, sizeof(journal_file), "%s%s", data_file, JOURNAL_SUFFIX);
+    snprintf(journal_old_file, sizeof(journal_old_file), "%s%s", journal_file, JOURNAL_OLD_SUFFIX);
+    return true;
+}
+
+/**
+ * set_lazy_grades - Keep binary snapshots mapped and load grades on demand
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void set_lazy_grades(bool enabled)
+{
+    lazy_grades = enabled;
+}
+
+/**
+ * shard_of - Shard that stores a student
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Multiplicative hash of the ID, so sequential IDs spread evenly.
+ *
+ * Overall: O(1)
+ */
+static int shard_of(int id)
+{
+    uint32_t h = (uint32_t)id * 2654435769u;
+    return (int)((h >> 16) % (uint32_t)shard_count);
+}
+
+/**
+ * mark_shard_dirty - Change hook: the student's shard must be rewritten
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void mark_shard_dirty(int id, void *ctx)
+{
+    (void)ctx;
+    shard_dirty[shard_of(id)] = true;
+}
+
+/**
+ * set_shard_count - Split the data file into n shard files
+ *
+ * Time Complexity: O(n)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Validate 1 ≤ n ≤ SHARD_MAX - O(1)
+ * 2. Mark every shard dirty - O(n): Nothing is known to be on disk
+ *    until load_students_from_file() has looked
+ * 3. Install mark_shard_dirty() as the default registry's change hook,
+ *    or remove it for n = 1 - O(1)
+ *
+ * Call before loading.
+ *
+ * Overall: O(n)
+ */
+bool set_shard_count(int n)
+{
+    if (n < 1 || n > SHARD_MAX)
+        return false;
+    shard_count = n;
+    for (int k = 0; k < SHARD_MAX; ++k)
+        shard_dirty[k] = true;
+    registry_set_change_hook(default_registry(), n > 1 ? mark_shard_dirty : NULL, NULL);
+    return true;
+}
+
+/**
+ * shard_path - Name of shard k: the data file with ".<k>" before its extension
+ *
+ * Time Complexity: O(k) where k is path length
+ * Space Complexity: O(1) - caller's buffer of SHARD_PATH_MAX
+ *
+ * data/students.json becomes data/students.3.json; a name without an
+ * extension just gets ".3" appended.
+ *
+ * Overall: O(k)
+ */
+static void shard_path(char *out, int k)
+{
+    const char *slash = strrchr(data_file, '/');
+    const char *ext = strrchr(data_file, '.');
+    if (!ext || (slash && ext < slash))
+        ext = data_file + strlen(data_file);
+    snprintf(out, SHARD_PATH_MAX, "%.*s.%d%s", (int)(ext - data_file), data_file, k, ext);
+}
+
+/**
+ * shard_exists - Whether shard k has a file on disk
+ *
+ * Time Complexity: O(k) where k is path length - one access()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k)
+ */
+static bool shard_exists(int k)
+{
+    char path[SHARD_PATH_MAX];
+    shard_path(path, k);
+    return access(path, F_OK) == 0;
+}
+
+/**
+ * get_data_file - Return the active data file path
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+const char *get_data_file(void)
+{
+    return data_file;
+}
+
+/**
+ * is_binary_path - Check whether a path names a binary snapshot
+ *
+ * Time Complexity: O(k) where k is path length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. strrchr() - O(k): Find last '.'
+ * 2. strcmp() - O(1): Compare extension
+ *
+ * Overall: O(k)
+ */
+static bool is_binary_path(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+    return ext && strcmp(ext, BINARY_EXTENSION) == 0;
+}
+
+/**
+ * write_json_string - Write s as a quoted, escaped JSON string
+ *
+ * Time Complexity: O(k) where k is string length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Byte loop - O(k):
+ *    - Runs of plain bytes copied with one ob_write()
+ *    - '"' and '\\' escaped with a backslash
+ *    - Control characters written as \u00XX
+ *    - Everything else (including UTF-8) copied as is
+ *
+ * Overall: O(k)
+ */
+static void write_json_string(OutBuf *out, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    ob_putc(out, '"');
+    const unsigned char *run = (const unsigned char *)s;
+    for (const unsigned char *p = run;; ++p)
+    {
+        if (*p && *p != '"' && *p != '\\' && *p >= 0x20)
+            continue;
+        ob_write(out, run, (size_t)(p - run));
+        if (!*p)
+            break;
+        if (*p < 0x20)
+        {
+            char esc[6] = {'\\', 'u', '0', '0', hex[*p >> 4], hex[*p & 15]};
+            ob_write(out, esc, sizeof(esc));
+        }
+        else
+        {
+            char esc[2] = {'\\', (char)*p};
+            ob_write(out, esc, sizeof(esc));
+        }
+        run = p + 1;
+    }
+    ob_putc(out, '"');
+}
+
+/**
+ * disk_file_reset - Forget what is known about a snapshot file
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * The next save of that file rewrites it in full.
+ *
+ * Overall: O(1)
+ */
+static void disk_file_reset(DiskFile *df)
+{
+    free(df->slots);
+    free(df->newer);
+    memset(df, 0, sizeof(*df));
+}
+
+/**
+ * disk_files_reset - disk_file_reset() every data and shard file
+ *
+ * Time Complexity: O(s)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(s)
+ */
+static void disk_files_reset(void)
+{
+    for (int k = 0; k < SHARD_MAX; ++k)
+        disk_file_reset(&disk_files[k]);
+}
+
+/**
+ * disk_file_init - Empty record table for a file with capacity slots
+ *
+ * Time Complexity: O(c) where c is capacity
+ * Space Complexity: O(c) - 2c to 4c buckets
+ *
+ * Overall: O(c) - returns false (df stays invalid) if out of memory
+ */
+static bool disk_file_init(DiskFile *df, uint32_t capacity)
+{
+    disk_file_reset(df);
+    uint32_t buckets = 16;
+    while (buckets < 2 * (uint64_t)capacity)
+        buckets *= 2;
+    df->slots = malloc((size_t)buckets * sizeof(DiskSlot));
+    if (!df->slots)
+        return false;
+    for (uint32_t i = 0; i < buckets; ++i)
+        df->slots[i].slot = DISK_SLOT_EMPTY;
+    df->slots_mask = buckets - 1;
+    return true;
+}
+
+/**
+ * disk_slot - Bucket holding id, or the empty bucket where it belongs
+ *
+ * Time Complexity: O(1) expected - load factor stays under 0.5
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Multiplicative hash of the ID - O(1)
+ * 2. Linear probe until the ID or an empty bucket - O(1) expected
+ *
+ * Overall: O(1) expected
+ */
+static DiskSlot *disk_slot(DiskFile *df, int id)
+{
+    uint32_t i = ((uint32_t)id * 2654435761u) & df->slots_mask;
+    while (df->slots[i].slot != DISK_SLOT_EMPTY && df->slots[i].id != id)
+        i = (i + 1) & df->slots_mask;
+    return &df->slots[i];
+}
+
+/**
+ * record_seq_cmp - qsort()/bsearch() order of RecordSeq by ID
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static int record_seq_cmp(const void *a, const void *b)
+{
+    int x = ((const RecordSeq *)a)->id, y = ((const RecordSeq *)b)->id;
+    return (x > y) - (x < y);
+}
+
+/**
+ * record_newer - Note a record patched after its file's header
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1) amortized - the list grows geometrically
+ *
+ * Only non-empty after a crash in the middle of a patch. Out of memory
+ * just forgets the file (df reset), which makes load_binary() reject
+ * the snapshot rather than replay records twice.
+ *
+ * Overall: O(1) amortized
+ */
+static void record_newer(DiskFile *df, int id, uint64_t seq)
+{
+    if (df->newer_len == df->newer_cap)
+    {
+        int cap = df->newer_cap ? df->newer_cap * 2 : 16;
+        RecordSeq *tmp = realloc(df->newer, (size_t)cap * sizeof(RecordSeq));
+        if (!tmp)
+        {
+            df->newer_len = -1;
+            return;
+        }
+        df->newer = tmp;
+        df->newer_cap = cap;
+    }
+    df->newer[df->newer_len].id = id;
+    df->newer[df->newer_len].seq = seq;
+    df->newer_len++;
+}
+
+/**
+ * newer_seq - Journal sequence a patched record of id is current to
+ *
+ * Time Complexity: O(s × log p) where p is records patched after their
+ *                  file's header
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Skip files with an empty list - O(s): The normal case
+ * 2. Binary search for the first entry with the ID, then take the
+ *    largest seq among its entries (a deleted and a re-added record) -
+ *    O(log p)
+ *
+ * Every loaded file is searched, not just the ID's shard, so a load
+ * with another shard count still finds the record. Returns 0 when id
+ * has no such record.
+ *
+ * Overall: O(s × log p), O(s) normally
+ */
+static uint64_t newer_seq(int id)
+{
+    uint64_t seq = 0;
+    for (int k = 0; k < SHARD_MAX; ++k)
+    {
+        const DiskFile *df = &disk_files[k];
+        int lo = 0, hi = df->newer_len;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (df->newer[mid].id < id)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (; lo < df->newer_len && df->newer[lo].id == id; ++lo)
+            if (df->newer[lo].seq > seq)
+                seq = df->newer[lo].seq;
+    }
+    return seq;
+}
+
+/**
+ * disk_files_forget_newer - Drop the replay lists once replay is done
+ *
+ * Time Complexity: O(s)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(s)
+ */
+static void disk_files_forget_newer(void)
+{
+    for (int k = 0; k < SHARD_MAX; ++k)
+    {
+        free(disk_files[k].newer);
+        disk_files[k].newer = NULL;
+        disk_files[k].newer_len = disk_files[k].newer_cap = 0;
+    }
+}
 
 /**
- * save_students_to_file - Save all students to JSON file
+ * save_json - Save all students to a JSON file
  *
  * Time Complexity: O(n × g) where n is students, g is avg grades per student
- * Space Complexity: O(1) - writes directly to file
+ * Space Complexity: O(OUTBUF_FLUSH_SIZE) - one output buffer
  *
  * Complexity Analysis:
  * 1. fopen() - O(1): Open file for writing
- * 2. Write JSON header - O(1): Fixed output
- * 3. students_count() - O(1): Get count
- * 4. Outer loop - O(n): Iterate through n students
+ * 2. Write JSON header - O(1): Journal sequence seq and record count
+ * 3. registry_students_count() - O(1): Live count, or the selection size
+ * 4. Outer loop - O(n): Iterate through reg's slots, or only the
+ *    slots listed in sel
  * 5. For each student:
- *    - get_student_by_index() - O(1): Direct access
- *    - Write student metadata - O(1): Fixed fields
+ *    - registry_get_student_by_index() - O(1): NULL (skipped)
+ *      for a tombstone
+ *    - Write student metadata - O(k): Name escaped by write_json_string()
  *    - Inner loop - O(g): Write g grades
- *      - fprintf() per grade - O(1)
+ *      - ob_fixed2() per grade - O(1): No format string parsing
  *    - Write average - O(1)
  * 6. Write JSON footer - O(1)
- * 7. fclose() - O(1): Close file
+ * 7. ob_finish() + fclose() - O(1): Output leaves in OUTBUF_FLUSH_SIZE
+ *    fwrite() calls
  *
  * Total iterations: n students × g grades each
  *
  * Overall: O(n × g) time, O(1) space
  */
-/* Save all students to JSON file */
-bool save_students_to_file(void)
+/* Save all students (or the selected slots) to JSON file */
+static bool save_json(StudentRegistry *reg, const char *path, const int *sel, int nsel, unsigned long seq)
 {
-    FILE *fp = fopen(DATA_FILE, "w");
+    FILE *fp = fopen(path, "w");
     if (!fp)
     {
         perror("Error opening file for writing");
         return false;
     }
 
-    fprintf(fp, "{\n");
-    fprintf(fp, "  \"students\": [\n");
+    int count = sel ? nsel : registry_students_count(reg);
+    int slots = sel ? nsel : registry_student_slots(reg);
+    int written = 0;
+    OutBuf out;
+    ob_init(&out, fp);
+    ob_puts(&out, "{\n  \"journal_seq\": ");
+    ob_uint(&out, seq);
+    ob_puts(&out, ",\n  \"count\": ");
+    ob_int(&out, count);
+    ob_puts(&out, ",\n  \"students\": [\n");
 
-    int count = students_count();
-    for (int i = 0; i < count; i++)
+    for (int i = 0; i < slots; i++)
     {
-        Student *s = get_student_by_index(i);
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
         if (!s)
             continue;
 
-        fprintf(fp, "    {\n");
-        fprintf(fp, "      \"id\": %d,\n", s->id);
-        fprintf(fp, "      \"name\": \"%s\",\n", s->name);
-        fprintf(fp, "      \"grades\": [");
+        ob_puts(&out, "    {\n      \"id\": ");
+        ob_int(&out, s->id);
+        ob_puts(&out, ",\n      \"name\": ");
+        write_json_string(&out, registry_student_name(reg, s));
+        ob_puts(&out, ",\n      \"grades\": [");
 
         for (int j = 0; j < s->gradeCount; j++)
         {
-            fprintf(fp, "%.2f", s->grades[j]);
+            ob_fixed2(&out, student_grade(s, j));
             if (j + 1 < s->gradeCount)
-                fprintf(fp, ", ");
+                ob_write(&out, ", ", 2);
         }
 
-        fprintf(fp, "],\n");
-        fprintf(fp, "      \"average\": %.2f\n", s->average);
-        fprintf(fp, "    }");
+        ob_puts(&out, "],\n      \"average\": ");
+        ob_fixed2(&out, s->average);
+        ob_puts(&out, "\n    }");
 
-        if (i + 1 < count)
-            fprintf(fp, ",");
-        fprintf(fp, "\n");
+        if (++written < count)
+            ob_putc(&out, ',');
+        ob_putc(&out, '\n');
     }
 
-    fprintf(fp, "  ]\n");
-    fprintf(fp, "}\n");
+    ob_puts(&out, "  ]\n}\n");
 
-    fclose(fp);
+    bool ok = ob_finish(&out);
+    long bytes = ftell(fp);
+    if (bytes > 0)
+        INSTR_ADD(INSTR_SAVE_BYTES, bytes);
+    if (fclose(fp) != 0 || !ok)
+    {
+        perror("Error writing data file");
+        return false;
+    }
     return true;
 }
 
+#ifdef SMS_QUANTIZED_GRADES
+/**
+ * put_varint - Append an unsigned LEB128 varint
+ *
+ * Time Complexity: O(1) - at most 10 bytes
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void put_varint(OutBuf *out, uint64_t v)
+{
+    unsigned char buf[10];
+    int n = 0;
+    do
+    {
+        buf[n] = (unsigned char)(v & 0x7f);
+        v >>= 7;
+        if (v)
+            buf[n] |= 0x80;
+        n++;
+    } while (v);
+    ob_write(out, buf, (size_t)n);
+}
+
 /**
- * load_students_from_file - Load students from JSON file
+ * save_binary_packed - Save students to a packed version 4 snapshot
  *
- * Time Complexity: O(L × (n + g)) where L is file lines, n is students, g is grades
- * Space Complexity: O(k) where k is max line length (512)
+ * Time Complexity: O(n + G + N) where N is name bytes
+ * Space Complexity: O(OUTBUF_FLUSH_SIZE) - one output buffer
  *
  * Complexity Analysis:
- * 1. fopen() - O(1): Open file for reading
- * 2. Initialize variables - O(1)
- * 3. While loop - O(L): Read L lines from file
- * 4. For each line:
- *    - fgets() - O(k): Read up to 512 chars
- *    - Skip whitespace - O(k): Scan line
- *    - String matching - O(k): strstr() calls
- *    - Parse ID - O(1): sscanf() for integer
- *    - Parse name - O(k): String search and copy
- *    - Parse grades:
- *      - strchr() for brackets - O(k)
- *      - add_student() - O(n): Check duplicates
- *      - strtok() loop - O(g): Parse g grades
- *      - add_grade_to_student() - O(n + g) each:
- *        * Search student: O(n)
- *        * Add grade: O(g) for realloc and recalc
+ * 1. fopen() + fseek() past the header - O(1)
+ * 2. Record pass - O(n + N): put_varint() the zigzag ID delta, count,
+ *    grade sum and name length, then the name; IDs in slot order, so a
+ *    registry sorted by ID stores mostly one-byte deltas
+ * 3. Pad to SNAPSHOT_PACKED_ALIGN, then fwrite() each run of uint16_t
+ *    grades as one block - O(G)
+ * 4. Rewind and fwrite() the header, now that both offsets are known - O(1)
  *
- * Worst case for grades line:
- * - add_student: O(n)
- * - g × add_grade_to_student: g × O(n + g) = O(g×n + g²)
+ * With sel only the listed slots are written, in that order.
  *
- * Overall: O(L × (n + g×n + g²)) ≈ O(L × n × g) typically
- * In practice: O(n × g) as L ≈ constant per student
+ * Overall: O(n + G + N)
  */
-/* Simple JSON parser for loading students */
-bool load_students_from_file(void)
+static bool save_binary_packed(StudentRegistry *reg, const char *path, const int *sel, int nsel, unsigned long seq)
 {
-    FILE *fp = fopen(DATA_FILE, "r");
+    FILE *fp = fopen(path, "wb");
     if (!fp)
     {
-        /* File doesn't exist yet - not an error for first run */
-        return true;
+        perror("Error opening file for writing");
+        return false;
     }
 
-    char line[512];
-    int current_id = -1;
-    char current_name[NAME_LEN] = {0};
-    bool in_student = false;
+    int count = sel ? nsel : registry_student_slots(reg);
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, 4);
+    h.version = SNAPSHOT_VERSION_PACKED;
+    h.journal_seq = seq;
+    h.students_offset = sizeof(SnapshotHeader);
+    bool ok = fseek(fp, (long)h.students_offset, SEEK_SET) == 0;
 
-    while (fgets(line, sizeof(line), fp))
+    OutBuf out;
+    ob_init(&out, fp);
+    int64_t prev = 0;
+    for (int i = 0; i < count; i++)
     {
-        /* Skip whitespace */
-        char *p = line;
-        while (*p == ' ' || *p == '\t')
-            p++;
-
-        /* Parse ID */
-        if (strstr(p, "\"id\":"))
-        {
-            sscanf(p, "\"id\": %d", &current_id);
-            in_student = true;
-        }
-        /* Parse name */
-        else if (strstr(p, "\"name\":"))
-        {
-            char *start = strchr(p, '"');
-            if (start)
-            {
-                start = strchr(start + 1, '"');
-                if (start)
-                {
-                    start++;
-                    char *end = strchr(start, '"');
-                    if (end)
-                    {
-                        int len = end - start;
-                        if (len >= NAME_LEN)
-                            len = NAME_LEN - 1;
-                        strncpy(current_name, start, len);
-                        current_name[len] = '\0';
-                    }
-                }
-            }
-        }
-        /* Parse grades array */
-        else if (strstr(p, "\"grades\":"))
-        {
-
-            /* Add student first if we have id and name */
-            if (current_id >= 0 && strlen(current_name) > 0)
-            {
-                add_student(current_id, current_name);
-            }
-
-            /* Parse grades from the same line */
-            char *start = strchr(p, '[');
-            char *end = strchr(p, ']');
-            if (start && end && current_id >= 0)
-            {
-                start++;
-                char *token = strtok(start, ",");
-                while (token && token < end)
-                {
-                    float grade;
-                    if (sscanf(token, "%f", &grade) == 1)
-                    {
-                        add_grade_to_student(current_id, grade);
-                    }
-                    token = strtok(NULL, ",");
-                }
-            }
-        }
-        /* End of student object */
-        else if (strstr(p, "}") && in_student)
-        {
-            /* Reset for next student */
-            current_id = -1;
-            current_name[0] = '\0';
-            in_student = false;
-        }
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+        if (!s)
+            continue;
+        int64_t delta = (int64_t)s->id - prev;
+        prev = s->id;
+        put_varint(&out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        put_varint(&out, (uint64_t)s->gradeCount);
+        /* A mapped run's running sum is only rebuilt from its average */
+        put_varint(&out, s->cold->gradeStorage == GRADES_MAPPED ? sum_grade_values(student_grades(s), s->gradeCount)
+                                                                : s->cold->gradeSum);
+        put_varint(&out, s->cold->name_len);
+        ob_write(&out, registry_student_name(reg, s), s->cold->name_len);
+        h.student_count++;
+        h.grade_count += (uint64_t)s->gradeCount;
+    }
+    ok = ob_finish(&out) && ok;
+    long end = ftell(fp);
+    if (end < 0)
+        ok = false;
+    else
+    {
+        static const char pad[SNAPSHOT_PACKED_ALIGN];
+        size_t gap = (SNAPSHOT_PACKED_ALIGN - (size_t)end % SNAPSHOT_PACKED_ALIGN) % SNAPSHOT_PACKED_ALIGN;
+        fwrite(pad, 1, gap, fp);
+        h.grades_offset = (uint64_t)end + gap;
+    }
+    for (int i = 0; ok && i < count; i++)
+    {
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+        if (s && s->gradeCount > 0)
+            fwrite(student_grades(s), sizeof(GradeValue), s->gradeCount, fp);
+    }
+    h.record_count = h.record_capacity = h.student_count;
+    h.heap_end = h.grade_count;
+    long bytes = ftell(fp);
+    ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, fp) == 1 && !ferror(fp);
+    if (bytes > 0)
+        INSTR_ADD(INSTR_SAVE_BYTES, bytes);
+    if (fclose(fp) != 0 || !ok)
+    {
+        perror("Error writing data file");
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ * save_binary - Save all students to a binary snapshot
+ *
+ * Time Complexity: O(n + G) where n is students, G is total grades
+ * Space Complexity: O(1) - fixed record buffer; O(n) for df's table
+ *
+ * Complexity Analysis:
+ * 1. fopen() - O(1): Open file for writing
+ * 2. First pass - O(n): Count live students and their grades for the
+ *    header; tombstones are skipped in every pass
+ * 3. fwrite() header - O(1): With df, reserve free record slots for
+ *    later patches
+ * 4. Second pass - O(n): Fill fixed-width records in batches of
+ *    SNAPSHOT_BATCH and fwrite() each batch; note each ID's slot in df
+ * 5. fseek() over the free slots - O(1): Left as a hole
+ * 6. Third pass - O(G): fwrite() each student's grade run as one block
+ * 7. Names - O(N) where N is name bytes: fwrite() the registry's name
+ *    arena as one block when every student is saved and at most a
+ *    quarter of it is garbage, so records keep their arena offsets;
+ *    otherwise fwrite() each name packed, in record order
+ * 8. fclose() - O(1)
+ *
+ * No text formatting: every field is written as raw bytes. With sel
+ * only the listed slots are written, in that order. df (may be NULL)
+ * describes the new file afterwards, so save_binary_patch() can update
+ * it; runs are written without slack. Quantized builds write
+ * save_binary_packed() instead and leave df empty.
+ *
+ * Overall: O(n + G + N) time, O(1) space
+ */
+#define SNAPSHOT_BATCH 256
+static bool save_binary(StudentRegistry *reg, const char *path, const int *sel, int nsel, unsigned long seq,
+                        DiskFile *df)
+{
+#ifdef SMS_QUANTIZED_GRADES
+    if (df)
+        disk_file_reset(df);
+    return save_binary_packed(reg, path, sel, nsel, seq);
+#else
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        perror("Error opening file for writing");
+        return false;
+    }
+
+    int count = sel ? nsel : registry_student_slots(reg);
+    uint32_t arena_used, arena_garbage;
+    const char *arena = registry_name_arena(reg, &arena_used, &arena_garbage);
+    bool verbatim = !sel && arena && (uint64_t)arena_garbage * 4 <= arena_used;
+    uint64_t name_units = 0;
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, 4);
+    h.version = SNAPSHOT_VERSION;
+    h.journal_seq = seq;
+    for (int i = 0; i < count; i++)
+    {
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+        if (!s)
+            continue;
+        h.student_count++;
+        h.grade_count += (uint64_t)s->gradeCount;
+        name_units += NAME_STORED_SIZE(s->cold->name_len) / sizeof(float);
+    }
+    h.record_count = h.student_count;
+    h.record_capacity = h.student_count;
+    if (df)
+        h.record_capacity += h.student_count / SNAPSHOT_SLACK_DIV + SNAPSHOT_SLACK_MIN;
+    if (verbatim)
+    {
+        name_units = arena_used / sizeof(float);
+        h.heap_garbage = arena_garbage / sizeof(float);
+    }
+    h.heap_end = h.grade_count + name_units;
+    h.students_offset = sizeof(SnapshotHeader);
+    h.grades_offset = h.students_offset + (uint64_t)h.record_capacity * sizeof(SnapshotStudent);
+    fwrite(&h, sizeof(h), 1, fp);
+    if (df && !disk_file_init(df, h.record_capacity))
+        df = NULL;
+
+    SnapshotStudent batch[SNAPSHOT_BATCH];
+    int used = 0;
+    uint32_t slot = 0;
+    uint64_t first = 0, name_first = h.grade_count;
+    for (int i = 0; i < count; i++)
+    {
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+        if (!s)
+            continue;
+        SnapshotStudent *r = &batch[used++];
+        memset(r, 0, sizeof(*r));
+        r->id = s->id;
+        r->grade_count = r->grade_cap = (uint32_t)s->gradeCount;
+        r->grade_first = first;
+        r->average = s->average;
+        r->seq = seq;
+        r->name_len = s->cold->name_len;
+        if (verbatim)
+            r->name_first = h.grade_count + s->cold->name_off / sizeof(float);
+        else
+        {
+            r->name_first = name_first;
+            name_first += NAME_STORED_SIZE(r->name_len) / sizeof(float);
+        }
+        first += (uint64_t)s->gradeCount;
+        if (df)
+        {
+            DiskSlot *b = disk_slot(df, s->id);
+            b->id = s->id;
+            b->slot = (int32_t)slot;
+        }
+        slot++;
+        if (used == SNAPSHOT_BATCH)
+        {
+            fwrite(batch, sizeof(SnapshotStudent), used, fp);
+            used = 0;
+        }
+    }
+    if (used > 0)
+        fwrite(batch, sizeof(SnapshotStudent), used, fp);
+
+    /* Free slots stay a hole in the file */
+    fseek(fp, (long)h.grades_offset, SEEK_SET);
+    for (int i = 0; i < count; i++)
+    {
+        Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+        if (s && s->gradeCount > 0)
+            fwrite(student_grades(s), sizeof(float), s->gradeCount, fp);
+    }
+    if (verbatim)
+        fwrite(arena, 1, arena_used, fp);
+    else
+    {
+        /* Zero padding after each NUL, as in the arena */
+        static const char pad[4];
+        for (int i = 0; i < count; i++)
+        {
+            Student *s = registry_get_student_by_index(reg, sel ? sel[i] : i);
+            if (!s)
+                continue;
+            uint32_t len = s->cold->name_len;
+            fwrite(registry_student_name(reg, s), 1, len, fp);
+            fwrite(pad, 1, NAME_STORED_SIZE(len) - len, fp);
+        }
+    }
+
+    bool ok = !ferror(fp);
+    long bytes = ftell(fp);
+    if (bytes > 0)
+        INSTR_ADD(INSTR_SAVE_BYTES, bytes);
+    if (fclose(fp) != 0 || !ok)
+    {
+        perror("Error writing data file");
+        if (df)
+            disk_file_reset(df);
+        return false;
+    }
+    if (df)
+    {
+        df->h = h;
+        df->valid = true;
+    }
+    return true;
+#endif
+}
+
+/* Patching writes float runs; quantized builds never patch */
+#ifndef SMS_QUANTIZED_GRADES
+/**
+ * write_at - pwrite() all of a buffer at an offset
+ *
+ * Time Complexity: O(b) where b is len
+ * Space Complexity: O(1)
+ *
+ * Overall: O(b) - retries short writes and EINTR
+ */
+static bool write_at(int fd, const void *buf, size_t len, uint64_t off)
+{
+    const char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, p, len, (off_t)off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+        off += (uint64_t)n;
+    }
+    return true;
+}
+
+/**
+ * read_at - pread() exactly len bytes at an offset
+ *
+ * Time Complexity: O(b) where b is len
+ * Space Complexity: O(1)
+ *
+ * Overall: O(b)
+ */
+static bool read_at(int fd, void *buf, size_t len, uint64_t off)
+{
+    char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = pread(fd, p, len, (off_t)off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+        off += (uint64_t)n;
+    }
+    return true;
+}
+
+/**
+ * patch_record - Bring one student's record in the open snapshot up to date
+ *
+ * Time Complexity: O(g) for the grades written, O(1) system calls
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. disk_slot() - O(1) expected: Find the ID's record
+ * 2. Deleted student - O(1): pread() its record, set SNAPSHOT_DEAD,
+ *    count its run and name as garbage
+ * 3. New student - O(1): Take the next free slot
+ * 4. Grades - O(g_new):
+ *    - still fit the run: pwrite() only those past the old count, so
+ *      runs another process or a lazy mapping still reads never change
+ *    - otherwise: move to a fresh run of twice the count at heap_end
+ *      and count the old run as garbage
+ * 5. Name - O(k) where k ≤ NAME_LEN: pread() the stored name when the
+ *    length matches; a different one is appended at heap_end and the
+ *    old one counted as garbage, never overwritten
+ * 6. pwrite() the record last - O(1): It only points at grades and a
+ *    name already written, and its seq lets replay skip what it
+ *    already holds
+ *
+ * s == NULL means the student is gone; otherwise s lives in reg. Updates
+ * df->h, not the file's header. Returns false on an I/O error.
+ *
+ * Overall: O(g_new + k)
+ */
+static bool patch_record(int fd, DiskFile *df, StudentRegistry *reg, int id, const Student *s, unsigned long seq)
+{
+    SnapshotHeader *h = &df->h;
+    DiskSlot *b = disk_slot(df, id);
+    bool known = b->slot >= 0;
+    SnapshotStudent r;
+    uint64_t at = h->students_offset + (uint64_t)(known ? b->slot : 0) * sizeof(SnapshotStudent);
+    if (known && !read_at(fd, &r, sizeof(r), at))
+        return false;
+    if (!s)
+    {
+        if (!known)
+            return true;
+        r.flags |= SNAPSHOT_DEAD;
+        r.seq = seq;
+        h->student_count--;
+        h->grade_count -= r.grade_count;
+        h->heap_garbage += r.grade_cap + NAME_STORED_SIZE(r.name_len) / sizeof(float);
+        b->slot = -1;
+        return write_at(fd, &r, sizeof(r), at);
+    }
+    if (!known)
+    {
+        memset(&r, 0, sizeof(r));
+        b->id = id;
+        b->slot = (int32_t)h->record_count++;
+        at = h->students_offset + (uint64_t)b->slot * sizeof(SnapshotStudent);
+        h->student_count++;
+    }
+
+    uint32_t g = (uint32_t)s->gradeCount;
+    uint64_t run = h->grades_offset + r.grade_first * sizeof(float);
+    if (g >= r.grade_count && g <= r.grade_cap)
+    {
+        if (g > r.grade_count &&
+            !write_at(fd, student_grades(s) + r.grade_count, (g - r.grade_count) * sizeof(float),
+                      run + r.grade_count * sizeof(float)))
+            return false;
+    }
+    else
+    {
+        h->heap_garbage += r.grade_cap;
+        r.grade_first = h->heap_end;
+        r.grade_cap = g < 2 ? 4 : 2 * g;
+        h->heap_end += r.grade_cap;
+        if (!write_at(fd, student_grades(s), g * sizeof(float), h->grades_offset + r.grade_first * sizeof(float)))
+            return false;
+    }
+    h->grade_count += (uint64_t)g - r.grade_count;
+    INSTR_ADD(INSTR_SAVE_BYTES, (uint64_t)g * sizeof(float) + sizeof(r));
+
+    const char *name = registry_student_name(reg, s);
+    uint32_t len = s->cold->name_len;
+    bool same = false;
+    if (known && r.name_len == len)
+    {
+        char old[NAME_LEN];
+        if (!read_at(fd, old, len, h->grades_offset + r.name_first * sizeof(float)))
+            return false;
+        same = memcmp(old, name, len) == 0;
+    }
+    if (!same)
+    {
+        uint32_t size = NAME_STORED_SIZE(len);
+        char buf[NAME_STORED_SIZE(NAME_LEN)] = {0};
+        memcpy(buf, name, len);
+        if (known)
+            h->heap_garbage += NAME_STORED_SIZE(r.name_len) / sizeof(float);
+        r.name_first = h->heap_end;
+        r.name_len = len;
+        h->heap_end += size / sizeof(float);
+        if (!write_at(fd, buf, size, h->grades_offset + r.name_first * sizeof(float)))
+            return false;
+        INSTR_ADD(INSTR_SAVE_BYTES, size);
+    }
+
+    r.id = id;
+    r.grade_count = g;
+    r.average = s->average;
+    r.seq = seq;
+    r.flags = 0;
+    return write_at(fd, &r, sizeof(r), at);
+}
+#endif
+
+/**
+ * save_binary_patch - Rewrite only the changed records of a known snapshot
+ *
+ * Time Complexity: O(d + g_d) where d is changed IDs and g_d their new
+ *                  grades - independent of the registry size
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Bail out to a full rewrite when the build writes packed snapshots
+ *    (not compiled in), df is unknown, the journal holds no record
+ *    newer than the file (only replay can repair a torn patch, so
+ *    unjournaled batch changes always use rename()), too many records
+ *    changed (d × SNAPSHOT_PATCH_DIV > record_count) or half the grade
+ *    region is garbage - O(1)
+ * 2. Count new students against the free slots - O(d) expected:
+ *    Refuse before writing anything if they do not fit
+ * 3. open() + pread() the header - O(1): Must still be the file df
+ *    describes (same sequence, record count and heap end)
+ * 4. patch_record() per changed ID - O(d + g_d)
+ * 5. pwrite() the header with the new sequence - O(1): Records patched
+ *    before a crash here carry their own seq, so replay still applies
+ *    each journal record exactly once
+ *
+ * ids may repeat an ID and may name deleted students. Returns false
+ * when the caller must rewrite the file; after an I/O error df is
+ * reset.
+ *
+ * Overall: O(d + g_d)
+ */
+static bool save_binary_patch(StudentRegistry *reg, DiskFile *df, const char *path, const int *ids, int nids,
+                              unsigned long seq)
+{
+#ifdef SMS_QUANTIZED_GRADES
+    /* Packed snapshots have no slots to patch */
+    (void)reg;
+    (void)df;
+    (void)path;
+    (void)ids;
+    (void)nids;
+    (void)seq;
+    return false;
+#else
+    if (!df->valid || seq <= df->h.journal_seq || nids < 0 ||
+        (uint64_t)nids * SNAPSHOT_PATCH_DIV > df->h.record_count || df->h.heap_garbage * 2 > df->h.heap_end)
+        return false;
+    uint32_t fresh = 0;
+    for (int i = 0; i < nids; ++i)
+        if (disk_slot(df, ids[i])->slot < 0 && registry_find_student_index(reg, ids[i]) != -1)
+            fresh++;
+    if (fresh > df->h.record_capacity - df->h.record_count)
+        return false;
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0)
+        return false;
+    SnapshotHeader cur;
+    bool ok = read_at(fd, &cur, sizeof(cur), 0) && cur.journal_seq == df->h.journal_seq &&
+              cur.record_count == df->h.record_count && cur.heap_end == df->h.heap_end;
+    if (!ok)
+    {
+        close(fd);
+        disk_file_reset(df);
+        return false;
+    }
+
+    INSTR_INC(INSTR_SAVE_PATCH);
+    INSTR_TIMER_START(t0);
+    for (int i = 0; ok && i < nids; ++i)
+    {
+        int idx = registry_find_student_index(reg, ids[i]);
+        ok = patch_record(fd, df, reg, ids[i], idx == -1 ? NULL : registry_get_student_by_index(reg, idx), seq);
+    }
+    df->h.journal_seq = seq;
+    ok = ok && write_at(fd, &df->h, sizeof(df->h), 0);
+    if (close(fd) != 0)
+        ok = false;
+    INSTR_TIMER_STOP(INSTR_T_SAVE, t0);
+    if (!ok)
+    {
+        perror("Error patching data file");
+        disk_file_reset(df);
+    }
+    return ok;
+#endif
+}
+
+/**
+ * save_selection - Save all students or the listed slots, format by extension
+ *
+ * Time Complexity: O(n × g) - see save_json() / save_binary()
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. is_binary_path() - O(k): Check for BINARY_EXTENSION
+ * 2. save_binary() or save_json() into path.tmp - O(n × g)
+ * 3. rename() over path - O(1): Readers never see a half-written file,
+ *    and a snapshot still mapped for lazy grades keeps its old inode
+ *    instead of being truncated under the mapping
+ * 4. Count and time the save - O(1)
+ *
+ * sel == NULL saves every student of reg; seq is the journal sequence
+ * the file records. df, if given, is reset and then describes the new
+ * file when it is binary. Only reads reg, so shard saves and the
+ * background writer may run on other threads.
+ *
+ * Overall: O(n × g)
+ */
+static bool save_selection(StudentRegistry *reg, const char *path, const int *sel, int nsel, unsigned long seq,
+                           DiskFile *df)
+{
+    char *tmp = malloc(strlen(path) + sizeof(".tmp"));
+    if (!tmp)
+    {
+        fprintf(stderr, "Memory allocation failed for save path.\n");
+        return false;
+    }
+    strcpy(tmp, path);
+    strcat(tmp, ".tmp");
+    INSTR_INC(INSTR_SAVE);
+    INSTR_TIMER_START(t0);
+    if (df)
+        disk_file_reset(df);
+    bool ok = is_binary_path(path) ? save_binary(reg, tmp, sel, nsel, seq, df) : save_json(reg, tmp, sel, nsel, seq);
+    if (ok && rename(tmp, path) != 0)
+    {
+        perror("Error replacing data file");
+        ok = false;
+    }
+    if (!ok)
+    {
+        remove(tmp);
+        if (df)
+            disk_file_reset(df);
+    }
+    free(tmp);
+    INSTR_TIMER_STOP(INSTR_T_SAVE, t0);
+    return ok;
+}
+
+/**
+ * save_students_to_path - Save all students, format chosen by extension
+ *
+ * Time Complexity: O(n × g) - see save_selection()
+ * Space Complexity: O(1)
+ *
+ * Always one file, whatever the shard count; used for --export.
+ *
+ * Overall: O(n × g)
+ */
+bool save_students_to_path(const char *path)
+{
+    return save_selection(default_registry(), path, NULL, 0, journal_seq, NULL);
+}
+
+/* One shard file to load or save on its own thread */
+typedef struct
+{
+    char path[SHARD_PATH_MAX];
+    int shard;
+    const int *sel;         /* save: the shard's slots in reg */
+    int nsel;
+    const int *ids;         /* save: the shard's changed IDs, for a patch */
+    int nids;
+    StudentRegistry *reg;   /* save: registry read; load: private registry filled */
+    unsigned long seq;      /* journal sequence written or found in the file */
+    bool misplaced;         /* load: holds students of other shards */
+    bool ok;
+    pthread_t thread;
+    bool threaded;
+} ShardJob;
+
+/**
+ * run_shard_jobs - Run fn on every job, one thread each
+ *
+ * Time Complexity: O(max job) wall clock with enough cores, O(sum) CPU
+ * Space Complexity: O(j) thread stacks
+ *
+ * Complexity Analysis:
+ * 1. pthread_create() per job - O(j); a job whose thread cannot be
+ *    started runs inline instead
+ * 2. pthread_join() all - O(j)
+ *
+ * Overall: O(max job) with j ≤ SHARD_MAX cores
+ */
+static void run_shard_jobs(ShardJob *jobs, int n, void *(*fn)(void *))
+{
+    for (int i = 0; i < n; ++i)
+    {
+        jobs[i].threaded = pthread_create(&jobs[i].thread, NULL, fn, &jobs[i]) == 0;
+        if (!jobs[i].threaded)
+            fn(&jobs[i]);
+    }
+    for (int i = 0; i < n; ++i)
+        if (jobs[i].threaded)
+            pthread_join(jobs[i].thread, NULL);
+}
+
+/**
+ * patch_shard_run - Thread body: patch one shard file in place
+ *
+ * Time Complexity: O(d_k + g_d) for the shard's changed students
+ * Space Complexity: O(1)
+ *
+ * Overall: O(d_k + g_d)
+ */
+static void *patch_shard_run(void *arg)
+{
+    ShardJob *job = arg;
+    job->ok = is_binary_path(job->path) &&
+              save_binary_patch(job->reg, &disk_files[job->shard], job->path, job->ids, job->nids, job->seq);
+    return NULL;
+}
+
+/**
+ * save_shard_run - Thread body: write one shard file not yet patched
+ *
+ * Time Complexity: O(n_k × g) for the shard's students
+ * Space Complexity: O(1)
+ *
+ * Overall: O(n_k × g)
+ */
+static void *save_shard_run(void *arg)
+{
+    ShardJob *job = arg;
+    if (job->ok)
+        return NULL; /* already patched */
+    job->ok = save_selection(job->reg, job->path, job->sel, job->nsel, job->seq, &disk_files[job->shard]);
+    return NULL;
+}
+
+/**
+ * save_shards - Patch or rewrite the shards that changed, in parallel
+ *
+ * Time Complexity: O(d + g_d) when every changed shard can be patched;
+ *                  otherwise O(n) to partition plus O(n_r × g) for the
+ *                  students of rewritten shards, spread over threads
+ * Space Complexity: O(d), O(n) once a shard is rewritten
+ *
+ * Complexity Analysis:
+ * 1. Shards flagged in dirty, and shards whose file is missing, become
+ *    jobs - O(s)
+ * 2. Group the changed IDs by shard_of() - O(d): Counting sort
+ * 3. run_shard_jobs(patch_shard_run) - save_binary_patch() per job
+ * 4. Jobs it refused: counting pass and placement pass over reg's
+ *    slots - O(n): Live slots grouped by shard, in slot order; then
+ *    run_shard_jobs(save_shard_run) - each writes its file via
+ *    save_selection(), so an interrupted save never leaves a torn shard
+ * 5. Clear dirty for written shards and record seq for them - O(s)
+ * 6. Remove stale shard files once everything was written - O(s)
+ *
+ * A shard that failed stays dirty and keeps its old file and sequence,
+ * so its journal records still replay. dirty is shard_dirty for a
+ * foreground save and the writer's own copy for a background one; nids
+ * < 0 rewrites every job.
+ *
+ * Overall: O(d + g_d) patched, O(n + n_r × g) rewritten
+ */
+static bool save_shards(StudentRegistry *reg, bool *dirty, const int *ids, int nids, unsigned long seq)
+{
+    ShardJob *jobs = calloc((size_t)shard_count, sizeof(ShardJob));
+    int *by_shard = malloc((size_t)(nids > 0 ? nids : 1) * sizeof(int));
+    if (!jobs || !by_shard)
+    {
+        fprintf(stderr, "Memory allocation failed (shard save).\n");
+        free(jobs);
+        free(by_shard);
+        return false;
+    }
+    int start[SHARD_MAX + 1] = {0};
+    int fill[SHARD_MAX];
+    for (int i = 0; i < nids; ++i)
+        start[shard_of(ids[i]) + 1]++;
+    for (int k = 0; k < shard_count; ++k)
+        start[k + 1] += start[k];
+    memcpy(fill, start, sizeof(fill));
+    for (int i = 0; i < nids; ++i)
+        by_shard[fill[shard_of(ids[i])]++] = ids[i];
+
+    int njobs = 0;
+    for (int k = 0; k < shard_count; ++k)
+    {
+        if (!dirty[k] && shard_exists(k))
+            continue;
+        ShardJob *job = &jobs[njobs++];
+        shard_path(job->path, k);
+        job->shard = k;
+        job->reg = reg;
+        job->seq = seq;
+        job->ids = by_shard + start[k];
+        job->nids = nids < 0 ? -1 : start[k + 1] - start[k];
+    }
+    run_shard_jobs(jobs, njobs, patch_shard_run);
+
+    int nfull = 0;
+    for (int i = 0; i < njobs; ++i)
+        nfull += !jobs[i].ok;
+    int *sel = NULL;
+    if (nfull > 0)
+    {
+        int slots = registry_student_slots(reg);
+        sel = malloc((size_t)(slots > 0 ? slots : 1) * sizeof(int));
+        if (!sel)
+        {
+            fprintf(stderr, "Memory allocation failed (shard save).\n");
+            njobs = 0;
+        }
+        else
+        {
+            memset(start, 0, sizeof(start));
+            for (int i = 0; i < slots; ++i)
+            {
+                Student *s = registry_get_student_by_index(reg, i);
+                if (s)
+                    start[shard_of(s->id) + 1]++;
+            }
+            for (int k = 0; k < shard_count; ++k)
+                start[k + 1] += start[k];
+            memcpy(fill, start, sizeof(fill));
+            for (int i = 0; i < slots; ++i)
+            {
+                Student *s = registry_get_student_by_index(reg, i);
+                if (s)
+                    sel[fill[shard_of(s->id)]++] = i;
+            }
+            for (int i = 0; i < njobs; ++i)
+            {
+                jobs[i].sel = sel + start[jobs[i].shard];
+                jobs[i].nsel = start[jobs[i].shard + 1] - start[jobs[i].shard];
+            }
+            run_shard_jobs(jobs, njobs, save_shard_run);
+        }
+    }
+
+    bool ok = njobs > 0 || nfull == 0;
+    for (int i = 0; i < njobs; ++i)
+    {
+        if (!jobs[i].ok)
+        {
+            ok = false;
+            continue;
+        }
+        dirty[jobs[i].shard] = false;
+        shard_seq[jobs[i].shard] = seq;
+    }
+    if (ok)
+    {
+        for (; stale_shards > 0; --stale_shards)
+        {
+            char path[SHARD_PATH_MAX];
+            shard_path(path, shard_count + stale_shards - 1);
+            remove(path);
+        }
+    }
+    free(jobs);
+    free(by_shard);
+    free(sel);
+    return ok;
+}
+
+/**
+ * save_data - Save reg to the data file or its shards, patching if possible
+ *
+ * Time Complexity: O(d + g_d) when the changes can be patched in place,
+ *                  O(n × g) for a rewrite
+ * Space Complexity: O(1), O(n) sharded
+ *
+ * Complexity Analysis:
+ * 1. registry_dirty_ids() - O(1): What changed since the last save
+ * 2. Sharded: save_shards() - patches or rewrites each dirty shard
+ * 3. Unsharded: save_binary_patch(), else save_selection() - O(n × g)
+ * 4. On failure disk_files_reset() - O(s): The caller drops the dirty
+ *    list either way, so the next save must rewrite everything
+ *
+ * Overall: O(d + g_d) patched, O(n × g) rewritten
+ */
+static bool save_data(StudentRegistry *reg, bool *dirty, unsigned long seq)
+{
+    const int *ids;
+    int nids = registry_dirty_ids(reg, &ids);
+    bool ok;
+    if (shard_count > 1)
+        ok = save_shards(reg, dirty, ids, nids, seq);
+    else
+        ok = (is_binary_path(data_file) && save_binary_patch(reg, &disk_files[0], data_file, ids, nids, seq)) ||
+             save_selection(reg, data_file, NULL, 0, seq, &disk_files[0]);
+    if (!ok)
+        disk_files_reset();
+    return ok;
+}
+
+/**
+ * save_students_to_file - Save all students to the active data file
+ *
+ * Time Complexity: O(d + g_d) for d changed students of a binary
+ *                  snapshot, O(n × g) when it is rewritten - see save_data()
+ * Space Complexity: O(1), O(n) sharded
+ *
+ * Complexity Analysis:
+ * 1. flush_background_save() - O(1) when idle: Never race the writer
+ *    on the same files
+ * 2. save_data() - O(d + g_d) patched in place, O(n × g) rewritten
+ * 3. registry_clear_dirty() - O(d)
+ * 4. Record the folded journal sequence - O(1)
+ *
+ * Overall: O(d + g_d) patched, O(n × g) rewritten
+ */
+bool save_students_to_file(void)
+{
+    flush_background_save();
+    bool ok = save_data(default_registry(), shard_dirty, journal_seq);
+    registry_clear_dirty(default_registry());
+    if (!ok)
+        return false;
+    snapshot_seq = journal_seq;
+    return true;
+}
+
+/**
+ * set_background_save - Choose inline or background journal compaction
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Takes effect on the next journal append; the writer thread itself
+ * starts with the first background save, or with the first pending
+ * record when delay_ms is set.
+ *
+ * Overall: O(1)
+ */
+void set_background_save(bool enabled, long every, long delay_ms)
+{
+    background_save = enabled;
+    save_every = every > 0 ? (unsigned long)every : 0;
+    save_delay_ms = delay_ms > 0 ? delay_ms : 0;
+}
+
+/**
+ * monotonic_ms - Milliseconds on the monotonic clock
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) - one clock_gettime() (vDSO, no system call)
+ */
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * journal_lock - Keep timed background saves out of a change
+ *
+ * Time Complexity: O(1), or until a timed save has copied the registry
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) uncontended
+ */
+void journal_lock(void)
+{
+    pthread_mutex_lock(&journal_mutex);
+}
+
+/**
+ * journal_unlock - Release journal_lock()
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void journal_unlock(void)
+{
+    pthread_mutex_unlock(&journal_mutex);
+}
+
+/**
+ * writer_save - Write one snapshot copy to the active data file
+ *
+ * Time Complexity: O(n × g), or O(n + n_d × g) sharded
+ * Space Complexity: O(1), O(n) sharded
+ *
+ * Overall: O(n × g) - runs on the writer thread, off the foreground
+ */
+static bool writer_save(BackgroundSave *job)
+{
+    return save_data(job->reg, job->dirty, job->seq);
+}
+
+/**
+ * reap_background_save - Take the result of a finished background save
+ *
+ * Time Complexity: O(s) where s is the shard count
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Success: the snapshot now holds everything up to the copy's
+ *    sequence - O(1)
+ * 2. Shards the writer could not write become dirty again - O(s)
+ *
+ * Caller holds journal_lock() and writer_lock, so snapshot_seq and
+ * shard_dirty are only ever written under journal_lock().
+ *
+ * Overall: O(s)
+ */
+static void reap_background_save(void)
+{
+    if (writer_state != WRITER_DONE)
+        return;
+    if (writer_job.ok && writer_job.seq > snapshot_seq)
+        snapshot_seq = writer_job.seq;
+    for (int k = 0; k < shard_count; ++k)
+        if (writer_job.dirty[k])
+            shard_dirty[k] = true;
+    writer_state = WRITER_IDLE;
+}
+
+/**
+ * append_file - Append the whole of one file to another
+ *
+ * Time Complexity: O(b) where b is the size of src
+ * Space Complexity: O(1) - fixed copy buffer
+ *
+ * Overall: O(b)
+ */
+static bool append_file(const char *dst, const char *src)
+{
+    FILE *in = fopen(src, "r");
+    if (!in)
+        return true;
+    FILE *out = fopen(dst, "a");
+    bool ok = out != NULL;
+    char buf[8192];
+    size_t n;
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+        ok = fwrite(buf, 1, n, out) == n;
+    ok = ok && !ferror(in);
+    fclose(in);
+    if (out && fclose(out) != 0)
+        ok = false;
+    return ok;
+}
+
+/**
+ * rotate_journal - Move the journal's records aside for a background save
+ *
+ * Time Complexity: O(1), O(j) if an older rotation was never folded
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. close_journal() - O(1): The next append reopens a fresh file
+ * 2. rename() to journal_old_file - O(1)
+ * 3. If a failed background save left journal_old_file, append to it
+ *    with append_file() and truncate the journal instead - O(j)
+ *
+ * Until the copy is saved its records live only in journal_old_file;
+ * replay_journal() reads that file first, so a crash loses nothing.
+ *
+ * Overall: O(1) normally
+ */
+static bool rotate_journal(void)
+{
+    close_journal();
+    if (access(journal_old_file, F_OK) != 0)
+        return rename(journal_file, journal_old_file) == 0;
+    if (!append_file(journal_old_file, journal_file))
+        return false;
+    FILE *fp = fopen(journal_file, "w");
+    if (!fp)
+        return false;
+    fclose(fp);
+    return true;
+}
+
+/**
+ * start_background_save - Hand a copy of the registry to the writer
+ *
+ * Time Complexity: O(n + G) on the calling thread
+ * Space Complexity: O(n + G) for the copy until it is saved
+ *
+ * Complexity Analysis:
+ * 1. registry_clone() - O(n + G): The only pause edits see; memcpy()
+ *    of grades instead of formatting them, mapped runs shared
+ * 2. rotate_journal() - O(1): Newer records go to a fresh journal
+ * 3. Under writer_lock: move shard_dirty into the job, clear the
+ *    registry's dirty list (the copy has its own) and mark the job
+ *    WRITER_BUSY, then signal - O(s + d)
+ *
+ * Caller holds journal_lock(), under which every change is made, and
+ * ensures start_writer() ran and the writer is idle. Returns false if
+ * nothing was handed over; the journal is then untouched.
+ *
+ * Overall: O(n + G)
+ */
+static bool start_background_save(void)
+{
+    INSTR_TIMER_START(t0);
+    StudentRegistry *copy = registry_clone(default_registry());
+    INSTR_TIMER_STOP(INSTR_T_SNAPSHOT_COPY, t0);
+    if (!copy)
+        return false;
+    if (!rotate_journal())
+    {
+        perror("Error rotating journal");
+        registry_destroy(copy);
+        return false;
+    }
+    pthread_mutex_lock(&writer_lock);
+    writer_job.reg = copy;
+    writer_job.seq = journal_seq;
+    memcpy(writer_job.dirty, shard_dirty, sizeof(shard_dirty));
+    memset(shard_dirty, 0, sizeof(shard_dirty));
+    registry_clear_dirty(default_registry());
+    writer_state = WRITER_BUSY;
+    first_pending_ms = 0;
+    pthread_cond_broadcast(&writer_cond);
+    pthread_mutex_unlock(&writer_lock);
+    return true;
+}
+
+/**
+ * start_timed_save - Hand over a copy once the oldest pending record is due
+ *
+ * Time Complexity: O(n + G) - see start_background_save()
+ * Space Complexity: O(n + G) for the copy
+ *
+ * Complexity Analysis:
+ * 1. journal_lock() - waits for a change in progress to finish
+ * 2. Under writer_lock: reap_background_save() and check the deadline
+ *    again, since an append may have started a save meanwhile - O(s)
+ * 3. start_background_save() - O(n + G); if it fails, retry after
+ *    another save_delay_ms
+ *
+ * Runs on the writer thread without writer_lock held.
+ *
+ * Overall: O(n + G)
+ */
+static void start_timed_save(void)
+{
+    journal_lock();
+    pthread_mutex_lock(&writer_lock);
+    reap_background_save();
+    bool due = writer_state == WRITER_IDLE && !writer_stop && first_pending_ms > 0 &&
+               monotonic_ms() - first_pending_ms >= save_delay_ms;
+    pthread_mutex_unlock(&writer_lock);
+    if (due && !start_background_save())
+    {
+        pthread_mutex_lock(&writer_lock);
+        first_pending_ms = monotonic_ms();
+        pthread_mutex_unlock(&writer_lock);
+    }
+    journal_unlock();
+}
+
+/**
+ * wait_until_ms - pthread_cond_timedwait() on writer_cond until a monotonic time
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * writer_cond uses the realtime clock, so the remaining time is added
+ * to it; a clock step only makes the caller check its deadline early
+ * or late once.
+ *
+ * Overall: O(1)
+ */
+static void wait_until_ms(long long deadline)
+{
+    long long left = deadline - monotonic_ms();
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)(left / 1000);
+    ts.tv_nsec += (long)(left % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&writer_cond, &writer_lock, &ts);
+}
+
+/**
+ * writer_run - Writer thread body: save each handed-over copy
+ *
+ * Time Complexity: O(n × g) per save
+ * Space Complexity: O(1) besides the copy it frees
+ *
+ * Complexity Analysis:
+ * 1. Wait on writer_cond until a save is WRITER_BUSY or stop is set;
+ *    while records are pending and save_delay_ms is set, wait only
+ *    until the oldest is due, then start_timed_save() - O(n + G)
+ * 2. Unlocked: writer_save() - O(n × g); the foreground does not touch
+ *    writer_job while it is busy
+ * 3. Unlocked: on success remove journal_old_file, whose records the
+ *    new snapshot holds - O(1); registry_destroy() the copy - O(n)
+ * 4. Mark the save WRITER_DONE and wake flush_background_save()
+ *
+ * Records that arrive during a save are therefore picked up once they
+ * are due, even if no further edit comes.
+ *
+ * Overall: O(n × g) per save
+ */
+static void *writer_run(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&writer_lock);
+    for (;;)
+    {
+        while (writer_state != WRITER_BUSY && !writer_stop)
+        {
+            if (save_delay_ms == 0 || first_pending_ms == 0)
+                pthread_cond_wait(&writer_cond, &writer_lock);
+            else if (monotonic_ms() < first_pending_ms + save_delay_ms)
+                wait_until_ms(first_pending_ms + save_delay_ms);
+            else
+            {
+                pthread_mutex_unlock(&writer_lock);
+                start_timed_save();
+                pthread_mutex_lock(&writer_lock);
+            }
+        }
+        if (writer_state != WRITER_BUSY)
+            break;
+        pthread_mutex_unlock(&writer_lock);
+
+        INSTR_INC(INSTR_BACKGROUND_SAVE);
+        bool ok = writer_save(&writer_job);
+        if (ok)
+            remove(journal_old_file);
+        else
+            fprintf(stderr, "Background save failed; its journal records are kept.\n");
+        registry_destroy(writer_job.reg);
+
+        pthread_mutex_lock(&writer_lock);
+        writer_job.reg = NULL;
+        writer_job.ok = ok;
+        writer_state = WRITER_DONE;
+        pthread_cond_broadcast(&writer_cond);
+    }
+    pthread_mutex_unlock(&writer_lock);
+    return NULL;
+}
+
+/**
+ * start_writer - Start the writer thread on first use
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * The thread starts with every signal blocked, so SIGINT and SIGTERM
+ * reach the threads that handle them.
+ *
+ * Overall: O(1)
+ */
+static bool start_writer(void)
+{
+    if (writer_started)
+        return true;
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    writer_started = pthread_create(&writer_thread, NULL, writer_run, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return writer_started;
+}
+
+/**
+ * flush_background_save - Wait until no background save is running
+ *
+ * Time Complexity: O(n × g) worst case, while a save finishes
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Never started - O(1)
+ * 2. Wait on writer_cond while WRITER_BUSY
+ * 3. reap_background_save() - O(s)
+ *
+ * Records appended since the copy stay in the journal; the caller
+ * folds them, e.g. through compact_journal().
+ *
+ * Overall: O(1) when idle
+ */
+void flush_background_save(void)
+{
+    if (!writer_started)
+        return;
+    pthread_mutex_lock(&writer_lock);
+    while (writer_state == WRITER_BUSY)
+        pthread_cond_wait(&writer_cond, &writer_lock);
+    reap_background_save();
+    pthread_mutex_unlock(&writer_lock);
+}
+
+/**
+ * stop_background_save - Finish any background save and end the writer
+ *
+ * Time Complexity: O(n × g) worst case - see flush_background_save()
+ * Space Complexity: O(1)
+ *
+ * Must not be called with journal_lock() held: a writer already in
+ * start_timed_save() needs it before it sees writer_stop and exits.
+ *
+ * Overall: O(1) when idle
+ */
+void stop_background_save(void)
+{
+    if (!writer_started)
+        return;
+    flush_background_save();
+    pthread_mutex_lock(&writer_lock);
+    writer_stop = true;
+    pthread_cond_broadcast(&writer_cond);
+    pthread_mutex_unlock(&writer_lock);
+    pthread_join(writer_thread, NULL);
+    writer_started = writer_stop = false;
+}
+
+/* Streaming JSON reader: large buffered reads, one byte at a time */
+#define JSON_READ_SIZE (64 * 1024)
+
+typedef struct
+{
+    FILE *fp;
+    char *buf;
+    size_t pos;
+    size_t len;
+    long consumed; /* bytes before buf[0], for error offsets */
+} JsonReader;
+
+/**
+ * jr_fill - Refill the reader buffer from the file
+ *
+ * Time Complexity: O(B) where B is JSON_READ_SIZE
+ * Space Complexity: O(1) - reuses the buffer
+ *
+ * Overall: O(B) per refill, O(1) amortized per byte
+ */
+static bool jr_fill(JsonReader *r)
+{
+    r->consumed += (long)r->len;
+    r->len = fread(r->buf, 1, JSON_READ_SIZE, r->fp);
+    r->pos = 0;
+    return r->len > 0;
+}
+
+/**
+ * jr_peek - Return the next byte without consuming it (-1 at EOF)
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+static inline int jr_peek(JsonReader *r)
+{
+    if (r->pos == r->len && !jr_fill(r))
+        return -1;
+    return (unsigned char)r->buf[r->pos];
+}
+
+/**
+ * jr_get - Consume and return the next byte (-1 at EOF)
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+static inline int jr_get(JsonReader *r)
+{
+    if (r->pos == r->len && !jr_fill(r))
+        return -1;
+    return (unsigned char)r->buf[r->pos++];
+}
+
+/**
+ * jr_skip_ws - Skip JSON whitespace and return the next byte
+ *
+ * Time Complexity: O(w) where w is whitespace length
+ * Space Complexity: O(1)
+ *
+ * Any layout is accepted: objects may span lines or share one line.
+ *
+ * Overall: O(w)
+ */
+static int jr_skip_ws(JsonReader *r)
+{
+    int c;
+    while ((c = jr_peek(r)) == ' ' || c == '\n' || c == '\r' || c == '\t')
+        r->pos++;
+    return c;
+}
+
+/**
+ * jr_expect - Consume byte c after optional whitespace
+ *
+ * Time Complexity: O(w)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(w)
+ */
+static bool jr_expect(JsonReader *r, int c)
+{
+    if (jr_skip_ws(r) != c)
+        return false;
+    r->pos++;
+    return true;
+}
+
+/**
+ * jr_put_utf8 - Append a code point as UTF-8 if it fits
+ *
+ * Time Complexity: O(1) - at most 4 bytes
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void jr_put_utf8(char *out, size_t cap, size_t *n, unsigned cp)
+{
+    unsigned char tmp[4];
+    size_t k;
+    if (cp < 0x80)
+    {
+        tmp[0] = (unsigned char)cp;
+        k = 1;
+    }
+    else if (cp < 0x800)
+    {
+        tmp[0] = (unsigned char)(0xC0 | (cp >> 6));
+        tmp[1] = (unsigned char)(0x80 | (cp & 0x3F));
+        k = 2;
+    }
+    else if (cp < 0x10000)
+    {
+        tmp[0] = (unsigned char)(0xE0 | (cp >> 12));
+        tmp[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[2] = (unsigned char)(0x80 | (cp & 0x3F));
+        k = 3;
+    }
+    else
+    {
+        tmp[0] = (unsigned char)(0xF0 | (cp >> 18));
+        tmp[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+        tmp[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[3] = (unsigned char)(0x80 | (cp & 0x3F));
+        k = 4;
+    }
+    if (*n + k < cap)
+    {
+        memcpy(out + *n, tmp, k);
+        *n += k;
+    }
+}
+
+/**
+ * jr_hex4 - Read the 4 hex digits of a \u escape
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static bool jr_hex4(JsonReader *r, unsigned *out)
+{
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        int c = jr_get(r);
+        if (c >= '0' && c <= '9')
+            v = v * 16 + (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            v = v * 16 + (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            v = v * 16 + (unsigned)(c - 'A' + 10);
+        else
+            return false;
+    }
+    *out = v;
+    return true;
+}
+
+/**
+ * jr_string - Read a JSON string into out (truncated to cap - 1 bytes)
+ *
+ * Time Complexity: O(k) where k is the encoded string length
+ * Space Complexity: O(1) - writes into caller's buffer
+ *
+ * Complexity Analysis:
+ * 1. Expect opening quote - O(w)
+ * 2. Byte loop - O(k):
+ *    - Plain bytes copied while room remains
+ *    - Escapes decoded, \uXXXX (and surrogate pairs) emitted as UTF-8
+ * 3. Stop at closing quote - O(1)
+ *
+ * Overall: O(k)
+ */
+static bool jr_string(JsonReader *r, char *out, size_t cap)
+{
+    if (!jr_expect(r, '"'))
+        return false;
+    size_t n = 0;
+    while (1)
+    {
+        int c = jr_get(r);
+        if (c < 0)
+            return false;
+        if (c == '"')
+            break;
+        if (c == '\\')
+        {
+            c = jr_get(r);
+            switch (c)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                break;
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            case 'u':
+            {
+                unsigned cp;
+                if (!jr_hex4(r, &cp))
+                    return false;
+                if (cp >= 0xD800 && cp < 0xDC00 && jr_peek(r) == '\\')
+                {
+                    unsigned lo;
+                    r->pos++;
+                    if (jr_get(r) != 'u' || !jr_hex4(r, &lo))
+                        return false;
+                    if (lo >= 0xDC00 && lo < 0xE000)
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                jr_put_utf8(out, cap, &n, cp);
+                continue;
+            }
+            default:
+                return false;
+            }
+        }
+        if (n + 1 < cap)
+            out[n++] = (char)c;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+/**
+ * jr_number - Read a JSON number
+ *
+ * Time Complexity: O(d) where d is number of digits
+ * Space Complexity: O(1) - fixed scratch buffer
+ *
+ * Complexity Analysis:
+ * 1. Collect number characters - O(d)
+ * 2. strtod() - O(d): Convert
+ *
+ * Overall: O(d)
+ */
+static bool jr_number(JsonReader *r, double *out)
+{
+    char tmp[64];
+    size_t n = 0;
+    int c = jr_skip_ws(r);
+    while ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+    {
+        if (n + 1 >= sizeof(tmp))
+            return false;
+        tmp[n++] = (char)c;
+        r->pos++;
+        c = jr_peek(r);
+    }
+    if (n == 0)
+        return false;
+    tmp[n] = '\0';
+    char *end;
+    *out = strtod(tmp, &end);
+    return *end == '\0';
+}
+
+/**
+ * jr_skip_value - Skip any JSON value (used for unknown keys)
+ *
+ * Time Complexity: O(v) where v is the encoded value length
+ * Space Complexity: O(1) - nesting tracked with a depth counter
+ *
+ * Complexity Analysis:
+ * 1. Scalars and strings - O(v): Consumed directly
+ * 2. Objects/arrays - O(v): Bytes consumed until depth returns to 0,
+ *    strings inside are skipped so brackets in them are ignored
+ *
+ * Overall: O(v)
+ */
+static bool jr_skip_value(JsonReader *r)
+{
+    int depth = 0;
+    do
+    {
+        int c = jr_skip_ws(r);
+        if (c < 0)
+            return false;
+        if (c == '"')
+        {
+            char dummy[1];
+            if (!jr_string(r, dummy, sizeof(dummy)))
+                return false;
+        }
+        else if (c == '{' || c == '[')
+        {
+            r->pos++;
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            r->pos++;
+            depth--;
+        }
+        else if (c == ',' || c == ':')
+        {
+            r->pos++;
+        }
+        else
+        {
+            /* number or literal (true/false/null) */
+            while ((c = jr_peek(r)) > 0 && c != ',' && c != '}' && c != ']' &&
+                   c != ' ' && c != '\n' && c != '\r' && c != '\t')
+                r->pos++;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+/**
+ * jr_next_member - Advance inside an object or array
+ *
+ * Time Complexity: O(w)
+ * Space Complexity: O(1)
+ *
+ * Returns 1 if another member follows, 0 at the closing bracket and
+ * -1 on a syntax error. first is true right after the opening bracket.
+ *
+ * Overall: O(w)
+ */
+static int jr_next_member(JsonReader *r, bool first, int close)
+{
+    int c = jr_skip_ws(r);
+    if (c == close)
+    {
+        r->pos++;
+        return 0;
+    }
+    if (first)
+        return 1;
+    if (c != ',')
+        return -1;
+    r->pos++;
+    return 1;
+}
+
+/**
+ * parse_student_object - Parse one student object and bulk-insert it
+ *
+ * Time Complexity: O(k + g) where k is bytes, g is grades in the record
+ * Space Complexity: O(g) - grades staged in a growable buffer
+ *
+ * Complexity Analysis:
+ * 1. Member loop - O(k): Keys in any order, unknown keys skipped
+ *    - "id": jr_number() - O(1), rejected unless an integer in int range
+ *    - "name": jr_string() - O(k)
+ *    - "grades": jr_number() per element - O(g), buffer doubles
+ *    - "average": skipped, recomputed from grades once
+ * 2. add_student_with_grades() - O(g): One insert, one allocation,
+ *    one average computation per record
+ *
+ * A record without "id" bumps *missing and one whose ID is already
+ * loaded bumps *dups; both are left out. Returns false on a syntax
+ * error.
+ *
+ * Overall: O(k + g)
+ */
+static bool parse_student_object(JsonReader *r, StudentRegistry *reg, float **grades, int *cap, int *dups,
+                                 int *missing)
+{
+    if (!jr_expect(r, '{'))
+        return false;
+    bool have_id = false;
+    int id = 0;
+    char name[NAME_LEN] = {0};
+    int count = 0;
+    char key[32];
+
+    for (bool first = true;; first = false)
+    {
+        int m = jr_next_member(r, first, '}');
+        if (m == 0)
+            break;
+        if (m < 0 || !jr_string(r, key, sizeof(key)) || !jr_expect(r, ':'))
+            return false;
+        double v;
+        if (strcmp(key, "id") == 0)
+        {
+            if (!jr_number(r, &v))
+                return false;
+            if (!(v >= INT_MIN && v <= INT_MAX) || v != (double)(int)v)
+            {
+                fprintf(stderr, "Invalid student ID %g\n", v);
+                return false;
+            }
+            id = (int)v;
+            have_id = true;
+        }
+        else if (strcmp(key, "name") == 0)
+        {
+            if (!jr_string(r, name, sizeof(name)))
+                return false;
+        }
+        else if (strcmp(key, "grades") == 0)
+        {
+            if (!jr_expect(r, '['))
+                return false;
+            count = 0;
+            for (bool gfirst = true;; gfirst = false)
+            {
+                int g = jr_next_member(r, gfirst, ']');
+                if (g == 0)
+                    break;
+                if (g < 0 || !jr_number(r, &v))
+                    return false;
+                if (count == *cap)
+                {
+                    int newcap = *cap ? *cap * 2 : 16;
+                    float *tmp = realloc(*grades, newcap * sizeof(float));
+                    if (!tmp)
+                    {
+                        fprintf(stderr, "Memory allocation failed while loading.\n");
+                        exit(EXIT_FAILURE);
+                    }
+                    *grades = tmp;
+                    *cap = newcap;
+                }
+                (*grades)[count++] = (float)v;
+            }
+        }
+        else if (!jr_skip_value(r))
+        {
+            return false;
+        }
+    }
+    if (!have_id)
+        (*missing)++;
+    else if (!registry_add_student_with_grades(reg, id, name, *grades, count))
+        (*dups)++;
+    return true;
+}
+
+/**
+ * load_json - Load students from a JSON file in a single streaming pass
+ *
+ * Time Complexity: O(B + n + G) where B is file bytes, n students, G grades
+ * Space Complexity: O(JSON_READ_SIZE + g_max) - read buffer plus the
+ *                   largest grade list of any one record
+ *
+ * Complexity Analysis:
+ * 1. fopen() + malloc(read buffer) - O(1)
+ * 2. Top-level object members - O(B):
+ *    - "journal_seq": folded journal sequence
+ *    - "count": reserve_students() once for the whole file
+ *    - "students": parse_student_object() per element; records with
+ *      duplicate or missing IDs are counted and reported once
+ *    - anything else skipped
+ * 3. Every byte is examined once; no line-length limit and no
+ *    dependence on the layout save_json() produces
+ *
+ * Overall: O(B + n + G)
+ */
+static bool load_json(const char *path, unsigned long *seq, StudentRegistry *reg)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        /* File doesn't exist yet - not an error for first run */
+        return true;
+    }
+
+    JsonReader r = {fp, malloc(JSON_READ_SIZE), 0, 0, 0};
+    if (!r.buf)
+    {
+        fclose(fp);
+        fprintf(stderr, "Memory allocation failed while loading.\n");
+        return false;
+    }
+    float *grades = NULL;
+    int grades_cap = 0, dups = 0, missing = 0;
+    bool ok = jr_expect(&r, '{');
+    char key[32];
+    for (bool first = true; ok; first = false)
+    {
+        int m = jr_next_member(&r, first, '}');
+        if (m <= 0)
+        {
+            ok = (m == 0);
+            break;
+        }
+        double v;
+        if (!jr_string(&r, key, sizeof(key)) || !jr_expect(&r, ':'))
+            ok = false;
+        else if (strcmp(key, "journal_seq") == 0)
+        {
+            ok = jr_number(&r, &v);
+            if (ok)
+                *seq = (unsigned long)v;
+        }
+        else if (strcmp(key, "count") == 0)
+        {
+            ok = jr_number(&r, &v);
+            if (ok && v > 0 && v < 2147483647.0)
+                registry_reserve_students(reg, (int)v);
+        }
+        else if (strcmp(key, "students") == 0)
+        {
+            ok = jr_expect(&r, '[');
+            for (bool f = true; ok; f = false)
+            {
+                int e = jr_next_member(&r, f, ']');
+                if (e <= 0)
+                {
+                    ok = (e == 0);
+                    break;
+                }
+                ok = parse_student_object(&r, reg, &grades, &grades_cap, &dups, &missing);
+            }
+        }
+        else
+            ok = jr_skip_value(&r);
+    }
+    if (!ok)
+        fprintf(stderr, "%s: JSON syntax error near byte %ld\n", path, r.consumed + (long)r.pos);
+    if (dups > 0)
+        fprintf(stderr, "%s: %d duplicate ID(s) ignored\n", path, dups);
+    if (missing > 0)
+        fprintf(stderr, "%s: %d student(s) without an ID ignored\n", path, missing);
+
+    INSTR_ADD(INSTR_LOAD_BYTES, r.consumed + (long)r.pos);
+    free(grades);
+    free(r.buf);
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * release_mapping - munmap() callback for adopt_grade_mapping()
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void release_mapping(void *base, size_t size)
+{
+    munmap(base, size);
+}
+
+/**
+ * finish_mapping - Unmap a loaded snapshot, or keep it for mapped grades
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. keep: advise random access on [from, to) so first touches of grade
+ *    pages do not read ahead, then adopt_grade_mapping() - O(1)
+ * 2. Otherwise munmap() - O(1)
+ *
+ * Overall: O(1)
+ */
+static void finish_mapping(StudentRegistry *reg, void *map, size_t size, bool keep, const void *from, const void *to)
+{
+    if (!keep)
+    {
+        munmap(map, size);
+        return;
+    }
+    /* Records already added may point into the mapping, even on error */
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)from & ~(page - 1);
+    if ((uintptr_t)to > start)
+        posix_madvise((void *)start, (uintptr_t)to - start, POSIX_MADV_RANDOM);
+    registry_adopt_grade_mapping(reg, map, size, release_mapping);
+}
+
+/**
+ * get_varint - Read one unsigned LEB128 varint
+ *
+ * Time Complexity: O(1) - at most 10 bytes
+ * Space Complexity: O(1)
+ *
+ * Returns false on a truncated or overlong varint; *p is only advanced
+ * on success.
+ *
+ * Overall: O(1)
+ */
+static bool get_varint(const unsigned char **p, const unsigned char *end, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (const unsigned char *q = *p; q < end && q - *p < 10; q++)
+    {
+        v |= (uint64_t)(*q & 0x7f) << (7 * (q - *p));
+        if (!(*q & 0x80))
+        {
+            *p = q + 1;
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * load_binary_packed - Load students from a mapped version 4 snapshot
+ *
+ * Time Complexity: O(n + G + N); O(n + N) with lazy grades in a
+ *                  quantized build
+ * Space Complexity: O(n + G) for the registry, plus one grade run of
+ *                   floats in a float build
+ *
+ * Complexity Analysis:
+ * 1. Validate offsets and the grade region size - O(1)
+ * 2. reserve_students() - O(n)
+ * 3. get_varint() each record's fields, bounds-checked against the
+ *    record stream, undo the zigzag ID delta - O(n + N)
+ * 4. Grades, taken in record order:
+ *    - quantized, lazy: add_student_with_mapped_grades() - O(1) with
+ *      the average from the stored sum
+ *    - quantized: add_student_with_grade_values() - O(g) memcpy
+ *    - float build: widen the run into a scratch buffer and
+ *      add_student_with_grades() - O(g)
+ * 5. finish_mapping() - O(1)
+ *
+ * Takes ownership of map. df stays reset: packed files are never
+ * patched in place.
+ *
+ * Overall: O(n + G + N)
+ */
+static bool load_binary_packed(const char *path, unsigned long *seq, StudentRegistry *reg, void *map, size_t size,
+                               const SnapshotHeader *h)
+{
+    const unsigned char *base = map;
+    bool ok = h->students_offset <= h->grades_offset && h->grades_offset <= size &&
+              h->grades_offset % SNAPSHOT_PACKED_ALIGN == 0 &&
+              h->grade_count <= (size - h->grades_offset) / sizeof(uint16_t) &&
+              h->student_count <= (uint64_t)INT_MAX;
+    if (!ok)
+    {
+        fprintf(stderr, "%s: unsupported or corrupt snapshot\n", path);
+        munmap(map, size);
+        return false;
+    }
+
+    const unsigned char *p = base + h->students_offset, *end = base + h->grades_offset;
+    const uint16_t *grades = (const uint16_t *)end;
+    uint64_t used = 0;
+    int64_t id = 0;
+#ifndef SMS_QUANTIZED_GRADES
+    float *wide = NULL;
+    uint64_t wide_cap = 0;
+#endif
+    registry_reserve_students(reg, (int)h->student_count);
+    for (uint64_t i = 0; i < h->student_count; i++)
+    {
+        uint64_t zz, count, sum, name_len;
+        ok = get_varint(&p, end, &zz) && get_varint(&p, end, &count) && get_varint(&p, end, &sum) &&
+             get_varint(&p, end, &name_len) && name_len < NAME_LEN && name_len <= (uint64_t)(end - p) &&
+             count <= h->grade_count - used;
+        if (ok)
+        {
+            id += (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+            ok = id >= INT_MIN && id <= INT_MAX;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "%s: corrupt record %llu\n", path, (unsigned long long)i);
+            break;
+        }
+        char name[NAME_LEN];
+        memcpy(name, p, name_len);
+        name[name_len] = '\0';
+        p += name_len;
+        const uint16_t *run = grades + used;
+        used += count;
+#ifdef SMS_QUANTIZED_GRADES
+        if (lazy_grades)
+            registry_add_student_with_mapped_grades(reg, (int)id, name, run, (int)count,
+                                                    count ? (float)((double)sum / ((double)count * GRADE_SCALE))
+                                                          : 0.0f);
+        else
+            registry_add_student_with_grade_values(reg, (int)id, name, run, (int)count);
+#else
+        if (count > wide_cap)
+        {
+            float *grown = realloc(wide, count * sizeof(float));
+            if (!grown)
+            {
+                fprintf(stderr, "Memory allocation failed (snapshot grades).\n");
+                ok = false;
+                break;
+            }
+            wide = grown;
+            wide_cap = count;
+        }
+        for (uint64_t j = 0; j < count; j++)
+            wide[j] = (float)run[j] / GRADE_SCALE;
+        registry_add_student_with_grades(reg, (int)id, name, wide, (int)count);
+#endif
+    }
+    *seq = h->journal_seq;
+#ifdef SMS_QUANTIZED_GRADES
+    finish_mapping(reg, map, size, lazy_grades, grades, grades + h->grade_count);
+#else
+    free(wide);
+    finish_mapping(reg, map, size, false, grades, grades);
+#endif
+    return ok;
+}
+
+/**
+ * load_binary - Load students from a memory-mapped binary snapshot
+ *
+ * Time Complexity: O(n + G) where n is students, G is total grades;
+ *                  O(n) with lazy grades
+ * Space Complexity: O(n + G) for the in-memory registry; O(n) resident
+ *                   with lazy grades until grade pages are touched
+ *
+ * Complexity Analysis:
+ * 1. open() + fstat() - O(1)
+ * 2. mmap() - O(1): Pages are faulted in on first touch
+ * 3. Validate header and region bounds - O(1)
+ * 4. reserve_students() - O(n): One allocation for the whole table
+ * 5. Loop over fixed-width records - O(n):
+ *    - add_student_with_grades() - O(g): memcpy straight from the
+ *      mapped grade region, no per-field parsing
+ *    - lazy: add_student_with_mapped_grades() - O(1): Keep a pointer
+ *      into the grade region and the stored average
+ * 6. finish_mapping() - O(1): munmap(), or with lazy grades hand the
+ *    mapping to adopt_grade_mapping()
+ *
+ * Version 4 files go to load_binary_packed(). A quantized build
+ * converts the float grades of older versions and never maps them.
+ *
+ * Overall: O(n + G), O(n) with lazy grades
+ */
+static bool load_binary(const char *path, unsigned long *seq, StudentRegistry *reg, DiskFile *df)
+{
+    if (df)
+        disk_file_reset(df);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return true; /* not an error on first run */
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SNAPSHOT_V1_HEADER_SIZE)
+    {
+        fprintf(stderr, "%s: not a valid snapshot\n", path);
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    INSTR_ADD(INSTR_LOAD_BYTES, size);
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping snapshot");
+        return false;
+    }
+
+    const unsigned char *base = map;
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(&h, map, SNAPSHOT_V1_HEADER_SIZE);
+    bool v1 = h.version == 1, v2 = h.version == 2;
+    size_t rec_size = v1 ? sizeof(SnapshotStudentV1) : v2 ? sizeof(SnapshotStudentV2) : sizeof(SnapshotStudent);
+    if (v1)
+    {
+        h.record_count = h.record_capacity = h.student_count;
+        h.heap_end = h.grade_count;
+    }
+    else if (size >= sizeof(h))
+        memcpy(&h, map, sizeof(h));
+    if (memcmp(h.magic, SNAPSHOT_MAGIC, 4) == 0 && h.version == SNAPSHOT_VERSION_PACKED && size >= sizeof(h))
+        return load_binary_packed(path, seq, reg, map, size, &h);
+    /* Grades past the end of the file belong to runs whose slack was
+     * never written; only each record's grade_count must be present */
+    uint64_t heap_avail = h.grades_offset <= size ? (size - h.grades_offset) / sizeof(float) : 0;
+    bool ok = memcmp(h.magic, SNAPSHOT_MAGIC, 4) == 0 &&
+              (v1 || ((v2 || h.version == SNAPSHOT_VERSION) && size >= sizeof(h))) &&
+              h.students_offset <= size &&
+              h.record_count <= h.record_capacity &&
+              h.record_count <= (size - h.students_offset) / rec_size &&
+              h.grades_offset <= size &&
+              h.grades_offset % sizeof(float) == 0;
+    if (!ok)
+    {
+        fprintf(stderr, "%s: unsupported or corrupt snapshot\n", path);
+        munmap(map, size);
+        return false;
+    }
+    if (v1)
+        df = NULL; /* rewritten as the current version on the next save */
+    else if (df && !disk_file_init(df, h.record_capacity))
+    {
+        fprintf(stderr, "Memory allocation failed (snapshot records).\n");
+        munmap(map, size);
+        return false;
+    }
+
+    const float *grades = (const float *)(base + h.grades_offset);
+    registry_reserve_students(reg, (int)h.student_count);
+    for (uint32_t i = 0; i < h.record_count; i++)
+    {
+        SnapshotStudent r;
+        char name[NAME_LEN];
+        const char *name_src = NULL;
+        const unsigned char *p = base + h.students_offset + (uint64_t)i * rec_size;
+        if (v1 || v2)
+        {
+            memset(&r, 0, sizeof(r));
+            if (v1)
+            {
+                const SnapshotStudentV1 *o = (const SnapshotStudentV1 *)p;
+                r.id = o->id;
+                r.grade_count = r.grade_cap = o->grade_count;
+                r.grade_first = o->grade_first;
+                r.average = o->average;
+                name_src = o->name;
+            }
+            else
+            {
+                const SnapshotStudentV2 *o = (const SnapshotStudentV2 *)p;
+                r.id = o->id;
+                r.grade_count = o->grade_count;
+                r.grade_first = o->grade_first;
+                r.average = o->average;
+                r.grade_cap = o->grade_cap;
+                r.seq = o->seq;
+                r.flags = o->flags;
+                name_src = o->name;
+            }
+            r.name_len = (uint32_t)strnlen(name_src, SNAPSHOT_NAME_LEN - 1);
+        }
+        else
+        {
+            memcpy(&r, p, sizeof(r));
+            name_src = (const char *)(grades + r.name_first);
+        }
+        if (df && r.seq > h.journal_seq && df->newer_len >= 0)
+            record_newer(df, r.id, r.seq);
+        if (!v1 && r.grade_first + r.grade_cap > h.heap_end)
+            h.heap_end = r.grade_first + r.grade_cap; /* patched after the header */
+        uint64_t name_units = NAME_STORED_SIZE(r.name_len) / sizeof(float);
+        if (!v1 && !v2 && r.name_len < NAME_LEN && r.name_first + name_units > h.heap_end)
+            h.heap_end = r.name_first + name_units;
+        if (r.flags & SNAPSHOT_DEAD)
+            continue;
+        if (r.grade_first > heap_avail || r.grade_count > heap_avail - r.grade_first || r.grade_count > r.grade_cap)
+        {
+            fprintf(stderr, "%s: corrupt grade run for ID %d\n", path, r.id);
+            ok = false;
+            break;
+        }
+        if (!v1 && !v2 && (r.name_len >= NAME_LEN || r.name_first > heap_avail ||
+                           r.name_len >= (heap_avail - r.name_first) * sizeof(float)))
+        {
+            fprintf(stderr, "%s: corrupt name for ID %d\n", path, r.id);
+            ok = false;
+            break;
+        }
+        memcpy(name, name_src, r.name_len);
+        name[r.name_len] = '\0';
+#ifndef SMS_QUANTIZED_GRADES
+        if (lazy_grades)
+            registry_add_student_with_mapped_grades(reg, r.id, name, grades + r.grade_first, (int)r.grade_count,
+                                                    r.average);
+        else
+#endif
+            registry_add_student_with_grades(reg, r.id, name, grades + r.grade_first, (int)r.grade_count);
+        if (df)
+        {
+            DiskSlot *b = disk_slot(df, r.id);
+            b->id = r.id;
+            b->slot = (int32_t)i;
+        }
+    }
+    *seq = h.journal_seq;
+    if (df && df->newer_len < 0)
+    {
+        fprintf(stderr, "Memory allocation failed (snapshot records).\n");
+        ok = false;
+    }
+    if (df && ok)
+    {
+        df->h = h;
+        df->valid = h.version == SNAPSHOT_WRITE_VERSION; /* patched only once rewritten in this version */
+        if (df->newer_len > 0)
+            qsort(df->newer, df->newer_len, sizeof(RecordSeq), record_seq_cmp);
+    }
+    else if (df)
+        disk_file_reset(df);
+    finish_mapping(reg, map, size, lazy_grades && SNAPSHOT_WRITE_VERSION == SNAPSHOT_VERSION, grades,
+                   grades + heap_avail);
+    return ok;
+}
+
+/**
+ * load_snapshot - Load a snapshot file, format chosen by extension
+ *
+ * Time Complexity: O(n × g) - see load_json() / load_binary()
+ * Space Complexity: O(n × g)
+ *
+ * Complexity Analysis:
+ * 1. is_binary_path() - O(k): Check for BINARY_EXTENSION
+ * 2. load_binary() or load_json() - O(n × g)
+ * 3. Count and time the load - O(1)
+ *
+ * Overall: O(n × g)
+ */
+static bool load_snapshot(const char *path, unsigned long *seq, StudentRegistry *reg, DiskFile *df)
+{
+    INSTR_INC(INSTR_LOAD);
+    INSTR_TIMER_START(t0);
+    if (df)
+        disk_file_reset(df);
+    bool ok = is_binary_path(path) ? load_binary(path, seq, reg, df) : load_json(path, seq, reg);
+    INSTR_TIMER_STOP(INSTR_T_LOAD, t0);
+    return ok;
+}
+
+/**
+ * load_students_from_path - Load a snapshot, format chosen by extension
+ *
+ * Time Complexity: O(n × g) - see load_json() / load_binary()
+ * Space Complexity: O(n × g)
+ *
+ * Does not touch the journal; use load_students_from_file() for the
+ * active data file.
+ *
+ * Overall: O(n × g)
+ */
+bool load_students_from_path(const char *path)
+{
+    unsigned long seq = 0;
+    return load_snapshot(path, &seq, default_registry(), NULL);
+}
+
+/**
+ * load_shard_run - Thread body: parse one shard into its own registry
+ *
+ * Time Complexity: O(n_k × g) for the shard's students
+ * Space Complexity: O(n_k × g) in the private registry
+ *
+ * Complexity Analysis:
+ * 1. load_snapshot() into job->reg - O(n_k × g): Registries share
+ *    nothing, so shards parse without locks
+ * 2. Check every ID belongs here - O(n_k): A run with another shard
+ *    count wrote the file
+ *
+ * Overall: O(n_k × g)
+ */
+static void *load_shard_run(void *arg)
+{
+    ShardJob *job = arg;
+    job->ok = load_snapshot(job->path, &job->seq, job->reg, &disk_files[job->shard]);
+    int slots = registry_student_slots(job->reg);
+    for (int i = 0; i < slots && !job->misplaced; ++i)
+    {
+        Student *s = registry_get_student_by_index(job->reg, i);
+        job->misplaced = s && shard_of(s->id) != job->shard;
+    }
+    return NULL;
+}
+
+/**
+ * load_shards - Load every shard file in parallel and merge the results
+ *
+ * Time Complexity: O(n × g / s) wall clock on s cores for the parse,
+ *                  plus O(n) to merge
+ * Space Complexity: O(n × g)
+ *
+ * Complexity Analysis:
+ * 1. Find shard files, including stale ones past shard_count - O(s)
+ * 2. None at all - load the unsharded data file instead, so switching
+ *    to shards needs no conversion step; every shard stays dirty and
+ *    the next save writes them - O(n × g)
+ * 3. run_shard_jobs(load_shard_run) - one private registry per shard
+ * 4. registry_reserve_students() for the total once, then
+ *    registry_merge() each into the default registry in shard order -
+ *    O(n): Student structs move, grades are not copied
+ * 5. Per-shard sequence and dirty state; misplaced or stale students
+ *    make every shard dirty and no file patchable, so the next save
+ *    repartitions - O(s)
+ *
+ * *seq receives the newest sequence of any shard.
+ *
+ * Overall: O(n × g / s + n)
+ */
+static bool load_shards(unsigned long *seq)
+{
+    int njobs = shard_count;
+    while (njobs < SHARD_MAX && shard_exists(njobs))
+        njobs++;
+    stale_shards = njobs - shard_count;
+    bool any = stale_shards > 0;
+    for (int k = 0; k < shard_count && !any; ++k)
+        any = shard_exists(k);
+    if (!any)
+    {
+        bool ok = load_snapshot(data_file, seq, default_registry(), &disk_files[0]);
+        disk_files[0].valid = false; /* only its replay list applies */
+        for (int k = 0; k < shard_count; ++k)
+            shard_seq[k] = *seq;
+        return ok;
+    }
+
+    ShardJob *jobs = calloc((size_t)njobs, sizeof(ShardJob));
+    bool ok = jobs != NULL;
+    bool pool = registry_grade_pool_enabled(default_registry());
+    for (int k = 0; ok && k < njobs; ++k)
+    {
+        shard_path(jobs[k].path, k);
+        jobs[k].shard = k;
+        jobs[k].reg = registry_create();
+        ok = jobs[k].reg != NULL;
+        if (ok)
+            registry_set_grade_pool_enabled(jobs[k].reg, pool);
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Memory allocation failed (shard load).\n");
+        for (int k = 0; jobs && k < njobs; ++k)
+            registry_destroy(jobs[k].reg);
+        free(jobs);
+        return false;
+    }
+    run_shard_jobs(jobs, njobs, load_shard_run);
+
+    int total = 0;
+    for (int k = 0; k < njobs; ++k)
+        total += registry_students_count(jobs[k].reg);
+    registry_reserve_students(default_registry(), total);
+
+    bool repartition = stale_shards > 0;
+    int dropped = 0;
+    *seq = 0;
+    for (int k = 0; k < njobs; ++k)
+    {
+        ok = ok && jobs[k].ok;
+        repartition = repartition || jobs[k].misplaced;
+        if (jobs[k].seq > *seq)
+            *seq = jobs[k].seq;
+        if (k < shard_count)
+        {
+            shard_seq[k] = jobs[k].seq;
+            shard_dirty[k] = !jobs[k].ok || !shard_exists(k);
+        }
+        dropped += registry_merge(default_registry(), jobs[k].reg);
+        registry_destroy(jobs[k].reg);
+    }
+    free(jobs);
+    if (dropped > 0)
+        fprintf(stderr, "%d duplicate ID(s) across shards ignored\n", dropped);
+    if (repartition)
+    {
+        /* Saved with another shard count: replay cannot tell which file
+         * a record's student came from, so use the newest sequence */
+        for (int k = 0; k < shard_count; ++k)
+        {
+            shard_seq[k] = *seq;
+            shard_dirty[k] = true;
+        }
+        for (int k = 0; k < SHARD_MAX; ++k)
+            disk_files[k].valid = false;
+    }
+    return ok;
+}
+
+/**
+ * load_students_from_file - Load the active data file and replay the journal
+ *
+ * Time Complexity: O(n × g + j) where j is journal records
+ * Space Complexity: O(n × g)
+ *
+ * Complexity Analysis:
+ * 1. load_snapshot(), or load_shards() with shard_count > 1 - O(n × g):
+ *    Restore snapshot
+ * 2. Adopt snapshot's journal sequence - O(1)
+ * 3. registry_set_dirty_tracking() - O(1): From here on every change
+ *    marks its student, so binary saves can patch the file in place
+ * 4. replay_journal() - O(j): Apply newer records
+ * 5. disk_files_forget_newer() - O(s): Per-record sequences are only
+ *    needed to filter this replay
+ *
+ * Overall: O(n × g + j)
+ */
+bool load_students_from_file(void)
+{
+    unsigned long seq = 0;
+    bool ok = shard_count > 1 ? load_shards(&seq) : load_snapshot(data_file, &seq, default_registry(), &disk_files[0]);
+    if (!ok)
+        return false;
+    snapshot_seq = journal_seq = seq;
+    registry_set_dirty_tracking(default_registry(), true);
+    ok = replay_journal();
+    disk_files_forget_newer();
+    return ok;
+}
+
+/**
+ * open_journal - Lazily open the journal for appending
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - one FILE handle
+ *
+ * Complexity Analysis:
+ * 1. Check cached handle - O(1)
+ * 2. fopen() in append mode - O(1): Only on first use
+ *
+ * Overall: O(1)
+ */
+static bool open_journal(void)
+{
+    if (!journal_fp)
+        journal_fp = fopen(journal_file, "a");
+    return journal_fp != NULL;
+}
+
+/**
+ * journal_append - Append one operation record to the journal
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1) - writes directly to file
+ *
+ * Complexity Analysis:
+ * 1. open_journal() - O(1)
+ * 2. fprintf() record - O(k): k bounded by NAME_LEN
+ *    Format: "<seq> <op> <id>[ <arg>]\n"
+ * 3. fflush() - O(1): Hand the record to the OS immediately
+ * 4. Compaction check - O(1), O(n) when triggered:
+ *    Triggered after max(JOURNAL_COMPACT_THRESHOLD, n) records,
+ *    so the full rewrite is amortized O(1) per record
+ *    - With background saves: after save_every records or once the
+ *      oldest is save_delay_ms old; start_background_save() copies the
+ *      registry in O(n + G) and the rewrite leaves this thread. While a
+ *      save runs, records pile up for the next one (group commit). The
+ *      first pending record also arms the writer's timer, so an idle
+ *      burst is saved after save_delay_ms without a further append.
+ *
+ * If the journal cannot be written the whole snapshot is saved
+ * instead, so the edit is never lost.
+ *
+ * Overall: O(1) amortized
+ */
+static bool journal_append(char op, int id, const char *arg)
+{
+    if (!open_journal())
+        return save_students_to_file();
+
+    INSTR_INC(INSTR_JOURNAL_APPEND);
+    INSTR_TIMER_START(t0);
+    unsigned long seq = journal_seq + 1;
+    int written;
+    if (arg)
+        written = fprintf(journal_fp, "%lu %c %d %s\n", seq, op, id, arg);
+    else
+        written = fprintf(journal_fp, "%lu %c %d\n", seq, op, id);
+    if (written < 0 || fflush(journal_fp) != 0 || ferror(journal_fp))
+    {
+        perror("Error writing journal");
+        close_journal();
+        return save_students_to_file();
+    }
+    INSTR_ADD(INSTR_JOURNAL_BYTES, written);
+    INSTR_TIMER_STOP(INSTR_T_JOURNAL, t0);
+    journal_seq = seq;
+
+    unsigned long pending = journal_seq - snapshot_seq;
+    unsigned long limit = JOURNAL_COMPACT_THRESHOLD;
+    if ((unsigned long)students_count() > limit)
+        limit = (unsigned long)students_count();
+    if (!background_save)
+        return pending >= limit ? compact_journal() : true;
+
+    bool due = pending >= (save_every > 0 ? save_every : limit);
+    if (save_delay_ms > 0)
+        start_writer(); /* to wake it when the oldest record is due */
+    pthread_mutex_lock(&writer_lock);
+    reap_background_save();
+    bool busy = writer_state == WRITER_BUSY;
+    if (save_delay_ms > 0)
+    {
+        long long now = monotonic_ms();
+        if (first_pending_ms == 0)
+        {
+            first_pending_ms = now;
+            pthread_cond_broadcast(&writer_cond);
+        }
+        due = due || now - first_pending_ms >= save_delay_ms;
+    }
+    pthread_mutex_unlock(&writer_lock);
+    if (!due || busy || (start_writer() && start_background_save()))
+        return true;
+    return compact_journal();
+}
+
+/**
+ * journal_add_student - Record an "add student" operation
+ *
+ * Time Complexity: O(1) amortized - see journal_append()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+bool journal_add_student(int id, const char *name)
+{
+    return journal_append('A', id, name);
+}
+
+/**
+ * journal_add_grade - Record an "add grade" operation
+ *
+ * Time Complexity: O(1) amortized - see journal_append()
+ * Space Complexity: O(1) - fixed formatting buffer
+ *
+ * Complexity Analysis:
+ * 1. snprintf() grade - O(1): %.9g round-trips a float exactly
+ * 2. journal_append() - O(1) amortized
+ *
+ * Overall: O(1) amortized
+ */
+bool journal_add_grade(int id, float grade)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", grade);
+    return journal_append('G', id, buf);
+}
+
+/**
+ * journal_rename_student - Record a "rename student" operation
+ *
+ * Time Complexity: O(1) amortized - see journal_append()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+bool journal_rename_student(int id, const char *name)
+{
+    return journal_append('R', id, name);
+}
+
+/**
+ * journal_delete_student - Record a "delete student" operation
+ *
+ * Time Complexity: O(1) amortized - see journal_append()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+bool journal_delete_student(int id)
+{
+    return journal_append('D', id, NULL);
+}
+
+/**
+ * replay_file - Apply the records of one journal file newer than the snapshot
+ *
+ * Time Complexity: O(j) expected where j is number of journal records
+ * Space Complexity: O(1) - fixed line buffer
+ *
+ * Complexity Analysis:
+ * 1. fopen() - O(1): Missing file means nothing to replay
+ * 2. While loop - O(j): One line per record
+ * 3. For each record:
+ *    - strtoul()/strtol() - O(1): Parse sequence and ID
+ *    - Skip if seq <= snapshot_seq - O(1): Already in snapshot; when
+ *      sharded, compare with the sequence of the ID's shard instead,
+ *      since shards that did not change keep older files
+ *    - Advance journal_seq, then skip if seq <= newer_seq() - O(1)
+ *      normally: The ID's record was patched in place by a save that
+ *      crashed before its header
+ *    - Apply via student API - O(1) expected (hash index lookups)
+ * 4. A line without '\n' is a torn final write and is ignored
+ *
+ * Returns the number of records applied.
+ *
+ * Overall: O(j)
+ */
+static int replay_file(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return 0;
+
+    char line[512];
+    int applied = 0;
+    while (fgets(line, sizeof(line), fp))
+    {
+        size_t len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n')
+            break; /* torn record at end of file */
+        line[len - 1] = '\0';
+
+        char *p;
+        unsigned long seq = strtoul(line, &p, 10);
+        if (p == line || *p != ' ')
+            continue;
+        char op = p[1];
+        if (op == '\0' || p[2] != ' ')
+            continue;
+        char *idstart = p + 3;
+        int id = (int)strtol(idstart, &p, 10);
+        if (p == idstart)
+            continue;
+        const char *arg = (*p == ' ') ? p + 1 : "";
+
+        if (seq <= (shard_count > 1 ? shard_seq[shard_of(id)] : snapshot_seq))
+            continue;
+        if (seq > journal_seq)
+            journal_seq = seq;
+        if (seq <= newer_seq(id))
+            continue;
+        switch (op)
+        {
+        case 'A':
+            add_student(id, arg);
+            break;
+        case 'G':
+            add_grade_to_student(id, strtof(arg, NULL));
+            break;
+        case 'R':
+            update_student_name(id, arg);
+            break;
+        case 'D':
+            delete_student(id);
+            break;
+        default:
+            continue;
+        }
+        applied++;
+    }
+    fclose(fp);
+    return applied;
+}
+
+/**
+ * replay_journal - Apply journal records newer than the loaded snapshot
+ *
+ * Time Complexity: O(j) expected where j is number of journal records
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. replay_file(journal_old_file) - O(j_old): Records moved aside for
+ *    a background save that had not finished; they are older than
+ *    everything in the journal
+ * 2. replay_file(journal_file) - O(j)
+ * 3. compact_journal() - O(n): Only if records were applied, folds
+ *    them into a fresh snapshot and drops any torn tail
+ *
+ * Overall: O(j + n) when records were replayed, O(j) otherwise
+ */
+bool replay_journal(void)
+{
+    int applied = replay_file(journal_old_file);
+    applied += replay_file(journal_file);
+    if (applied > 0)
+        return compact_journal();
+    return true;
+}
+
+/**
+ * compact_journal - Fold the journal into a fresh snapshot
+ *
+ * Time Complexity: O(n × g) - same as save_students_to_file()
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. save_students_to_file() - O(n × g): Waits for a background save,
+ *    then writes a snapshot recording journal_seq
+ * 2. close_journal() - O(1)
+ * 3. fopen(journal_file, "w") - O(1): Truncate the journal, and
+ *    remove journal_old_file left by a failed background save
+ *
+ * The snapshot is written before the journal is truncated; a crash in
+ * between leaves records the next replay skips by sequence number.
+ *
+ * Overall: O(n × g)
+ */
+bool compact_journal(void)
+{
+    if (!save_students_to_file())
+        return false;
+    close_journal();
+    FILE *fp = fopen(journal_file, "w");
+    if (!fp)
+    {
+        perror("Error truncating journal");
+        return false;
+    }
+    fclose(fp);
+    remove(journal_old_file);
+    return true;
+}
+
+/**
+ * close_journal - Close the journal handle if it is open
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void close_journal(void)
+{
+    if (journal_fp)
+    {
+        fclose(journal_fp);
+        journal_fp = NULL;
     }
-
-    fclose(fp);
-    return true;
 }
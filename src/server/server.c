@@ -0,0 +1,1181 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "student.h"
+#include "persistence.h"
+#include "stats.h"
+#include "outbuf.h"
+#include "instrument.h"
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* Readiness events taken per epoll_wait() call */
+#define SERVER_EVENTS 64
+
+/* Bytes read from a socket per readiness event */
+#define SERVER_READ_CHUNK 16384
+
+/* One client. Requests are answered in order into out; a connection is
+ * only ever touched by the event loop that accepted it. */
+typedef struct Conn
+{
+    int fd;
+    uint32_t events;  /* interest currently registered with epoll */
+    char *in;         /* received bytes not yet consumed as lines */
+    size_t in_len;
+    size_t in_cap;
+    OutBuf out;       /* memory mode: replies waiting to be sent */
+    size_t out_sent;  /* bytes of out already written to the socket */
+    bool eof;         /* peer closed its side; finish what was sent */
+    bool quit;        /* "quit" or a protocol error: close once drained */
+    struct Conn *prev;
+    struct Conn *next;
+} Conn;
+
+typedef struct
+{
+    int epfd;
+    pthread_t thread;
+    Conn *conns; /* every open connection, freed on shutdown */
+} Worker;
+
+/* Queries share the registry; changes and compaction take it alone */
+static pthread_rwlock_t registry_lock;
+
+static int listen_fd = -1;
+static bool listen_tcp;
+static char unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+/* Written once by the signal handler; every loop polls the read end */
+static int stop_pipe[2] = {-1, -1};
+
+/* epoll_event.data tags for the two non-connection descriptors */
+static char listen_tag, stop_tag;
+
+/**
+ * skip_space - Advance past blanks
+ *
+ * Time Complexity: O(k) where k is blanks skipped
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k)
+ */
+static char *skip_space(char *p)
+{
+    while (isspace((unsigned char)*p))
+        p++;
+    return p;
+}
+
+/**
+ * parse_id - Parse a non-negative integer argument
+ *
+ * Time Complexity: O(k) where k is token length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. strtol() - O(k)
+ * 2. Range and terminator check - O(1): Must be followed by a blank
+ *    or end of line
+ *
+ * Overall: O(k)
+ */
+static bool parse_id(char **p, int *id)
+{
+    char *end;
+    long v = strtol(*p, &end, 10);
+    if (end == *p || v < 0 || v > 0x7fffffffL || (*end && !isspace((unsigned char)*end)))
+        return false;
+    *id = (int)v;
+    *p = skip_space(end);
+    return true;
+}
+
+/**
+ * parse_name - Take the rest of the line as a name
+ *
+ * Time Complexity: O(k) where k is remaining length
+ * Space Complexity: O(1) - trims in place
+ *
+ * Overall: O(k)
+ */
+static bool parse_name(char *p)
+{
+    size_t n = strlen(p);
+    while (n > 0 && isspace((unsigned char)p[n - 1]))
+        p[--n] = '\0';
+    return n > 0;
+}
+
+/**
+ * lock_for_read - Take the registry for a query
+ *
+ * Time Complexity: O(1) when the registry is prepared; otherwise one
+ *                  prepare_student_reads() - O(n log n) worst case
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Shared lock - O(1)
+ * 2. prepared and student_reads_ready() false - trade it for the
+ *    exclusive lock and prepare_student_reads(); the query then runs
+ *    under that lock, so a stream of writers cannot starve it
+ *
+ * Queries that need neither compacted slots nor the name index (ID
+ * lookups, counts) pass prepared = false and never write. Release with
+ * pthread_rwlock_unlock() either way.
+ *
+ * Overall: O(1) amortized over the changes that invalidated it
+ */
+static void lock_for_read(bool prepared)
+{
+    pthread_rwlock_rdlock(&registry_lock);
+    if (!prepared || student_reads_ready())
+        return;
+    pthread_rwlock_unlock(&registry_lock);
+    pthread_rwlock_wrlock(&registry_lock);
+    journal_lock(); /* reorders slots a timed background save may copy */
+    prepare_student_reads();
+    journal_unlock();
+}
+
+/**
+ * lock_for_change - Take the registry and the journal for a change
+ *
+ * Time Complexity: O(1) plus lock waits
+ * Space Complexity: O(1)
+ *
+ * exclusive takes the write lock, otherwise the shared one (saves).
+ * journal_lock() comes second, as persistence.h asks, and keeps a timed
+ * background save from copying the registry mid-change. Release with
+ * unlock_change().
+ *
+ * Overall: O(1)
+ */
+static void lock_for_change(bool exclusive)
+{
+    if (exclusive)
+        pthread_rwlock_wrlock(&registry_lock);
+    else
+        pthread_rwlock_rdlock(&registry_lock);
+    journal_lock();
+}
+
+/**
+ * unlock_change - Release lock_for_change()
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void unlock_change(void)
+{
+    journal_unlock();
+    pthread_rwlock_unlock(&registry_lock);
+}
+
+/**
+ * reply_err - Append an error reply
+ *
+ * Time Complexity: O(k) where k is message length
+ * Space Complexity: O(1) amortized
+ *
+ * Overall: O(k)
+ */
+static void reply_err(OutBuf *b, const char *msg)
+{
+    ob_puts(b, "ERR ");
+    ob_puts(b, msg);
+    ob_putc(b, '\n');
+}
+
+/**
+ * reply_usage - Append a usage error for a recognised command
+ *
+ * Time Complexity: O(k) where k is message length
+ * Space Complexity: O(1) amortized
+ *
+ * Returns true so command handlers can report the command as handled.
+ *
+ * Overall: O(k)
+ */
+static bool reply_usage(OutBuf *b, const char *msg)
+{
+    reply_err(b, msg);
+    return true;
+}
+
+/**
+ * reply_count - Append the "OK <n>" header of a multi-line reply
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1) amortized
+ *
+ * Overall: O(1)
+ */
+static void reply_count(OutBuf *b, long long n)
+{
+    ob_puts(b, "OK ");
+    ob_int(b, n);
+    ob_putc(b, '\n');
+}
+
+/**
+ * reply_student - Append one "id<TAB>name<TAB>average<TAB>#grades" row
+ *
+ * Time Complexity: O(k) where k is name length
+ * Space Complexity: O(1) amortized
+ *
+ * Overall: O(k)
+ */
+static void reply_student(OutBuf *b, const Student *s)
+{
+    ob_int(b, s->id);
+    ob_putc(b, '\t');
+    ob_puts(b, student_name(s));
+    ob_putc(b, '\t');
+    ob_fixed2(b, s->average);
+    ob_putc(b, '\t');
+    ob_int(b, s->gradeCount);
+    ob_putc(b, '\n');
+}
+
+/**
+ * reply_slots - Append a counted list of students given by slot
+ *
+ * Time Complexity: O(k) where k is rows
+ * Space Complexity: O(1) amortized
+ *
+ * Overall: O(k)
+ */
+static void reply_slots(OutBuf *b, const int *slots, int k)
+{
+    reply_count(b, k);
+    for (int i = 0; i < k; ++i)
+        reply_student(b, get_student_by_index(slots[i]));
+}
+
+/**
+ * reply_metrics - Append the instrumentation dump as a counted reply
+ *
+ * Time Complexity: O(c + B) - see instr_dump()
+ * Space Complexity: O(c + B) for the formatted text
+ *
+ * Complexity Analysis:
+ * 1. instr_dump() into an open_memstream() buffer - O(c + B)
+ * 2. Count its lines, append header and text - O(text)
+ *
+ * Overall: O(c + B)
+ */
+static void reply_metrics(OutBuf *b)
+{
+    char *text = NULL;
+    size_t len = 0;
+    FILE *mem = open_memstream(&text, &len);
+    if (!mem)
+    {
+        reply_err(b, "out of memory");
+        return;
+    }
+    instr_dump(mem);
+    fclose(mem);
+    long long lines = 0;
+    for (size_t i = 0; i < len; ++i)
+        lines += text[i] == '\n';
+    reply_count(b, lines);
+    ob_write(b, text, len);
+    free(text);
+}
+
+/**
+ * reply_stats - Append the class summary as one key=value line
+ *
+ * Time Complexity: O(n) - one class_stats() pass
+ * Space Complexity: O(1)
+ *
+ * Runs under the lock taken by the caller; highest/lowest are reported
+ * by ID since slots mean nothing to a client.
+ *
+ * Overall: O(n)
+ */
+static void reply_stats(OutBuf *b)
+{
+    ClassStats st;
+    if (!class_stats(STATS_PASS_MARK, &st))
+    {
+        reply_err(b, "no students");
+        return;
+    }
+    ob_puts(b, "OK count=");
+    ob_int(b, st.count);
+    ob_puts(b, " ungraded=");
+    ob_int(b, st.ungraded);
+    ob_puts(b, " grades=");
+    ob_int(b, st.totalGrades);
+    ob_puts(b, " mean=");
+    ob_fixed2(b, st.mean);
+    ob_puts(b, " variance=");
+    ob_fixed2(b, st.variance);
+    ob_puts(b, " highest=");
+    ob_int(b, get_student_by_index(st.highestIdx)->id);
+    ob_putc(b, ':');
+    ob_fixed2(b, st.highest);
+    ob_puts(b, " lowest=");
+    ob_int(b, get_student_by_index(st.lowestIdx)->id);
+    ob_putc(b, ':');
+    ob_fixed2(b, st.lowest);
+    ob_puts(b, " pass=");
+    ob_int(b, st.atOrAbove);
+    ob_putc(b, '\n');
+}
+
+/**
+ * handle_query - Answer a read-only command under the shared lock
+ *
+ * Time Complexity: O(1) expected for find/grades/count, O(n) for stats
+ *                  and percentiles, O(n log k) for top/bottom,
+ *                  O(log n + k) for name and O(k) for list
+ * Space Complexity: O(k) rows, O(n) scratch for percentiles
+ *
+ * Complexity Analysis:
+ * 1. find <id> / grades <id> / count - lock_for_read(false): the ID
+ *    index and counts never need preparing
+ * 2. stats, top <k>, bottom <k>, median, pct <p>, list <first> <count>,
+ *    name <prefix> - lock_for_read(true): compacted slots and a built
+ *    name index, so the query itself only reads
+ * 3. Format the reply while the lock is held - O(k): Student pointers
+ *    are only valid until the next change
+ *
+ * Returns false if cmd is not a query.
+ *
+ * Overall: one query, concurrent with every other query
+ */
+static bool handle_query(OutBuf *b, const char *cmd, size_t cmdlen, char *p)
+{
+    int id = 0, k = 0;
+    if (cmdlen == 4 && strncmp(cmd, "find", 4) == 0)
+    {
+        if (!parse_id(&p, &id) || *p)
+            return reply_usage(b, "usage: find <id>");
+        lock_for_read(false);
+        int idx = find_student_index(id);
+        if (idx == -1)
+            reply_err(b, "not found");
+        else
+        {
+            ob_puts(b, "OK ");
+            reply_student(b, get_student_by_index(idx));
+        }
+    }
+    else if (cmdlen == 6 && strncmp(cmd, "grades", 6) == 0)
+    {
+        if (!parse_id(&p, &id) || *p)
+            return reply_usage(b, "usage: grades <id>");
+        lock_for_read(false);
+        int idx = find_student_index(id);
+        if (idx == -1)
+            reply_err(b, "not found");
+        else
+        {
+            const Student *s = get_student_by_index(idx);
+            ob_puts(b, "OK ");
+            ob_int(b, s->gradeCount);
+            for (int i = 0; i < s->gradeCount; ++i)
+            {
+                ob_putc(b, ' ');
+                ob_fixed2(b, student_grade(s, i));
+            }
+            ob_putc(b, '\n');
+        }
+    }
+    else if (cmdlen == 5 && strncmp(cmd, "count", 5) == 0)
+    {
+        lock_for_read(false);
+        reply_count(b, students_count());
+    }
+    else if (cmdlen == 5 && strncmp(cmd, "stats", 5) == 0)
+    {
+        lock_for_read(true);
+        reply_stats(b);
+    }
+    else if ((cmdlen == 3 && strncmp(cmd, "top", 3) == 0) || (cmdlen == 6 && strncmp(cmd, "bottom", 6) == 0))
+    {
+        if (!parse_id(&p, &k) || *p)
+            return reply_usage(b, "usage: top|bottom <k>");
+        if (k > SERVER_LIST_MAX)
+            k = SERVER_LIST_MAX;
+        int slots[SERVER_LIST_MAX];
+        lock_for_read(true);
+        k = cmd[0] == 't' ? top_k_by_average(k, slots) : bottom_k_by_average(k, slots);
+        reply_slots(b, slots, k);
+    }
+    else if ((cmdlen == 6 && strncmp(cmd, "median", 6) == 0) || (cmdlen == 3 && strncmp(cmd, "pct", 3) == 0))
+    {
+        float pct = 50.0f, v;
+        if (cmd[0] == 'p')
+        {
+            char *end;
+            pct = strtof(p, &end);
+            if (end == p || *skip_space(end) || pct < 0.0f || pct > 100.0f)
+                return reply_usage(b, "usage: pct <0-100>");
+        }
+        else if (*p)
+            return reply_usage(b, "usage: median");
+        lock_for_read(true);
+        if (!average_percentile(pct, &v))
+            reply_err(b, "no students");
+        else
+        {
+            ob_puts(b, "OK ");
+            ob_fixed2(b, v);
+            ob_putc(b, '\n');
+        }
+    }
+    else if (cmdlen == 4 && strncmp(cmd, "list", 4) == 0)
+    {
+        int first = 0;
+        if (!parse_id(&p, &first) || !parse_id(&p, &k) || *p)
+            return reply_usage(b, "usage: list <first> <count>");
+        if (k > SERVER_LIST_MAX)
+            k = SERVER_LIST_MAX;
+        lock_for_read(true);
+        int n = students_count();
+        if (first > n)
+            first = n;
+        if (k > n - first)
+            k = n - first;
+        reply_count(b, k);
+        for (int i = first; i < first + k; ++i)
+            reply_student(b, get_student_by_index(i));
+    }
+    else if (cmdlen == 4 && strncmp(cmd, "name", 4) == 0)
+    {
+        parse_name(p);
+        int ids[SERVER_LIST_MAX];
+        lock_for_read(true);
+        k = search_by_name_prefix(p, ids, SERVER_LIST_MAX);
+        reply_count(b, k);
+        for (int i = 0; i < k; ++i)
+            reply_student(b, get_student_by_index(find_student_index(ids[i])));
+    }
+    else
+        return false;
+    pthread_rwlock_unlock(&registry_lock);
+    return true;
+}
+
+/**
+ * parse_grades - Validate and collect the grades of a "grade" command
+ *
+ * Time Complexity: O(k) where k is remaining length
+ * Space Complexity: O(1) - caller's buffer
+ *
+ * The whole line is checked before anything is applied, so a bad
+ * token changes nothing. Returns the number of grades, or -1.
+ *
+ * Overall: O(k)
+ */
+static int parse_grades(char *p, float *grades, int max)
+{
+    int n = 0;
+    while (*p)
+    {
+        char *end;
+        float g = strtof(p, &end);
+        if (end == p || g < 0.0f || g > 100.0f || n == max)
+            return -1;
+        grades[n++] = g;
+        p = skip_space(end);
+    }
+    return n > 0 ? n : -1;
+}
+
+/**
+ * handle_change - Apply a mutating command under the exclusive lock
+ *
+ * Time Complexity: O(1) amortized per change plus its journal record;
+ *                  O(n × g) for save and for a journal compaction
+ * Space Complexity: O(l) for the grades of one line
+ *
+ * Complexity Analysis:
+ * 1. Parse and validate before locking - O(l)
+ * 2. add / grade / rename / del - one registry call and one
+ *    journal_*() record per change, as the interactive menu does
+ * 3. save - compact_journal() under the shared lock plus
+ *    journal_lock(): queries keep running while the snapshot is written
+ * 4. compact - shrink_students_to_fit() - O(n)
+ *
+ * Returns false if cmd is not a change.
+ *
+ * Overall: one change, serialized with every other change and query
+ */
+static bool handle_change(OutBuf *b, const char *cmd, size_t cmdlen, char *p)
+{
+    int id = 0;
+    bool found = true, logged = true;
+    if (cmdlen == 3 && strncmp(cmd, "add", 3) == 0)
+    {
+        if (!parse_id(&p, &id) || !parse_name(p))
+            return reply_usage(b, "usage: add <id> <name>");
+        lock_for_change(true);
+        if (!add_student(id, p))
+        {
+            unlock_change();
+            reply_err(b, "exists");
+            return true;
+        }
+        logged = journal_add_student(id, p);
+    }
+    else if (cmdlen == 5 && strncmp(cmd, "grade", 5) == 0)
+    {
+        float grades[SERVER_LINE_MAX / 2];
+        int n;
+        if (!parse_id(&p, &id) || (n = parse_grades(p, grades, SERVER_LINE_MAX / 2)) < 0)
+            return reply_usage(b, "usage: grade <id> <0-100> [...]");
+        lock_for_change(true);
+        found = add_grades_to_student(id, grades, n);
+        for (int i = 0; found && logged && i < n; ++i)
+            logged = journal_add_grade(id, grades[i]);
+    }
+    else if (cmdlen == 6 && strncmp(cmd, "rename", 6) == 0)
+    {
+        if (!parse_id(&p, &id) || !parse_name(p))
+            return reply_usage(b, "usage: rename <id> <name>");
+        lock_for_change(true);
+        found = update_student_name(id, p);
+        logged = !found || journal_rename_student(id, p);
+    }
+    else if (cmdlen == 3 && strncmp(cmd, "del", 3) == 0)
+    {
+        if (!parse_id(&p, &id) || *p)
+            return reply_usage(b, "usage: del <id>");
+        lock_for_change(true);
+        found = delete_student(id);
+        logged = !found || journal_delete_student(id);
+    }
+    else if (cmdlen == 7 && strncmp(cmd, "compact", 7) == 0)
+    {
+        lock_for_change(true);
+        shrink_students_to_fit();
+    }
+    else if (cmdlen == 4 && strncmp(cmd, "save", 4) == 0)
+    {
+        lock_for_change(false); /* journal_lock() also orders concurrent saves */
+        logged = compact_journal();
+    }
+    else
+        return false;
+    unlock_change();
+
+    if (!found)
+        reply_err(b, "not found");
+    else if (!logged)
+        reply_err(b, "applied but not saved");
+    else
+        ob_puts(b, "OK\n");
+    return true;
+}
+
+/**
+ * handle_request - Answer one request line
+ *
+ * Time Complexity: see handle_query() and handle_change()
+ * Space Complexity: O(reply)
+ *
+ * Complexity Analysis:
+ * 1. Split the command word - O(l)
+ * 2. handle_query(), then handle_change(), then metrics / quit
+ * 3. INSTR_LATENCY_STOP() - O(1): Parse to reply formatted, including
+ *    time spent waiting for the lock
+ *
+ * Blank lines and lines starting with '#' get no reply.
+ *
+ * Overall: one request
+ */
+static void handle_request(Conn *c, char *line)
+{
+    char *p = skip_space(line);
+    if (*p == '\0' || *p == '#')
+        return;
+    INSTR_TIMER_START(t0);
+    char *cmd = p;
+    while (*p && !isspace((unsigned char)*p))
+        p++;
+    size_t cmdlen = (size_t)(p - cmd);
+    p = skip_space(p);
+
+    if (handle_query(&c->out, cmd, cmdlen, p) || handle_change(&c->out, cmd, cmdlen, p))
+        ;
+    else if (cmdlen == 7 && strncmp(cmd, "metrics", 7) == 0)
+        reply_metrics(&c->out);
+    else if (cmdlen == 4 && strncmp(cmd, "quit", 4) == 0)
+    {
+        ob_puts(&c->out, "OK bye\n");
+        c->quit = true;
+    }
+    else
+        reply_err(&c->out, "unknown command");
+    INSTR_INC(INSTR_SERVER_REQUEST);
+    INSTR_LATENCY_STOP(t0);
+}
+
+/**
+ * conn_pending - Reply bytes not yet written to the socket
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static size_t conn_pending(const Conn *c)
+{
+    return c->out.len - c->out_sent;
+}
+
+/**
+ * conn_read - Read one chunk from the socket
+ *
+ * Time Complexity: O(r) where r is bytes read
+ * Space Complexity: O(SERVER_LINE_MAX + SERVER_READ_CHUNK) per connection
+ *
+ * Complexity Analysis:
+ * 1. Grow the input buffer to fit one more chunk - amortized O(1)
+ * 2. One read() - O(r): Level-triggered epoll reports the rest later,
+ *    so one busy client cannot monopolise its loop
+ * 3. End of stream sets eof; EAGAIN/EINTR are not errors
+ *
+ * Returns false on a socket error or allocation failure.
+ *
+ * Overall: O(r)
+ */
+static bool conn_read(Conn *c)
+{
+    if (c->in_cap - c->in_len < SERVER_READ_CHUNK)
+    {
+        size_t newcap = c->in_len + SERVER_READ_CHUNK;
+        char *tmp = realloc(c->in, newcap);
+        if (!tmp)
+            return false;
+        c->in = tmp;
+        c->in_cap = newcap;
+    }
+    ssize_t n = read(c->fd, c->in + c->in_len, c->in_cap - c->in_len);
+    if (n > 0)
+        c->in_len += (size_t)n;
+    else if (n == 0)
+        c->eof = true;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        return false;
+    return true;
+}
+
+/**
+ * conn_process - Answer the complete request lines received so far
+ *
+ * Time Complexity: O(l) per line plus its request
+ * Space Complexity: O(1) - lines are handled in place
+ *
+ * Complexity Analysis:
+ * 1. memchr() for each newline - O(l)
+ * 2. handle_request() - see there
+ * 3. Stop early once SERVER_OUT_MAX reply bytes are waiting, so a
+ *    client that pipelines requests without reading replies is held
+ *    at a bounded buffer
+ * 4. Slide the unconsumed tail to the front - O(tail)
+ * 5. A partial line longer than SERVER_LINE_MAX ends the connection
+ *
+ * Overall: O(bytes consumed)
+ */
+static void conn_process(Conn *c)
+{
+    size_t start = 0;
+    while (!c->quit && conn_pending(c) < SERVER_OUT_MAX)
+    {
+        char *line = c->in + start;
+        char *nl = memchr(line, '\n', c->in_len - start);
+        if (!nl)
+            break;
+        *nl = '\0';
+        if (nl > line && nl[-1] == '\r')
+            nl[-1] = '\0';
+        start = (size_t)(nl - c->in) + 1;
+        handle_request(c, line);
+    }
+    c->in_len -= start;
+    memmove(c->in, c->in + start, c->in_len);
+    if (!c->quit && c->in_len > SERVER_LINE_MAX && !memchr(c->in, '\n', c->in_len))
+    {
+        reply_err(&c->out, "line too long");
+        c->quit = true;
+    }
+    if (c->quit)
+        c->in_len = 0;
+}
+
+/**
+ * conn_flush - Write queued replies until done or the socket is full
+ *
+ * Time Complexity: O(w) where w is bytes written
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. send() with MSG_NOSIGNAL until EAGAIN - O(w): A closed peer is an
+ *    error return, not SIGPIPE
+ * 2. Fully drained - O(1): Rewind the buffer for reuse
+ *
+ * Returns false on a socket error or a failed reply allocation.
+ *
+ * Overall: O(w)
+ */
+static bool conn_flush(Conn *c)
+{
+    if (c->out.failed)
+        return false;
+    while (conn_pending(c) > 0)
+    {
+        ssize_t n = send(c->fd, c->out.data + c->out_sent, conn_pending(c), MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->out_sent += (size_t)n;
+        INSTR_ADD(INSTR_SERVER_BYTES, n);
+    }
+    c->out.len = c->out_sent = 0;
+    return true;
+}
+
+/**
+ * conn_close - Unregister, close and free a connection
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void conn_close(Worker *w, Conn *c)
+{
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    if (c->prev)
+        c->prev->next = c->next;
+    else
+        w->conns = c->next;
+    if (c->next)
+        c->next->prev = c->prev;
+    free(c->in);
+    free(c->out.data);
+    free(c);
+}
+
+/**
+ * conn_service - React to readiness on one connection
+ *
+ * Time Complexity: O(bytes read + bytes written + requests answered)
+ * Space Complexity: O(1) beyond the connection buffers
+ *
+ * Complexity Analysis:
+ * 1. conn_read() when readable - O(r)
+ * 2. Alternate conn_process() and conn_flush() while the socket takes
+ *    everything and complete lines remain - requests answered
+ * 3. Close when there is an error, or nothing left to send after quit
+ *    or end of stream - O(1)
+ * 4. Otherwise re-arm: EPOLLOUT while replies wait, EPOLLIN unless the
+ *    connection is finishing or its reply buffer is full - one
+ *    epoll_ctl() only when the interest changes
+ *
+ * Overall: O(work done for this client)
+ */
+static void conn_service(Worker *w, Conn *c, uint32_t ev)
+{
+    bool ok = !(ev & EPOLLERR);
+    if (ok && (ev & (EPOLLIN | EPOLLHUP)))
+        ok = conn_read(c);
+    while (ok && !c->quit)
+    {
+        conn_process(c);
+        ok = conn_flush(c);
+        if (!ok || conn_pending(c) > 0 || !memchr(c->in, '\n', c->in_len))
+            break;
+    }
+    if (ok && c->quit)
+        ok = conn_flush(c);
+    if (!ok || (conn_pending(c) == 0 && (c->quit || c->eof)))
+    {
+        conn_close(w, c);
+        return;
+    }
+
+    uint32_t want = conn_pending(c) > 0 ? EPOLLOUT : 0;
+    if (!c->quit && !c->eof && conn_pending(c) < SERVER_OUT_MAX)
+        want |= EPOLLIN;
+    if (want != c->events)
+    {
+        struct epoll_event e = {.events = want, .data.ptr = c};
+        epoll_ctl(w->epfd, EPOLL_CTL_MOD, c->fd, &e);
+        c->events = want;
+    }
+}
+
+/**
+ * accept_all - Take every pending connection off the listener
+ *
+ * Time Complexity: O(a) where a is connections accepted
+ * Space Complexity: O(1) per connection until it sends data
+ *
+ * Complexity Analysis:
+ * 1. accept4() non-blocking until EAGAIN - O(a): Another loop woken
+ *    for the same connection just sees EAGAIN
+ * 2. TCP_NODELAY on TCP sockets - replies are already batched per read
+ * 3. Register for EPOLLIN and link into w->conns - O(1)
+ *
+ * Overall: O(a)
+ */
+static void accept_all(Worker *w)
+{
+    for (;;)
+    {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept");
+            return;
+        }
+        if (listen_tcp)
+        {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        Conn *c = calloc(1, sizeof(Conn));
+        if (!c)
+        {
+            fprintf(stderr, "Memory allocation failed (connection).\n");
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+        ob_init(&c->out, NULL);
+        struct epoll_event e = {.events = EPOLLIN, .data.ptr = c};
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &e) != 0)
+        {
+            perror("epoll_ctl");
+            close(fd);
+            free(c);
+            continue;
+        }
+        c->next = w->conns;
+        if (w->conns)
+            w->conns->prev = c;
+        w->conns = c;
+        INSTR_INC(INSTR_SERVER_CONN);
+    }
+}
+
+/**
+ * worker_run - One event loop thread
+ *
+ * Time Complexity: O(events) for the life of the server
+ * Space Complexity: O(connections) owned by this loop
+ *
+ * Complexity Analysis:
+ * 1. epoll_wait() for up to SERVER_EVENTS descriptors - the listener
+ *    is shared with EPOLLEXCLUSIVE so a new connection wakes one loop
+ * 2. Listener - accept_all(); stop pipe - leave the loop; anything
+ *    else - conn_service()
+ * 3. On exit close every connection still open - O(c)
+ *
+ * Overall: O(events)
+ */
+static void *worker_run(void *arg)
+{
+    Worker *w = arg;
+    struct epoll_event evs[SERVER_EVENTS];
+    bool stop = false;
+    while (!stop)
+    {
+        int n = epoll_wait(w->epfd, evs, SERVER_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            if (evs[i].data.ptr == &stop_tag)
+                stop = true;
+            else if (evs[i].data.ptr == &listen_tag)
+                accept_all(w);
+            else
+                conn_service(w, evs[i].data.ptr, evs[i].events);
+        }
+    }
+    while (w->conns)
+        conn_close(w, w->conns);
+    return NULL;
+}
+
+/**
+ * on_stop_signal - SIGINT/SIGTERM handler: wake every event loop
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Only write() is used, which is async-signal-safe. The byte is never
+ * read, so the level-triggered stop pipe stays readable for all loops.
+ *
+ * Overall: O(1)
+ */
+static void on_stop_signal(int sig)
+{
+    (void)sig;
+    int saved = errno;
+    if (write(stop_pipe[1], "x", 1) < 0)
+    {
+        /* the pipe already holds a byte - every loop is waking anyway */
+    }
+    errno = saved;
+}
+
+/**
+ * open_listener - Bind and listen on a TCP or unix socket endpoint
+ *
+ * Time Complexity: O(k) where k is endpoint length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Classify - O(k): Decimal digits after the last ':' (or the whole
+ *    string) and no '/' make it TCP; anything else is a unix path
+ * 2. TCP - inet_pton() on the address part (127.0.0.1 when absent),
+ *    SO_REUSEADDR, bind(), listen()
+ * 3. Unix - replace a stale socket file left by an earlier run, but
+ *    never any other kind of file; bind(), listen()
+ *
+ * Returns the non-blocking listening descriptor, or -1.
+ *
+ * Overall: O(k)
+ */
+static int open_listener(const char *endpoint)
+{
+    const char *colon = strrchr(endpoint, ':');
+    const char *port = colon ? colon + 1 : endpoint;
+    listen_tcp = *port && strspn(port, "0123456789") == strlen(port) && !strchr(endpoint, '/');
+    int fd;
+    if (listen_tcp)
+    {
+        struct sockaddr_in addr = {.sin_family = AF_INET};
+        char host[INET_ADDRSTRLEN] = "127.0.0.1";
+        long portnum = strtol(port, NULL, 10);
+        if (colon && ((size_t)(colon - endpoint) >= sizeof(host)))
+        {
+            fprintf(stderr, "Bad address in %s\n", endpoint);
+            return -1;
+        }
+        if (colon)
+        {
+            memcpy(host, endpoint, (size_t)(colon - endpoint));
+            host[colon - endpoint] = '\0';
+        }
+        if (portnum < 1 || portnum > 65535 || inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+        {
+            fprintf(stderr, "Bad TCP endpoint %s (expected PORT or ADDR:PORT)\n", endpoint);
+            return -1;
+        }
+        addr.sin_port = htons((uint16_t)portnum);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            perror("socket");
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            perror(endpoint);
+            close(fd);
+            return -1;
+        }
+    }
+    else
+    {
+        struct sockaddr_un addr = {.sun_family = AF_UNIX};
+        if (strlen(endpoint) >= sizeof(addr.sun_path))
+        {
+            fprintf(stderr, "Socket path too long: %s\n", endpoint);
+            return -1;
+        }
+        strcpy(addr.sun_path, endpoint);
+        struct stat st;
+        if (lstat(endpoint, &st) == 0)
+        {
+            if (!S_ISSOCK(st.st_mode))
+            {
+                fprintf(stderr, "%s exists and is not a socket\n", endpoint);
+                return -1;
+            }
+            unlink(endpoint);
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            perror("socket");
+            return -1;
+        }
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            perror(endpoint);
+            close(fd);
+            return -1;
+        }
+        strcpy(unix_path, endpoint);
+    }
+    if (listen(fd, SOMAXCONN) != 0)
+    {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * init_registry_lock - Create the registry lock, preferring writers
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * glibc's default rwlock lets a steady stream of queries hold off a
+ * change forever; the writer-preferring kind queues new readers behind
+ * a waiting writer instead.
+ *
+ * Overall: O(1)
+ */
+static void init_registry_lock(void)
+{
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&registry_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+}
+
+/**
+ * run_server - Serve the loaded registry until SIGINT or SIGTERM
+ *
+ * Time Complexity: O(n log n) to prepare, then O(requests)
+ * Space Complexity: O(t + connections) where t is event loop threads
+ *
+ * Complexity Analysis:
+ * 1. prepare_student_reads() - O(n log n): Compact and build the name
+ *    index before any client arrives
+ * 2. open_listener() and the stop pipe - O(1)
+ * 3. One epoll instance and thread per loop, each watching the shared
+ *    listener and the stop pipe - O(t)
+ * 4. Join the loops after a stop signal; close and unlink the socket -
+ *    O(t + connections)
+ *
+ * Changes are journaled as they are made; the caller compacts the
+ * journal after this returns, as it does when the menu exits.
+ *
+ * Overall: O(requests)
+ */
+int run_server(const char *endpoint, int threads)
+{
+    if (threads <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threads > SERVER_THREADS_MAX)
+        threads = SERVER_THREADS_MAX;
+
+    init_registry_lock();
+    prepare_student_reads();
+    listen_fd = open_listener(endpoint);
+    if (listen_fd < 0)
+        return 1;
+    if (pipe2(stop_pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        perror("pipe");
+        close(listen_fd);
+        return 1;
+    }
+
+    struct sigaction sa = {.sa_handler = on_stop_signal, .sa_flags = SA_RESTART};
+    struct sigaction old_int, old_term;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+
+    int count = students_count();
+    Worker *workers = calloc((size_t)threads, sizeof(Worker));
+    int started = 0;
+    bool ok = workers != NULL;
+    for (int i = 0; ok && i < threads; ++i)
+    {
+        Worker *w = &workers[i];
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event le = {.events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = &listen_tag};
+        struct epoll_event se = {.events = EPOLLIN, .data.ptr = &stop_tag};
+        ok = w->epfd >= 0 && epoll_ctl(w->epfd, EPOLL_CTL_ADD, listen_fd, &le) == 0 &&
+             epoll_ctl(w->epfd, EPOLL_CTL_ADD, stop_pipe[0], &se) == 0 &&
+             pthread_create(&w->thread, NULL, worker_run, w) == 0;
+        if (!ok)
+        {
+            perror("Starting server thread");
+            if (w->epfd >= 0)
+                close(w->epfd);
+            break;
+        }
+        started++;
+    }
+    if (ok)
+        printf("Serving %d student(s) on %s with %d thread(s)\n", count, endpoint, threads);
+    else
+        on_stop_signal(0);
+    fflush(stdout);
+
+    for (int i = 0; i < started; ++i)
+    {
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].epfd);
+    }
+    free(workers);
+
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    stop_pipe[0] = stop_pipe[1] = -1;
+    close(listen_fd);
+    listen_fd = -1;
+    if (unix_path[0])
+    {
+        unlink(unix_path);
+        unix_path[0] = '\0';
+    }
+    pthread_rwlock_destroy(&registry_lock);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+#include "stats.h"
+#include "student.h"
+
+/* Independent accumulators per lane: the inner loop over lanes has no
+ * cross-iteration dependency, so the compiler can map it onto SIMD
+ * compare/select and add instructions. */
+#define STATS_LANES 8
+
+/**
+ * class_stats - One-pass class statistics over the columnar averages
+ *
+ * Time Complexity: O(n) where n is number of students
+ * Space Complexity: O(1) - fixed lane accumulators
+ *
+ * Complexity Analysis:
+ * 1. Fetch the columns (compacting any tombstones), empty check - O(1)
+ * 2. Blocked scan - O(n): STATS_LANES students per block, each lane
+ *    keeps its own max/min with index, sum, sum of squares, threshold
+ *    count, grade total and ungraded count
+ *    - Reads only student_average_column() and
+ *      student_grade_count_column(): 8 contiguous bytes per student
+ * 3. Tail - O(STATS_LANES): Leftover students go through lane 0
+ * 4. Reduce lanes - O(STATS_LANES): Ties keep the lower index, so the
+ *    result matches a plain left-to-right scan
+ * 5. mean = sum / n, variance = sumsq / n - mean² (double precision)
+ *
+ * Overall: O(n) - single pass, no Student struct is touched
+ */
+bool class_stats(float threshold, ClassStats *out)
+{
+    const float *avg = student_average_column();
+    const int *gc = student_grade_count_column();
+    int n = students_count();
+    if (n == 0)
+        return false;
+
+    float mx[STATS_LANES], mn[STATS_LANES];
+    int mxi[STATS_LANES], mni[STATS_LANES];
+    double sum[STATS_LANES], sq[STATS_LANES];
+    int above[STATS_LANES], ungraded[STATS_LANES];
+    long long grades[STATS_LANES];
+    for (int l = 0; l < STATS_LANES; ++l)
+    {
+        mx[l] = mn[l] = avg[0];
+        mxi[l] = mni[l] = 0;
+        sum[l] = sq[l] = 0.0;
+        above[l] = ungraded[l] = 0;
+        grades[l] = 0;
+    }
+
+    int i = 0;
+    for (; i + STATS_LANES <= n; i += STATS_LANES)
+    {
+        for (int l = 0; l < STATS_LANES; ++l)
+        {
+            float v = avg[i + l];
+            mxi[l] = v > mx[l] ? i + l : mxi[l];
+            mx[l] = v > mx[l] ? v : mx[l];
+            mni[l] = v < mn[l] ? i + l : mni[l];
+            mn[l] = v < mn[l] ? v : mn[l];
+            sum[l] += v;
+            sq[l] += (double)v * v;
+            above[l] += v >= threshold;
+            grades[l] += gc[i + l];
+            ungraded[l] += gc[i + l] == 0;
+        }
+    }
+    for (; i < n; ++i)
+    {
+        float v = avg[i];
+        if (v > mx[0])
+        {
+            mx[0] = v;
+            mxi[0] = i;
+        }
+        if (v < mn[0])
+        {
+            mn[0] = v;
+            mni[0] = i;
+        }
+        sum[0] += v;
+        sq[0] += (double)v * v;
+        above[0] += v >= threshold;
+        grades[0] += gc[i];
+        ungraded[0] += gc[i] == 0;
+    }
+
+    ClassStats st = {0};
+    st.count = n;
+    st.threshold = threshold;
+    st.highest = mx[0];
+    st.highestIdx = mxi[0];
+    st.lowest = mn[0];
+    st.lowestIdx = mni[0];
+    double total = 0.0, total_sq = 0.0;
+    for (int l = 0; l < STATS_LANES; ++l)
+    {
+        if (mx[l] > st.highest || (mx[l] == st.highest && mxi[l] < st.highestIdx))
+        {
+            st.highest = mx[l];
+            st.highestIdx = mxi[l];
+        }
+        if (mn[l] < st.lowest || (mn[l] == st.lowest && mni[l] < st.lowestIdx))
+        {
+            st.lowest = mn[l];
+            st.lowestIdx = mni[l];
+        }
+        total += sum[l];
+        total_sq += sq[l];
+        st.atOrAbove += above[l];
+        st.ungraded += ungraded[l];
+        st.totalGrades += grades[l];
+    }
+    st.mean = total / n;
+    st.variance = total_sq / n - st.mean * st.mean;
+    if (st.variance < 0.0)
+        st.variance = 0.0; /* rounding when every average is equal */
+    *out = st;
+    return true;
+}
+
+/**
+ * class_highest_lowest - Find students with highest and lowest averages
+ *
+ * Time Complexity: O(n) where n is number of students
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. class_stats() - O(n): Single columnar pass
+ * 2. Copy the extremes out - O(1)
+ *
+ * Ties resolve to the first student in the current order.
+ *
+ * Overall: O(n) - single pass through students
+ */
+bool class_highest_lowest(float *highest, int *h_idx, float *lowest, int *l_idx)
+{
+    ClassStats st;
+    if (!class_stats(STATS_PASS_MARK, &st))
+        return false;
+    *highest = st.highest;
+    *h_idx = st.highestIdx;
+    *lowest = st.lowest;
+    *l_idx = st.lowestIdx;
+    return true;
+}
+
+/**
+ * histogram_count_range - Values in [lo, hi) by histogram buckets
+ *
+ * Time Complexity: O(HIST_BUCKETS)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. histogram_bucket() both ends - O(1): hi above HIST_MAX also takes
+ *    the last bucket, which holds exactly HIST_MAX
+ * 2. Sum the buckets between - O(HIST_BUCKETS)
+ *
+ * Exact when lo and hi are multiples of HIST_BUCKET_WIDTH; otherwise
+ * each end is rounded down to its bucket edge.
+ *
+ * Overall: O(1) - independent of the number of students and grades
+ */
+long long histogram_count_range(const Histogram *h, float lo, float hi)
+{
+    int from = histogram_bucket(lo);
+    int to = hi > HIST_MAX ? HIST_BUCKETS : histogram_bucket(hi);
+    long long n = 0;
+    for (int k = from; k < to; ++k)
+        n += h->count[k];
+    return n;
+}
+
+/**
+ * histogram_percentile - Approximate percentile from histogram buckets
+ *
+ * Time Complexity: O(HIST_BUCKETS)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Clamp pct to [0, 100], rank = pct / 100 × total - O(1)
+ * 2. Walk the cumulative counts to the bucket holding the rank - O(HIST_BUCKETS)
+ * 3. Interpolate linearly inside that bucket - O(1): Off by at most
+ *    HIST_BUCKET_WIDTH for values in [0, HIST_MAX]
+ *
+ * Returns false for an empty histogram.
+ *
+ * Overall: O(1) - independent of the number of students and grades
+ */
+bool histogram_percentile(const Histogram *h, float pct, float *out)
+{
+    if (h->total <= 0)
+        return false;
+    if (pct < 0.0f)
+        pct = 0.0f;
+    if (pct > 100.0f)
+        pct = 100.0f;
+    double rank = (double)pct / 100.0 * (double)h->total;
+    long long before = 0;
+    int k = 0;
+    for (; k < HIST_BUCKETS - 1; ++k)
+    {
+        if (h->count[k] > 0 && (double)(before + h->count[k]) >= rank)
+            break;
+        before += h->count[k];
+    }
+    if (k == HIST_BUCKETS - 1)
+    {
+        *out = HIST_MAX;
+        return true;
+    }
+    double frac = h->count[k] > 0 ? (rank - (double)before) / (double)h->count[k] : 0.0;
+    *out = (float)((k + frac) * HIST_BUCKET_WIDTH);
+    return true;
+}
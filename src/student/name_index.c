@@ -0,0 +1,322 @@
+#include "name_index.h"
+#include "student.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* One table row: the folded key is copied so comparisons never chase
+ * into students[] and survive reordering and compaction */
+struct NameEntry
+{
+    int id;
+    bool dead; /* removed since the last build */
+    char key[NAME_INDEX_KEY_LEN];
+};
+
+/**
+ * fold_char - Lower-case one ASCII letter
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static char fold_char(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+/**
+ * fold_name - Copy a name into a lower-case (ASCII) key
+ *
+ * Time Complexity: O(k) where k < NAME_INDEX_KEY_LEN
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k) - longer names are cut to the key length
+ */
+static void fold_name(char *dst, const char *src)
+{
+    int i = 0;
+    for (; i < NAME_INDEX_KEY_LEN - 1 && src[i]; ++i)
+        dst[i] = fold_char(src[i]);
+    dst[i] = '\0';
+}
+
+/**
+ * name_has_prefix - Whether a full name starts with prefix, ignoring ASCII case
+ *
+ * Time Complexity: O(k) where k is the prefix length
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k)
+ */
+static bool name_has_prefix(const char *name, const char *prefix)
+{
+    for (; *prefix; ++name, ++prefix)
+        if (fold_char(*name) != fold_char(*prefix))
+            return false;
+    return true;
+}
+
+/**
+ * entry_cmp - Order two entries by folded key, then by ID
+ *
+ * Time Complexity: O(k) where k < NAME_INDEX_KEY_LEN
+ * Space Complexity: O(1)
+ *
+ * The ID tie-break makes every entry unique, so a removal can find
+ * exactly its own row among students sharing a name.
+ *
+ * Overall: O(k)
+ */
+static int entry_cmp(const char *key, int id, const NameEntry *e)
+{
+    int c = strcmp(key, e->key);
+    if (c != 0)
+        return c;
+    return (id > e->id) - (id < e->id);
+}
+
+/**
+ * entry_qsort_cmp - qsort() adapter for entry_cmp()
+ *
+ * Time Complexity: O(k)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(k)
+ */
+static int entry_qsort_cmp(const void *a, const void *b)
+{
+    const NameEntry *x = a;
+    return entry_cmp(x->key, x->id, b);
+}
+
+/**
+ * lower_bound - First entry not ordered before (key, id)
+ *
+ * Time Complexity: O(log n × k)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Binary search over a sorted table - O(log n) steps
+ * 2. entry_cmp() per step - O(k)
+ *
+ * Overall: O(log n)
+ */
+static int lower_bound(const NameEntry *tab, int n, const char *key, int id)
+{
+    int lo = 0, hi = n;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (entry_cmp(key, id, &tab[mid]) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * name_index_init - Start with an empty, unbuilt index
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void name_index_init(NameIndex *ix)
+{
+    ix->tab = ix->delta = NULL;
+    ix->tab_len = ix->tab_dead = ix->delta_len = 0;
+    ix->built = false;
+}
+
+/**
+ * name_index_reset - Drop the index; the next query rebuilds it
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void name_index_reset(NameIndex *ix)
+{
+    free(ix->tab);
+    free(ix->delta);
+    name_index_init(ix);
+}
+
+/**
+ * name_index_build - Build the sorted table from the live students
+ *
+ * Time Complexity: O(n log n × k)
+ * Space Complexity: O(n) entries plus the delta table
+ *
+ * Complexity Analysis:
+ * 1. Allocate both tables - O(1)
+ * 2. fold_name() every live slot - O(n × k)
+ * 3. qsort() by (key, id) - O(n log n)
+ *
+ * Overall: O(n log n)
+ */
+bool name_index_build(NameIndex *ix, StudentRegistry *r)
+{
+    name_index_reset(ix);
+    int slots = registry_student_slots(r);
+    ix->tab = malloc((size_t)(slots > 0 ? slots : 1) * sizeof(NameEntry));
+    ix->delta = malloc(NAME_INDEX_DELTA_MAX * sizeof(NameEntry));
+    if (!ix->tab || !ix->delta)
+    {
+        fprintf(stderr, "Memory allocation failed (name index).\n");
+        name_index_reset(ix);
+        return false;
+    }
+    for (int i = 0; i < slots; ++i)
+    {
+        Student *s = registry_get_student_by_index(r, i);
+        if (!s)
+            continue;
+        NameEntry *e = &ix->tab[ix->tab_len++];
+        e->id = s->id;
+        e->dead = false;
+        fold_name(e->key, registry_student_name(r, s));
+    }
+    qsort(ix->tab, ix->tab_len, sizeof(NameEntry), entry_qsort_cmp);
+    ix->built = true;
+    return true;
+}
+
+/**
+ * name_index_insert - Register a new or renamed student
+ *
+ * Time Complexity: O(log d + d) where d ≤ NAME_INDEX_DELTA_MAX
+ * Space Complexity: O(1) - the delta table is preallocated
+ *
+ * Complexity Analysis:
+ * 1. Index not built - O(1): Nothing to maintain
+ * 2. Delta full - O(1): Drop the index instead of merging, so bulk
+ *    loads pay one O(n log n) rebuild on the next query
+ * 3. lower_bound() in the delta - O(log d)
+ * 4. memmove() the tail up one entry - O(d)
+ *
+ * Overall: O(d), bounded by NAME_INDEX_DELTA_MAX
+ */
+void name_index_insert(NameIndex *ix, int id, const char *name)
+{
+    if (!ix->built)
+        return;
+    if (ix->delta_len == NAME_INDEX_DELTA_MAX)
+    {
+        name_index_reset(ix);
+        return;
+    }
+    char key[NAME_INDEX_KEY_LEN];
+    fold_name(key, name);
+    int pos = lower_bound(ix->delta, ix->delta_len, key, id);
+    memmove(&ix->delta[pos + 1], &ix->delta[pos], (size_t)(ix->delta_len - pos) * sizeof(NameEntry));
+    NameEntry *e = &ix->delta[pos];
+    e->id = id;
+    e->dead = false;
+    memcpy(e->key, key, sizeof(key));
+    ix->delta_len++;
+}
+
+/**
+ * name_index_remove - Unregister a deleted student or an old name
+ *
+ * Time Complexity: O(log n + d)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Index not built - O(1)
+ * 2. lower_bound() in the delta - O(log d): Remove with memmove() -
+ *    O(d) when the entry was inserted since the build
+ * 3. Otherwise lower_bound() in the main table - O(log n): Mark the
+ *    entry dead instead of shifting n entries
+ * 4. Drop the index once a quarter of the main table is dead - O(1)
+ *
+ * Overall: O(log n + d)
+ */
+void name_index_remove(NameIndex *ix, int id, const char *name)
+{
+    if (!ix->built)
+        return;
+    char key[NAME_INDEX_KEY_LEN];
+    fold_name(key, name);
+    int pos = lower_bound(ix->delta, ix->delta_len, key, id);
+    if (pos < ix->delta_len && entry_cmp(key, id, &ix->delta[pos]) == 0)
+    {
+        memmove(&ix->delta[pos], &ix->delta[pos + 1], (size_t)(ix->delta_len - pos - 1) * sizeof(NameEntry));
+        ix->delta_len--;
+        return;
+    }
+    pos = lower_bound(ix->tab, ix->tab_len, key, id);
+    if (pos < ix->tab_len && entry_cmp(key, id, &ix->tab[pos]) == 0 && !ix->tab[pos].dead)
+    {
+        ix->tab[pos].dead = true;
+        if (++ix->tab_dead * 4 > ix->tab_len)
+            name_index_reset(ix);
+    }
+}
+
+/**
+ * name_index_search - IDs of r's students whose name starts with prefix
+ *
+ * Time Complexity: O(log n + k) where k is matches returned; the first
+ *                  query after a bulk change adds an O(n log n) build
+ * Space Complexity: O(1) per query, O(n) for the index itself
+ *
+ * Complexity Analysis:
+ * 1. name_index_build() from r if the index was dropped - O(n log n)
+ * 2. fold_name() the prefix - O(k) for the bounded key
+ * 3. lower_bound() in the main table and the delta - O(log n)
+ * 4. Merge the two runs while keys still start with the prefix -
+ *    O(k): Dead entries are skipped, at most a quarter of the table
+ * 5. Prefix as long as a key - O(k) lookups: Check each candidate's
+ *    full name in r, since the keys only hold its start
+ *
+ * Matching ignores ASCII case. Results come in name order (ties by ID,
+ * as do names equal up to the key length); at most max IDs are written
+ * to ids. Returns the number written.
+ *
+ * Overall: O(log n + k)
+ */
+int name_index_search(NameIndex *ix, StudentRegistry *r, const char *prefix, int *ids, int max)
+{
+    if (max <= 0 || (!ix->built && !name_index_build(ix, r)))
+        return 0;
+    char key[NAME_INDEX_KEY_LEN];
+    if (!prefix)
+        prefix = "";
+    fold_name(key, prefix);
+    size_t klen = strlen(key);
+    bool cut = klen == NAME_INDEX_KEY_LEN - 1 && prefix[klen];
+    int i = lower_bound(ix->tab, ix->tab_len, key, INT_MIN);
+    int j = lower_bound(ix->delta, ix->delta_len, key, INT_MIN);
+    int found = 0;
+    while (found < max)
+    {
+        bool in_tab = i < ix->tab_len && strncmp(ix->tab[i].key, key, klen) == 0;
+        bool in_delta = j < ix->delta_len && strncmp(ix->delta[j].key, key, klen) == 0;
+        if (!in_tab && !in_delta)
+            break;
+        const NameEntry *e;
+        if (in_tab && (!in_delta || entry_cmp(ix->tab[i].key, ix->tab[i].id, &ix->delta[j]) < 0))
+            e = &ix->tab[i++];
+        else
+            e = &ix->delta[j++];
+        if (e->dead)
+            continue;
+        if (cut)
+        {
+            int idx = registry_find_student_index(r, e->id);
+            if (idx == -1 ||
+                !name_has_prefix(registry_student_name(r, registry_get_student_by_index(r, idx)), prefix))
+                continue;
+        }
+        ids[found++] = e->id;
+    }
+    return found;
+}
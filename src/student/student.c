@@ -1,780 +1,4218 @@
+#define _POSIX_C_SOURCE 200809L
 #include "student.h"
+#include "name_index.h"
+#include "instrument.h"
+#include "outbuf.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
-/* Internal dynamic array for students */
-static Student *students = NULL;
-static int students_capacity = 0;
-static int students_size = 0;
+/* ID -> slot hash index (open addressing, linear probing).
+ * Each bucket keeps the ID next to its position in students[] so probing
+ * never reads students[] and stays valid while the array is reordered.
+ * slot == -1 marks an empty bucket. The table size is a power of two
+ * kept >= 2 * students_capacity, so the load factor never exceeds 0.5. */
+typedef struct
+{
+    int id;
+    int slot;
+} IdBucket;
+
+/* Grade pool: bump allocator over large chunks. Pooled grade runs are
+ * never freed individually; registry_free() releases every chunk at
+ * once. Off by default, meant for bulk imports. */
+typedef struct GradeChunk
+{
+    struct GradeChunk *next;
+    size_t used;
+    size_t cap;
+    GradeValue data[];
+} GradeChunk;
+
+/* Snapshot mappings that GRADES_MAPPED runs point into. Adopted from the
+ * loader and released by registry_free() after every run is dropped. */
+typedef struct GradeMapping
+{
+    struct GradeMapping *next;
+    void *base;
+    size_t size;
+    void (*release)(void *base, size_t size);
+} GradeMapping;
+
+/* Cold records (StudentCold) per slab. Slabs are never moved or freed
+ * before registry_free(), so Student.cold stays valid while students[]
+ * is reallocated, sorted and compacted; records of deleted students
+ * go on a free list and are reused first. */
+#define COLD_SLAB 1024
+
+typedef union ColdSlot
+{
+    StudentCold cold;
+    union ColdSlot *next_free;
+} ColdSlot;
+
+typedef struct ColdSlab
+{
+    struct ColdSlab *next;
+    int used;
+    ColdSlot slots[COLD_SLAB];
+} ColdSlab;
+
+/* Name arena growth starts here; garbage below ARENA_GARBAGE_MIN bytes
+ * (or under half the arena) is left for the next compaction */
+#define ARENA_MIN 4096
+#define ARENA_GARBAGE_MIN 4096
+
+/* Key-index pairs: merge sort orders these 8-byte pairs and moves each
+ * Student struct exactly once at the end. Both buffers are kept between
+ * sorts and only grow. */
+typedef struct
+{
+    uint32_t key; /* order-preserving encoding of the sort key */
+    int idx;      /* position in students[] before the sort */
+} SortPair;
+
+/* Everything one registry owns. Nothing here is shared between
+ * registries, so each can be used from its own thread. */
+struct StudentRegistry
+{
+    /* Dynamic array for students */
+    Student *students;
+    int students_capacity;
+    int students_size;
+
+    /* Slots in [0, students_size) that are tombstones awaiting compaction */
+    int students_dead;
+
+    /* Columnar mirror of the fields analytics scan: col_x[i] always
+     * equals students[i].x. Sized with students_capacity so scans read
+     * 4 contiguous bytes per student instead of striding over whole
+     * Student structs. */
+    int *col_id;
+    float *col_avg;
+    int *col_grade_count;
+
+    IdBucket *id_index;
+    int id_index_capacity;
+
+    GradeChunk *grade_pool;
+    bool grade_pool_enabled;
+
+    GradeMapping *grade_mappings;
+
+    ColdSlab *cold_slabs;
+    ColdSlot *cold_free;
+
+    /* Name arena: arena_used bytes of NUL-terminated names, each at a
+     * 4-byte aligned StudentCold.name_off and zero-padded. Renames
+     * append, so replaced and deleted names stay as arena_garbage until
+     * arena_compact(). */
+    char *arena;
+    uint32_t arena_used;
+    uint32_t arena_cap;
+    uint32_t arena_garbage;
+
+    SortPair *sort_pairs;
+    SortPair *sort_scratch;
+    int sort_buf_capacity;
+
+    NameIndex names;
+
+    /* Distributions of every grade and every average, adjusted by each
+     * add, grade append and delete. grade_hist_stale means mapped grades
+     * were added unread; the next query recounts them. */
+    Histogram grade_hist;
+    Histogram avg_hist;
+    bool grade_hist_stale;
+
+    /* Called with the ID after every add, delete, rename or new grade */
+    void (*on_change)(int id, void *ctx);
+    void *on_change_ctx;
+
+    /* Dirty tracking: IDs whose Student.dirty bit went from 0 to 1 since
+     * registry_clear_dirty(), in that order. dirty_overflow means the
+     * list could not grow and every student counts as dirty. */
+    bool track_dirty;
+    int *dirty_ids;
+    int dirty_len;
+    int dirty_cap;
+    bool dirty_overflow;
+};
+
+/* Instance behind the functions without a registry argument */
+static StudentRegistry default_instance;
+
+/* Worker threads for parallel merge sort; 0 means one per online CPU */
+static int sort_threads = 0;
 
 /**
- * ensure_capacity - Ensure the students array has enough capacity
+ * id_hash - Map a student ID to its home bucket in the ID index
  *
- * Time Complexity: O(n) amortized O(1)
- * Space Complexity: O(n) when reallocation occurs
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no allocation
  *
  * Complexity Analysis:
- * 1. Capacity check - O(1): Compare size with capacity
- * 2. Calculate new capacity - O(1): Doubling strategy
- * 3. realloc() - O(n): Copy existing n students to new location
- * 4. Update pointers - O(1): Assignment operations
- *
- * Amortized Analysis:
- * - Doubling strategy means reallocation at sizes: 4, 8, 16, 32...
- * - Total copies for n elements: 2 + 4 + 8 + ... + n/2 ≈ n
- * - Amortized cost per insertion: O(1)
+ * 1. Multiply by golden-ratio constant - O(1): Spreads sequential IDs
+ * 2. Fold high bits down - O(1): XOR-shift
+ * 3. Mask to table size - O(1): Capacity is a power of two
  *
- * Overall: O(n) per call, but amortized O(1) over sequence of insertions
+ * Overall: O(1) - a few integer operations
  */
-static void ensure_capacity(void)
+static int id_hash(StudentRegistry *r, int id)
 {
-    if (students_size >= students_capacity)
-    {
-        int newcap = (students_capacity == 0) ? 4 : students_capacity * 2;
-        Student *tmp = realloc(students, newcap * sizeof(Student));
-        if (!tmp)
-        {
-            fprintf(stderr, "Memory allocation failed (students array).\n");
-            exit(EXIT_FAILURE);
-        }
-        students = tmp;
-        students_capacity = newcap;
-    }
+    uint32_t h = (uint32_t)id * 2654435769u;
+    h ^= h >> 16;
+    return (int)(h & (uint32_t)(r->id_index_capacity - 1));
 }
 
 /**
- * init_students - Initialize the student management system
+ * id_index_put - Insert or overwrite the slot stored for an ID
  *
- * Time Complexity: O(1) - constant time
- * Space Complexity: O(1) - no allocation
+ * Time Complexity: O(1) expected
+ * Space Complexity: O(1) - table is preallocated
  *
  * Complexity Analysis:
- * 1. Set students pointer to NULL - O(1)
- * 2. Set capacity to 0 - O(1)
- * 3. Set size to 0 - O(1)
+ * 1. id_hash() - O(1): Compute home bucket
+ * 2. Linear probe - O(1) expected: Load factor <= 0.5
+ *    - Stop at empty bucket or bucket already holding this ID
+ * 3. Store slot - O(1)
  *
- * Overall: O(1) - simple initialization
+ * Overall: O(1) expected
  */
-void init_students(void)
+static void id_index_put(StudentRegistry *r, int id, int slot)
 {
-    students = NULL;
-    students_capacity = students_size = 0;
+    int mask = r->id_index_capacity - 1;
+    int b = id_hash(r, id);
+    while (r->id_index[b].slot != -1 && r->id_index[b].id != id)
+        b = (b + 1) & mask;
+    r->id_index[b].id = id;
+    r->id_index[b].slot = slot;
 }
 
 /**
- * free_students - Free all allocated memory for students
+ * id_index_rebuild - Reallocate the ID index for the current capacity
  *
  * Time Complexity: O(n) where n is number of students
- * Space Complexity: O(1) - only frees memory, doesn't allocate
+ * Space Complexity: O(c) where c is students_capacity
  *
  * Complexity Analysis:
- * 1. Loop through students - O(n): Iterate n times
- * 2. For each student:
- *    - free(grades) - O(1): Free grades array pointer
- *    - Set to NULL - O(1): Update pointer
- * 3. free(students) - O(1): Free main array pointer
- * 4. Reset variables - O(1): Set to NULL/0
+ * 1. Compute table size - O(log c): Next power of two >= 2c
+ * 2. malloc() and clear - O(c): Mark all buckets empty
+ * 3. Reinsert every live student - O(n): id_index_put() each
  *
- * Overall: O(n) - must free each student's grades individually
+ * Called when students_capacity doubles, so the cost is amortized O(1)
+ * per insertion like ensure_capacity(), and by shrink_students_to_fit().
+ *
+ * Overall: O(n) per call, amortized O(1)
  */
-void free_students(void)
+static void id_index_rebuild(StudentRegistry *r)
 {
-    for (int i = 0; i < students_size; ++i)
+    int newcap = 8;
+    while (newcap < 2 * r->students_capacity)
+        newcap *= 2;
+    IdBucket *tmp = malloc(newcap * sizeof(IdBucket));
+    if (!tmp)
     {
-        free(students[i].grades);
-        students[i].grades = NULL;
+        fprintf(stderr, "Memory allocation failed (ID index).\n");
+        exit(EXIT_FAILURE);
     }
-    free(students);
-    students = NULL;
-    students_capacity = students_size = 0;
+    free(r->id_index);
+    r->id_index = tmp;
+    r->id_index_capacity = newcap;
+    for (int b = 0; b < newcap; ++b)
+        r->id_index[b].slot = -1;
+    for (int i = 0; i < r->students_size; ++i)
+        if (!r->students[i].dead)
+            id_index_put(r, r->students[i].id, i);
 }
 
 /**
- * index_of_id - Find the index of a student by ID (linear search)
+ * id_index_remove - Remove an ID from the index
  *
- * Time Complexity: O(n) where n is number of students
+ * Time Complexity: O(1) expected
  * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
- * 1. Loop through students - O(n): Worst case check all n students
- * 2. For each iteration:
- *    - Compare IDs - O(1): Integer comparison
- *    - Return if match - O(1): Early exit possible
- * 3. Return -1 if not found - O(1)
- *
- * Best case: O(1) - ID found at first position
- * Average case: O(n/2) - ID found in middle
- * Worst case: O(n) - ID not found or at end
+ * 1. Probe for the ID's bucket - O(1) expected
+ * 2. Backward-shift deletion - O(1) expected:
+ *    - Walk the rest of the probe cluster
+ *    - Move back any entry whose home bucket lies cyclically
+ *      at or before the hole, so no tombstones are needed
  *
- * Overall: O(n) - linear search
+ * Overall: O(1) expected
  */
-/* return index of student with id or -1 */
-static int index_of_id(int id)
+static void id_index_remove(StudentRegistry *r, int id)
 {
-    for (int i = 0; i < students_size; ++i)
+    int mask = r->id_index_capacity - 1;
+    int b = id_hash(r, id);
+    while (r->id_index[b].slot != -1 && r->id_index[b].id != id)
+        b = (b + 1) & mask;
+    if (r->id_index[b].slot == -1)
+        return;
+    int hole = b;
+    int j = b;
+    while (1)
     {
-        if (students[i].id == id)
-            return i;
+        j = (j + 1) & mask;
+        if (r->id_index[j].slot == -1)
+            break;
+        int home = id_hash(r, r->id_index[j].id);
+        /* entry at j may fill the hole if home is not in (hole, j] */
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            r->id_index[hole] = r->id_index[j];
+            hole = j;
+        }
     }
-    return -1;
+    r->id_index[hole].slot = -1;
 }
 
 /**
- * add_student - Add a new student (no duplicate IDs allowed)
+ * id_index_reassign - Re-point index entries after students moved
  *
- * Time Complexity: O(n) amortized
+ * Time Complexity: O(n - from) expected
  * Space Complexity: O(1) - constant extra space
  *
  * Complexity Analysis:
- * 1. index_of_id() - O(n): Check for duplicate ID
- * 2. ensure_capacity() - Amortized O(1): Dynamic array expansion
- * 3. Initialize student fields:
- *    - Set id - O(1)
- *    - strncpy() - O(k) where k ≤ NAME_LEN (bounded constant)
- *    - Initialize other fields - O(1)
- * 4. Increment size - O(1)
+ * 1. Loop over slots [from, n) - O(n - from)
+ * 2. id_index_put() per slot - O(1) expected: Overwrites old slot
+ *
+ * Used after compaction shifts the tail left and after sorting.
  *
- * Overall: O(n) dominated by duplicate check
+ * Overall: O(n - from) expected
  */
-/* Add a student (no duplicate id), initialize grade array */
-bool add_student(int id, const char *name)
+static void id_index_reassign(StudentRegistry *r, int from)
 {
-    if (index_of_id(id) != -1)
-        return false; /* duplicate id */
-    ensure_capacity();
-    Student *s = &students[students_size++];
-    s->id = id;
-    strncpy(s->name, name ? name : "", NAME_LEN - 1);
-    s->name[NAME_LEN - 1] = '\0';
-    s->grades = NULL;
-    s->gradeCount = 0;
-    s->average = 0.0f;
-    return true;
+    for (int i = from; i < r->students_size; ++i)
+        id_index_put(r, r->students[i].id, i);
 }
 
 /**
- * delete_student - Delete a student by ID
+ * col_store - Copy one student's hot fields into the column arrays
  *
- * Time Complexity: O(n) where n is number of students
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no allocation
  *
  * Complexity Analysis:
- * 1. index_of_id() - O(n): Linear search for student
- * 2. free(grades) - O(1): Free grades array
- * 3. Shift elements left - O(n): In worst case, shift all remaining students
- *    - For each of (n - idx - 1) students: O(1) copy operation
- * 4. Decrement size - O(1)
+ * 1. Three stores - O(1): id, average, gradeCount
  *
- * Best case: O(n) - delete last student (no shifting)
- * Worst case: O(n) - delete first student (shift n-1 students)
+ * Called by every function that changes those fields or a student's slot.
  *
- * Overall: O(n) - linear search plus potential linear shift
+ * Overall: O(1)
  */
-/* Delete student by id */
-bool delete_student(int id)
+static void col_store(StudentRegistry *r, int i)
 {
-    int idx = index_of_id(id);
-    if (idx == -1)
-        return false;
-    free(students[idx].grades);
-    /* shift left */
-    for (int i = idx; i < students_size - 1; ++i)
-    {
-        students[i] = students[i + 1];
-    }
-    students_size--;
-    return true;
+    r->col_id[i] = r->students[i].id;
+    r->col_avg[i] = r->students[i].average;
+    r->col_grade_count[i] = r->students[i].gradeCount;
 }
 
 /**
- * update_student_name - Update a student's name
+ * col_store_from - Refresh the columns for every slot from a position on
  *
- * Time Complexity: O(n) where n is number of students
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(n - from)
+ * Space Complexity: O(1) - no allocation
  *
  * Complexity Analysis:
- * 1. index_of_id() - O(n): Linear search for student
- * 2. strncpy() - O(k) where k ≤ NAME_LEN (bounded constant, typically < 50)
- * 3. Null termination - O(1)
+ * 1. Loop over slots [from, n) - O(n - from): col_store() each
+ *
+ * Used after compaction shifts the tail left and after sorting.
  *
- * Overall: O(n) dominated by search operation
+ * Overall: O(n - from)
  */
-/* Update name */
-bool update_student_name(int id, const char *newname)
+static void col_store_from(StudentRegistry *r, int from)
 {
-    int idx = index_of_id(id);
-    if (idx == -1)
-        return false;
-    strncpy(students[idx].name, newname, NAME_LEN - 1);
-    students[idx].name[NAME_LEN - 1] = '\0';
-    return true;
+    for (int i = from; i < r->students_size; ++i)
+        col_store(r, i);
 }
 
 /**
- * add_grade_to_student - Add a grade to a student and recalculate average
- *
- * Time Complexity: O(n + g) where n is students, g is grades
- * Space Complexity: O(g) for storing grades
+ * hist_add - Count a value into a histogram, or out with delta -1
  *
- * Complexity Analysis:
- * 1. index_of_id() - O(n): Linear search for student
- * 2. realloc() - O(g): Copy existing g grades to new memory
- * 3. Add new grade - O(1): Assign value and increment count
- * 4. recalc_average() - O(g): Recursive sum of all g grades
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Overall: O(n + g) where typically g << n
+ * Overall: O(1)
  */
-/* Add grade to student (uses malloc/realloc) */
-bool add_grade_to_student(int id, float grade)
+static void hist_add(Histogram *h, float v, int delta)
 {
-    int idx = index_of_id(id);
-    if (idx == -1)
-        return false;
-    Student *s = &students[idx];
-    float *tmp = realloc(s->grades, (s->gradeCount + 1) * sizeof(float));
-    if (!tmp && s->gradeCount + 1 > 0)
-    { /* realloc failed */
-        fprintf(stderr, "Memory allocation failed for grades.\n");
-        exit(EXIT_FAILURE);
-    }
-    s->grades = tmp;
-    s->grades[s->gradeCount++] = grade;
-    recalc_average(s);
-    return true;
+    h->count[histogram_bucket(v)] += delta;
+    h->total += delta;
 }
 
 /**
- * sum_grades_recursive - Recursively sum grades using divide and conquer
+ * hist_move_average - Move a student from its old average's bucket to the new one
  *
- * Time Complexity: O(g) where g is number of grades
- * Space Complexity: O(log g) for recursion stack
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Complexity Analysis:
- * 1. Base cases (n ≤ 1) - O(1): Direct return
- * 2. Divide step:
- *    - Calculate mid - O(1)
- *    - Recursive calls on two halves - T(g/2) each
- * 3. Conquer step:
- *    - Add two sums - O(1)
+ * Overall: O(1)
+ */
+static void hist_move_average(StudentRegistry *r, float old_avg, float new_avg)
+{
+    hist_add(&r->avg_hist, old_avg, -1);
+    hist_add(&r->avg_hist, new_avg, 1);
+}
+
+/**
+ * hist_count_grades - Count a run of grades into or out of the grade histogram
  *
- * Recurrence relation: T(g) = 2T(g/2) + O(1)
- * Solution by Master Theorem: T(g) = O(g)
+ * Time Complexity: O(c) where c is count
+ * Space Complexity: O(1)
  *
- * Recursion depth: log₂(g)
- * Stack space per level: O(1)
- * Total stack space: O(log g)
+ * Overall: O(c) - nothing while the histogram awaits a recount
+ */
+static void hist_count_grades(StudentRegistry *r, const GradeValue *grades, int count, int delta)
+{
+    if (r->grade_hist_stale)
+        return;
+    for (int i = 0; i < count; ++i)
+        hist_add(&r->grade_hist, grade_value(grades[i]), delta);
+}
+
+/**
+ * hist_merge - Add every bucket of src into dst
  *
- * Overall: O(g) time, O(log g) space
+ * Time Complexity: O(HIST_BUCKETS)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) - fixed bucket count
  */
-/* Recursive sum of grades */
-float sum_grades_recursive(const float *grades, int n)
+static void hist_merge(Histogram *dst, const Histogram *src)
 {
-    if (n <= 0)
-        return 0.0f;
-    if (n == 1)
-        return grades[0];
-    /* divide and conquer to avoid deep tail recursion for long arrays */
-    int mid = n / 2;
-    float left = sum_grades_recursive(grades, mid);
-    float right = sum_grades_recursive(grades + mid, n - mid);
-    return left + right;
+    for (int k = 0; k < HIST_BUCKETS; ++k)
+        dst->count[k] += src->count[k];
+    dst->total += src->total;
 }
 
 /**
- * recalc_average - Recalculate a student's average grade
+ * grade_hist_recount - Rebuild the grade histogram from every live student
  *
- * Time Complexity: O(g) where g is number of grades
- * Space Complexity: O(log g) for recursion stack
+ * Time Complexity: O(n + G) where G is total grades
+ * Space Complexity: O(1)
  *
  * Complexity Analysis:
- * 1. Null check - O(1)
- * 2. Zero grades check - O(1)
- * 3. sum_grades_recursive() - O(g): Sum all g grades
- * 4. Division - O(1): Calculate average
- * 5. Assignment - O(1): Store result
+ * 1. Clear the buckets - O(HIST_BUCKETS)
+ * 2. Count each live student's run - O(G): Faults in mapped grade
+ *    pages, which is why it waits for the first query
  *
- * Overall: O(g) time, O(log g) space from recursive sum
+ * Overall: O(n + G)
  */
-void recalc_average(Student *s)
+static void grade_hist_recount(StudentRegistry *r)
 {
-    if (!s)
-        return;
-    if (s->gradeCount == 0)
-    {
-        s->average = 0.0f;
-        return;
-    }
-    float sum = sum_grades_recursive(s->grades, s->gradeCount);
-    s->average = sum / (float)s->gradeCount;
+    memset(&r->grade_hist, 0, sizeof(r->grade_hist));
+    r->grade_hist_stale = false;
+    for (int i = 0; i < r->students_size; ++i)
+        if (!r->students[i].dead)
+            hist_count_grades(r, r->students[i].cold->grades, r->students[i].gradeCount, 1);
 }
 
 /**
- * display_all_students - Display summary of all students
+ * grow_column - realloc() one column array or abort
  *
- * Time Complexity: O(n) where n is number of students
- * Space Complexity: O(1) - constant extra space
- *
- * Complexity Analysis:
- * 1. Empty check - O(1)
- * 2. Print header - O(1): Fixed output
- * 3. Loop through students - O(n): Iterate n times
- * 4. For each student:
- *    - printf() - O(1): Fixed format output
+ * Time Complexity: O(n) - realloc() may copy n elements
+ * Space Complexity: O(newcap)
  *
- * Overall: O(n) - linear in number of students
+ * Overall: O(n)
  */
-/* Display functions */
-void display_all_students(void)
+static void *grow_column(void *col, int newcap, size_t elem)
 {
-    if (students_size == 0)
-    {
-        puts("No students.");
-        return;
-    }
-    printf("ID\tName\t\tAvg\t#grades\n");
-    printf("-----------------------------------------\n");
-    for (int i = 0; i < students_size; ++i)
+    void *tmp = realloc(col, (size_t)newcap * elem);
+    if (!tmp)
     {
-        Student *s = &students[i];
-        printf("%d\t%-15s\t%.2f\t%d\n", s->id, s->name, s->average, s->gradeCount);
+        fprintf(stderr, "Memory allocation failed (student columns).\n");
+        exit(EXIT_FAILURE);
     }
+    return tmp;
 }
 
 /**
- * display_grade_matrix - Display detailed grade matrix for all students
+ * grow_capacity - Grow the students array to hold at least mincap students
  *
- * Time Complexity: O(n × g) where n is students, g is avg grades per student
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(n) when reallocation occurs, O(1) otherwise
+ * Space Complexity: O(mincap) when reallocation occurs
  *
  * Complexity Analysis:
- * 1. Empty check - O(1)
- * 2. Print header - O(1)
- * 3. Outer loop - O(n): Iterate through n students
- * 4. For each student:
- *    - Print student info - O(1)
- *    - Inner loop - O(g): Print g grades
- *    - Each grade print - O(1)
- *
- * Total iterations: n × g (in worst case)
+ * 1. Capacity check - O(1): Compare mincap with capacity
+ * 2. Calculate new capacity - O(log mincap): Doubling strategy
+ * 3. realloc() - O(n): Copy existing n students to new location
+ * 4. Update pointers - O(1): Assignment operations
+ * 5. grow_column() x3 - O(n): Columns follow the array's capacity
+ * 6. id_index_rebuild() - O(n): Only when capacity grew
  *
- * Overall: O(n × g) where g varies per student
+ * Overall: O(n) per reallocation
  */
-/* 2D-like grade matrix */
-void display_grade_matrix(void)
+static void grow_capacity(StudentRegistry *r, int mincap)
 {
-    if (students_size == 0)
-    {
-        puts("No students.");
+    if (mincap <= r->students_capacity)
         return;
-    }
-    printf("Grades Matrix (each row = student):\n");
-    for (int i = 0; i < students_size; ++i)
+    int newcap = (r->students_capacity == 0) ? 4 : r->students_capacity;
+    while (newcap < mincap)
+        newcap *= 2;
+    Student *tmp = realloc(r->students, newcap * sizeof(Student));
+    if (!tmp)
     {
-        Student *s = &students[i];
-        printf("[%d] %d %-12s | ", i, s->id, s->name);
-        if (s->gradeCount == 0)
-        {
-            printf("(no grades)");
-        }
-        else
-        {
-            for (int j = 0; j < s->gradeCount; ++j)
-            {
-                printf("%.2f", s->grades[j]);
-                if (j + 1 < s->gradeCount)
-                    printf(", ");
-            }
-            printf("  (avg: %.2f)", s->average);
-        }
-        printf("\n");
+        fprintf(stderr, "Memory allocation failed (students array).\n");
+        exit(EXIT_FAILURE);
     }
+    INSTR_INC(INSTR_STUDENT_REALLOC);
+    r->students = tmp;
+    r->students_capacity = newcap;
+    r->col_id = grow_column(r->col_id, newcap, sizeof(int));
+    r->col_avg = grow_column(r->col_avg, newcap, sizeof(float));
+    r->col_grade_count = grow_column(r->col_grade_count, newcap, sizeof(int));
+    if (r->id_index_capacity < 2 * r->students_capacity)
+        id_index_rebuild(r);
 }
 
-/* --- Sorting utilities --- */
-
 /**
- * cmp_students - Compare two students by specified key
+ * ensure_capacity - Ensure the students array has room for one more student
  *
- * Time Complexity: O(1) - constant time
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(n) amortized O(1)
+ * Space Complexity: O(n) when reallocation occurs
  *
  * Complexity Analysis:
- * 1. Check key type - O(1): Simple comparison
- * 2. If SORT_BY_ID:
- *    - Integer subtraction - O(1)
- * 3. If SORT_BY_AVG:
- *    - Float comparisons - O(1) each
+ * 1. grow_capacity(size + 1) - O(1) unless full, O(n) when doubling
  *
- * Overall: O(1) - simple comparison operation
+ * Amortized Analysis:
+ * - Doubling strategy means reallocation at sizes: 4, 8, 16, 32...
+ * - Total copies for n elements: 2 + 4 + 8 + ... + n/2 ≈ n
+ * - Amortized cost per insertion: O(1)
+ *
+ * Overall: O(n) per call, but amortized O(1) over sequence of insertions
  */
-/* comparator by key: return <0 if a < b, 0 equal, >0 if a > b */
-static int cmp_students(const Student *a, const Student *b, SortKey key)
+static void ensure_capacity(StudentRegistry *r)
 {
-    if (key == SORT_BY_ID)
-    {
-        return (a->id - b->id);
-    }
-    else
-    {
-        if (a->average < b->average)
-            return -1;
-        if (a->average > b->average)
-            return 1;
-        return 0;
-    }
+    grow_capacity(r, r->students_size + 1);
 }
 
 /**
- * swap_students - Swap two students in the array
+ * registry_reserve_students - Reserve room for count more students up front
  *
- * Time Complexity: O(1) - constant time
- * Space Complexity: O(1) - uses temporary Student struct
+ * Time Complexity: O(n) - at most one reallocation
+ * Space Complexity: O(n + count)
  *
  * Complexity Analysis:
- * 1. Copy student a to temp - O(1): Struct assignment
- * 2. Copy student b to a - O(1): Struct assignment
- * 3. Copy temp to b - O(1): Struct assignment
+ * 1. Validate count - O(1)
+ * 2. grow_capacity() - O(n): Single realloc and index rebuild
  *
- * Note: Student struct is small (pointer + few integers/floats)
- * so copying is O(1) constant time
+ * Bulk loaders call this once with the record count so the following
+ * insertions never reallocate the array or rebuild the ID index.
  *
- * Overall: O(1) - three struct copies
+ * Overall: O(n)
  */
-/* swap */
-static void swap_students(Student *a, Student *b)
+void registry_reserve_students(StudentRegistry *r, int count)
 {
-    Student tmp = *a;
-    *a = *b;
-    *b = tmp;
+    if (count > 0)
+        grow_capacity(r, r->students_size + count);
 }
 
 /**
- * bubble_sort - Sort students using bubble sort algorithm
+ * grade_pool_alloc - Carve n grades out of the grade pool
  *
- * Time Complexity: O(n²) where n is number of students
- * Space Complexity: O(1) - in-place sorting
+ * Time Complexity: O(1) - bump-pointer allocation
+ * Space Complexity: O(GRADE_POOL_CHUNK) when a new chunk is needed
  *
  * Complexity Analysis:
- * 1. Outer loop - runs (n-1) times
- * 2. Inner loop - runs (n-1-i) times for iteration i
- * 3. For each inner iteration:
- *    - cmp_students() - O(1)
- *    - swap_students() if needed - O(1)
- *
- * Total comparisons:
- * (n-1) + (n-2) + ... + 1 = n(n-1)/2 = O(n²)
- *
- * Best case: O(n) - already sorted (early exit with swapped flag)
- * Average case: O(n²)
- * Worst case: O(n²) - reverse sorted
+ * 1. Check room in the current chunk - O(1)
+ * 2. If full: malloc() a new chunk and push it - O(1)
+ *    - Runs larger than GRADE_POOL_CHUNK get an exactly-sized chunk
+ * 3. Bump the used counter - O(1)
  *
- * Overall: O(n²) time, O(1) space - stable sort
+ * Overall: O(1)
  */
-/* Bubble sort (stable) */
-static void bubble_sort(SortKey key)
+static GradeValue *grade_pool_alloc(StudentRegistry *r, int n)
 {
-    for (int i = 0; i < students_size - 1; ++i)
+    if (!r->grade_pool || r->grade_pool->cap - r->grade_pool->used < (size_t)n)
     {
-        bool swapped = false;
-        for (int j = 0; j < students_size - 1 - i; ++j)
+        size_t cap = (size_t)n > GRADE_POOL_CHUNK ? (size_t)n : GRADE_POOL_CHUNK;
+        GradeChunk *c = malloc(sizeof(GradeChunk) + cap * sizeof(GradeValue));
+        if (!c)
         {
-            if (cmp_students(&students[j], &students[j + 1], key) > 0)
-            {
-                swap_students(&students[j], &students[j + 1]);
-                swapped = true;
-            }
+            fprintf(stderr, "Memory allocation failed (grade pool).\n");
+            exit(EXIT_FAILURE);
         }
-        if (!swapped)
-            break;
+        INSTR_INC(INSTR_GRADE_POOL_CHUNK);
+        c->used = 0;
+        c->cap = cap;
+        c->next = r->grade_pool;
+        r->grade_pool = c;
     }
+    GradeValue *p = r->grade_pool->data + r->grade_pool->used;
+    r->grade_pool->used += (size_t)n;
+    return p;
 }
 
 /**
- * insertion_sort - Sort students using insertion sort algorithm
+ * grade_pool_release - Free every grade pool chunk
  *
- * Time Complexity: O(n²) where n is number of students
- * Space Complexity: O(1) - in-place sorting
+ * Time Complexity: O(c) where c is number of chunks
+ * Space Complexity: O(1)
  *
- * Complexity Analysis:
- * 1. Outer loop - runs from index 1 to n-1 (n-1 iterations)
- * 2. For each iteration i:
- *    - Store current student - O(1)
- *    - Inner while loop - runs up to i times
- *    - Each comparison - O(1)
- *    - Each shift - O(1)
+ * Overall: O(c) - one free() per chunk, not per student
+ */
+static void grade_pool_release(StudentRegistry *r)
+{
+    while (r->grade_pool)
+    {
+        GradeChunk *next = r->grade_pool->next;
+        free(r->grade_pool);
+        r->grade_pool = next;
+    }
+}
+
+/**
+ * cold_alloc - Take a cold record for a new student
  *
- * Total comparisons and shifts:
- * Worst case: 1 + 2 + 3 + ... + (n-1) = n(n-1)/2 = O(n²)
+ * Time Complexity: O(1)
+ * Space Complexity: O(COLD_SLAB) when a new slab is needed
  *
- * Best case: O(n) - already sorted (only comparisons, no shifts)
- * Average case: O(n²)
- * Worst case: O(n²) - reverse sorted
+ * Complexity Analysis:
+ * 1. Pop the free list - O(1): Records of deleted students
+ * 2. Otherwise bump the newest slab, malloc() another when full - O(1)
+ * 3. Start with no grades in the inline buffer and no name - O(1):
+ *    The caller arena_store()s one
  *
- * Overall: O(n²) time, O(1) space - stable sort
+ * Overall: O(1)
  */
-/* Insertion sort */
-static void insertion_sort(SortKey key)
+static StudentCold *cold_alloc(StudentRegistry *r)
 {
-    for (int i = 1; i < students_size; ++i)
+    ColdSlot *slot = r->cold_free;
+    if (slot)
+        r->cold_free = slot->next_free;
+    else
     {
-        Student keyStudent = students[i];
-        int j = i - 1;
-        while (j >= 0 && cmp_students(&students[j], &keyStudent, key) > 0)
+        if (!r->cold_slabs || r->cold_slabs->used == COLD_SLAB)
         {
-            students[j + 1] = students[j];
-            j--;
+            ColdSlab *slab = malloc(sizeof(ColdSlab));
+            if (!slab)
+            {
+                fprintf(stderr, "Memory allocation failed (student records).\n");
+                exit(EXIT_FAILURE);
+            }
+            slab->used = 0;
+            slab->next = r->cold_slabs;
+            r->cold_slabs = slab;
         }
-        students[j + 1] = keyStudent;
+        slot = &r->cold_slabs->slots[r->cold_slabs->used++];
     }
+    StudentCold *c = &slot->cold;
+    c->grades = c->inline_grades;
+    c->gradeCapacity = GRADE_INLINE;
+    c->gradeStorage = GRADES_INLINE;
+#ifdef SMS_QUANTIZED_GRADES
+    c->gradeSum = 0;
+#else
+    c->gradeSum = c->gradeSumComp = 0.0f;
+#endif
+    c->name_off = c->name_len = 0;
+    return c;
 }
 
 /**
- * merge_range - Merge two sorted subarrays
+ * cold_release - Return a deleted student's cold record for reuse
  *
- * Time Complexity: O(n) where n = right - left + 1
- * Space Complexity: O(n) for temporary arrays
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Complexity Analysis:
- * 1. Calculate sizes - O(1): n1 and n2
- * 2. Allocate temp arrays - O(1): malloc calls
- * 3. Copy to L array - O(n1): Copy n1 students
- * 4. Copy to R array - O(n2): Copy n2 students
- * 5. Merge loop - O(n1 + n2):
- *    - Compare and copy - O(1) per element
- *    - Total iterations: n1 + n2
- * 6. Copy remaining - O(n1) or O(n2) at most
- * 7. Free temp arrays - O(1)
+ * Overall: O(1) - free grades first; the record goes on the free list
+ */
+static void cold_release(StudentRegistry *r, StudentCold *c)
+{
+    ColdSlot *slot = (ColdSlot *)c;
+    slot->next_free = r->cold_free;
+    r->cold_free = slot;
+}
+
+/**
+ * cold_slabs_release - Free every cold record slab
  *
- * Total: n1 + n2 = (mid-left+1) + (right-mid) = right-left+1 = n
+ * Time Complexity: O(n / COLD_SLAB)
+ * Space Complexity: O(1)
  *
- * Overall: O(n) time, O(n) space - stable merge
+ * Overall: O(n / COLD_SLAB) - one free() per slab, not per student
  */
-/* Merge Sort (recursive) */
-static void merge_range(int left, int mid, int right, SortKey key)
+static void cold_slabs_release(StudentRegistry *r)
 {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    Student *L = malloc(n1 * sizeof(Student));
-    Student *R = malloc(n2 * sizeof(Student));
-    if (!L || !R)
+    while (r->cold_slabs)
     {
-        fprintf(stderr, "Memory allocation failed in merge.\n");
-        exit(EXIT_FAILURE);
+        ColdSlab *next = r->cold_slabs->next;
+        free(r->cold_slabs);
+        r->cold_slabs = next;
     }
-    for (int i = 0; i < n1; ++i)
-        L[i] = students[left + i];
-    for (int j = 0; j < n2; ++j)
-        R[j] = students[mid + 1 + j];
+    r->cold_free = NULL;
+}
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2)
+/**
+ * arena_reserve - Make room for need more bytes in the name arena
+ *
+ * Time Complexity: O(a) when growing where a is arena bytes, O(1) otherwise
+ * Space Complexity: O(a)
+ *
+ * Complexity Analysis:
+ * 1. Room left - O(1)
+ * 2. Double from ARENA_MIN until need fits, realloc() - O(a): Aborts
+ *    like the other core allocations, also past 4 GiB of names
+ *
+ * Overall: O(a) per growth, amortized O(1) per byte
+ */
+static void arena_reserve(StudentRegistry *r, uint32_t need)
+{
+    if (r->arena_cap - r->arena_used >= need)
+        return;
+    uint64_t cap = r->arena_cap ? r->arena_cap : ARENA_MIN;
+    while (cap - r->arena_used < need)
+        cap *= 2;
+    char *tmp = cap <= UINT32_MAX ? realloc(r->arena, (size_t)cap) : NULL;
+    if (!tmp)
     {
-        if (cmp_students(&L[i], &R[j], key) <= 0)
-        {
-            students[k++] = L[i++];
-        }
-        else
-        {
-            students[k++] = R[j++];
-        }
+        fprintf(stderr, "Memory allocation failed (name arena).\n");
+        exit(EXIT_FAILURE);
     }
-    while (i < n1)
-        students[k++] = L[i++];
-    while (j < n2)
-        students[k++] = R[j++];
-
-    free(L);
-    free(R);
+    r->arena = tmp;
+    r->arena_cap = (uint32_t)cap;
 }
 
 /**
- * merge_sort_recursive - Recursively sort using merge sort
+ * arena_store - Append a name to the arena and point a cold record at it
  *
- * Time Complexity: O(n log n) where n is number of students
- * Space Complexity: O(n) for temporary arrays + O(log n) stack
+ * Time Complexity: O(k) amortized where k ≤ NAME_LEN
+ * Space Complexity: O(k)
  *
  * Complexity Analysis:
- * 1. Base case (left >= right) - O(1)
- * 2. Divide step:
- *    - Calculate mid - O(1)
- * 3. Conquer step:
- *    - Two recursive calls on halves - T(n/2) each
- * 4. Combine step:
- *    - merge_range() - O(n)
+ * 1. strnlen() - O(k): Truncate to NAME_LEN - 1 bytes
+ * 2. arena_reserve() - O(1) amortized
+ * 3. memcpy() and zero the padding - O(k)
+ *
+ * name may point into the arena itself (another student's name); it is
+ * re-based if the arena moves. The record's old name, if any, must
+ * already be arena_release()d.
  *
- * Recurrence relation: T(n) = 2T(n/2) + O(n)
- * Solution by Master Theorem: T(n) = O(n log n)
+ * Overall: O(k) amortized
+ */
+static void arena_store(StudentRegistry *r, StudentCold *c, const char *name)
+{
+    uint32_t len = (uint32_t)strnlen(name, NAME_LEN - 1);
+    uint32_t size = NAME_STORED_SIZE(len);
+    uintptr_t p = (uintptr_t)name, base = (uintptr_t)r->arena;
+    bool inside = r->arena && p >= base && p < base + r->arena_used;
+    arena_reserve(r, size);
+    if (inside)
+        name = r->arena + (p - base);
+    char *dst = r->arena + r->arena_used;
+    memcpy(dst, name, len);
+    memset(dst + len, 0, size - len);
+    c->name_off = r->arena_used;
+    c->name_len = len;
+    r->arena_used += size;
+}
+
+/**
+ * arena_release - Count a cold record's name as arena garbage
  *
- * Recursion depth: log₂(n)
- * Space at each level: O(n) total for all merges
- * Stack space: O(log n)
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Overall: O(n log n) time, O(n) space - stable sort
+ * Overall: O(1) - the bytes are reclaimed by arena_compact()
  */
-static void merge_sort_recursive(int left, int right, SortKey key)
+static void arena_release(StudentRegistry *r, const StudentCold *c)
 {
-    if (left >= right)
-        return;
-    int mid = left + (right - left) / 2;
-    merge_sort_recursive(left, mid, key);
-    merge_sort_recursive(mid + 1, right, key);
-    merge_range(left, mid, right, key);
+    r->arena_garbage += NAME_STORED_SIZE(c->name_len);
 }
 
 /**
- * sort_students - Sort students using specified method and key
+ * arena_compact - Copy the live names into a fresh, tight arena
  *
- * Time Complexity: O(n²) or O(n log n) depending on method
- * Space Complexity: O(1) or O(n) depending on method
+ * Time Complexity: O(n + a) where a is live name bytes
+ * Space Complexity: O(a) - old and new arena exist briefly together
  *
  * Complexity Analysis:
- * 1. Check for trivial case - O(1)
- * 2. Switch on method - O(1) dispatch
- * 3. Call appropriate sort:
- *    - BUBBLE: O(n²) time, O(1) space
- *    - INSERTION: O(n²) time, O(1) space
- *    - MERGE: O(n log n) time, O(n) space
+ * 1. No garbage - O(1): Nothing to do
+ * 2. malloc() the live size rounded to a power of two - O(1): On
+ *    failure the garbage simply stays
+ * 3. Copy each live student's name in slot order, re-point name_off -
+ *    O(n + a): Names end up in students[] order, so scans that print
+ *    or save them walk the arena forwards
  *
- * Overall: Depends on chosen method
+ * Overall: O(n + a)
  */
-void sort_students(SortMethod method, SortKey key)
+static void arena_compact(StudentRegistry *r)
 {
-    if (students_size <= 1)
+    if (r->arena_garbage == 0)
         return;
-    switch (method)
+    uint32_t live = r->arena_used - r->arena_garbage;
+    uint64_t cap = ARENA_MIN;
+    while (cap < live)
+        cap *= 2;
+    char *fresh = cap <= UINT32_MAX ? malloc((size_t)cap) : NULL;
+    if (!fresh)
+        return;
+    uint32_t used = 0;
+    for (int i = 0; i < r->students_size; ++i)
     {
-    case BUBBLE:
-        bubble_sort(key);
-        break;
-    case INSERTION:
-        insertion_sort(key);
-        break;
-    case MERGE:
-        merge_sort_recursive(0, students_size - 1, key);
-        break;
-    default:
-        merge_sort_recursive(0, students_size - 1, key);
-        break;
+        StudentCold *c = r->students[i].cold;
+        if (r->students[i].dead)
+            continue;
+        uint32_t size = NAME_STORED_SIZE(c->name_len);
+        memcpy(fresh + used, r->arena + c->name_off, size);
+        c->name_off = used;
+        used += size;
     }
+    free(r->arena);
+    r->arena = fresh;
+    r->arena_used = used;
+    r->arena_cap = (uint32_t)cap;
+    r->arena_garbage = 0;
 }
 
 /**
- * binary_search_by_id_recursive - Recursively search for student by ID
+ * registry_set_grade_pool_enabled - Choose pooled or malloc'ed grade storage
  *
- * Time Complexity: O(log n) where n is number of students
- * Space Complexity: O(log n) for recursion stack
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
  *
- * Complexity Analysis:
- * 1. Base case (left > right) - O(1): Not found
- * 2. Calculate mid - O(1): Arithmetic operation
- * 3. Compare with target - O(1):
- *    - If match: return immediately - O(1)
- *    - If greater: recurse on left half - T(n/2)
- *    - If less: recurse on right half - T(n/2)
+ * Affects grade runs allocated from now on; existing runs keep the
+ * storage they were allocated with.
  *
- * Recurrence relation: T(n) = T(n/2) + O(1)
- * Solution by Master Theorem: T(n) = O(log n)
+ * Overall: O(1)
+ */
+void registry_set_grade_pool_enabled(StudentRegistry *r, bool enabled)
+{
+    r->grade_pool_enabled = enabled;
+}
+
+/**
+ * registry_grade_pool_enabled - Whether new grade runs come from the pool
  *
- * Search space halves each iteration:
- * n → n/2 → n/4 → ... → 1
- * Number of steps: log₂(n)
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Stack depth: O(log n)
+ * Overall: O(1)
+ */
+bool registry_grade_pool_enabled(StudentRegistry *r)
+{
+    return r->grade_pool_enabled;
+}
+
+/**
+ * registry_set_change_hook - Be told the ID of every student that changes
  *
- * Prerequisite: Array MUST be sorted by ID
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
  *
- * Overall: O(log n) time, O(log n) space
+ * fn(id, ctx) runs after each successful add, delete, rename and grade
+ * append on r, including journal replay; bulk moves by registry_merge()
+ * and reordering (sort, compaction) do not count. NULL removes the hook.
+ *
+ * Overall: O(1)
  */
-/* Binary search by ID (recursive) - array must be sorted by ID */
-int binary_search_by_id_recursive(int target_id, int left, int right)
+void registry_set_change_hook(StudentRegistry *r, void (*fn)(int id, void *ctx), void *ctx)
 {
-    if (left > right)
-        return -1;
-    int mid = left + (right - left) / 2;
-    if (students[mid].id == target_id)
-        return mid;
-    if (students[mid].id > target_id)
-        return binary_search_by_id_recursive(target_id, left, mid - 1);
-    return binary_search_by_id_recursive(target_id, mid + 1, right);
+    r->on_change = fn;
+    r->on_change_ctx = ctx;
 }
 
 /**
- * class_highest_lowest - Find students with highest and lowest averages
+ * grade_average - Average of count grades with running sum sum
  *
- * Time Complexity: O(n) where n is number of students
- * Space Complexity: O(1) - constant extra space
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) - exact up to the final rounding in quantized builds
+ */
+#ifdef SMS_QUANTIZED_GRADES
+static float grade_average(uint64_t sum, int count)
+{
+    return count > 0 ? (float)((double)sum / ((double)count * GRADE_SCALE)) : 0.0f;
+}
+#else
+static float grade_average(float sum, int count)
+{
+    return count > 0 ? sum / (float)count : 0.0f;
+}
+#endif
+
+/**
+ * grade_sum_refresh - Recompute a cold record's running sum from its grades
+ *
+ * Time Complexity: O(g) where g is count
+ * Space Complexity: O(1)
  *
  * Complexity Analysis:
- * 1. Empty check - O(1)
- * 2. Initialize with first student - O(1):
- *    - Set highest/lowest values
- *    - Set indices to 0
- * 3. Loop through remaining students - O(n):
- *    - For each student (n-1 iterations):
- *      - Compare with highest - O(1)
- *      - Update if needed - O(1)
- *      - Compare with lowest - O(1)
- *      - Update if needed - O(1)
+ * 1. sum_grade_values() - O(g): Exact integer sum, quantized builds
+ * 2. sum_grades() - O(g): Pairwise float sum, Kahan term reset
+ *
+ * Overall: O(g)
+ */
+static void grade_sum_refresh(StudentCold *c, int count)
+{
+#ifdef SMS_QUANTIZED_GRADES
+    c->gradeSum = sum_grade_values(c->grades, count);
+#else
+    c->gradeSum = sum_grades(c->grades, count);
+    c->gradeSumComp = 0.0f;
+#endif
+}
+
+/**
+ * resize_grades - Move a student's grades into a buffer of newcap grades
+ *
+ * Time Complexity: O(g) where g is current grade count
+ * Space Complexity: O(newcap)
  *
- * Total comparisons: 2(n-1) = O(n)
+ * Complexity Analysis:
+ * 1. newcap fits GRADE_INLINE: the cold record's own buffer - O(g)
+ * 2. Heap run: realloc() - O(g)
+ * 3. Pooled run (or pool enabled): grade_pool_alloc() + memcpy() -
+ *    O(g); the old pooled run is abandoned until registry_free()
+ * 4. Inline or mapped run: copy into a new heap run - O(g)
+ * 5. Leaving a mapped run rebuilds the running sum exactly from the
+ *    copied grades, since the loader only had the stored average - O(g)
  *
- * Overall: O(n) - single pass through students
+ * Overall: O(g)
  */
-/* Stats: highest & lowest average */
-bool class_highest_lowest(float *highest, int *h_idx, float *lowest, int *l_idx)
+static void resize_grades(StudentRegistry *r, Student *s, int newcap)
 {
-    if (students_size == 0)
-        return false;
-    *highest = students[0].average;
-    *lowest = students[0].average;
-    *h_idx = *l_idx = 0;
-    for (int i = 1; i < students_size; ++i)
+    INSTR_INC(INSTR_GRADE_REALLOC);
+    StudentCold *c = s->cold;
+    unsigned char was = c->gradeStorage;
+    GradeValue *p;
+    if (newcap <= GRADE_INLINE)
     {
-        if (students[i].average > *highest)
-        {
-            *highest = students[i].average;
-            *h_idx = i;
-        }
-        if (students[i].average < *lowest)
+        p = c->inline_grades;
+        newcap = GRADE_INLINE;
+        c->gradeStorage = GRADES_INLINE;
+    }
+    else if (was == GRADES_POOLED || r->grade_pool_enabled)
+    {
+        p = grade_pool_alloc(r, newcap);
+        c->gradeStorage = GRADES_POOLED;
+    }
+    else
+    {
+        p = realloc(was == GRADES_HEAP ? c->grades : NULL, newcap * sizeof(GradeValue));
+        if (!p)
         {
-            *lowest = students[i].average;
-            *l_idx = i;
+            fprintf(stderr, "Memory allocation failed for grades.\n");
+            exit(EXIT_FAILURE);
         }
+        c->gradeStorage = GRADES_HEAP;
     }
-    return true;
+    if (!(was == GRADES_HEAP && c->gradeStorage == GRADES_HEAP) && s->gradeCount > 0)
+        memcpy(p, c->grades, s->gradeCount * sizeof(GradeValue));
+    if (was == GRADES_HEAP && c->gradeStorage != GRADES_HEAP)
+        free(c->grades);
+    c->grades = p;
+    c->gradeCapacity = newcap;
+    if (was == GRADES_MAPPED)
+        grade_sum_refresh(c, s->gradeCount);
+}
+
+/**
+ * reserve_grades - Ensure a student's grade array can hold mincap grades
+ *
+ * Time Complexity: O(g) when growing, O(1) otherwise
+ * Space Complexity: O(mincap)
+ *
+ * Complexity Analysis:
+ * 1. Capacity check - O(1): The first GRADE_INLINE grades never
+ *    allocate
+ * 2. Calculate new capacity - O(log g): Doubling from GRADE_INLINE
+ * 3. resize_grades() - O(g): Only when capacity is exceeded
+ *
+ * Amortized Analysis:
+ * - Doubling means g appends cause O(log g) reallocations and
+ *   2 × GRADE_INLINE + ... + g ≈ 2g copied floats in total
+ * - Amortized cost per appended grade: O(1)
+ *
+ * Overall: O(g) per growth, amortized O(1) per grade
+ */
+static void reserve_grades(StudentRegistry *r, Student *s, int mincap)
+{
+    if (mincap <= s->cold->gradeCapacity)
+        return;
+    int newcap = s->cold->gradeCapacity < GRADE_INLINE ? GRADE_INLINE : s->cold->gradeCapacity;
+    while (newcap < mincap)
+        newcap *= 2;
+    resize_grades(r, s, newcap);
 }
 
 /**
- * students_count - Get the current number of students
+ * free_grades - Release a student's grade array
  *
  * Time Complexity: O(1) - constant time
- * Space Complexity: O(1) - no extra space
+ * Space Complexity: O(1)
+ *
+ * Leaves the student with no grades in its inline buffer.
+ *
+ * Overall: O(1) - pooled and mapped runs are reclaimed with their backing
+ */
+static void free_grades(Student *s)
+{
+    StudentCold *c = s->cold;
+    if (c->gradeStorage == GRADES_HEAP)
+        free(c->grades);
+    c->grades = c->inline_grades;
+    c->gradeCapacity = GRADE_INLINE;
+    c->gradeStorage = GRADES_INLINE;
+    s->gradeCount = 0;
+}
+
+/**
+ * registry_adopt_grade_mapping - Take ownership of a region mapped grade runs point into
+ *
+ * Time Complexity: O(1) - push onto a list
+ * Space Complexity: O(1)
  *
  * Complexity Analysis:
- * 1. Return stored size value - O(1)
+ * 1. malloc() one list node - O(1)
+ * 2. Push it - O(1)
  *
- * Overall: O(1) - simple accessor
+ * release(base, size) runs in registry_free(), after every student is
+ * gone. If the node cannot be allocated the region is simply kept.
+ *
+ * Overall: O(1)
  */
-/* Accessors */
-int students_count(void) { return students_size; }
+void registry_adopt_grade_mapping(StudentRegistry *r, void *base, size_t size, void (*release)(void *base, size_t size))
+{
+    GradeMapping *m = malloc(sizeof(GradeMapping));
+    if (!m)
+        return;
+    m->base = base;
+    m->size = size;
+    m->release = release;
+    m->next = r->grade_mappings;
+    r->grade_mappings = m;
+}
+
+/**
+ * grade_mappings_release - Release every adopted snapshot mapping
+ *
+ * Time Complexity: O(m) where m is number of mappings
+ * Space Complexity: O(1)
+ *
+ * Overall: O(m)
+ */
+static void grade_mappings_release(StudentRegistry *r)
+{
+    while (r->grade_mappings)
+    {
+        GradeMapping *next = r->grade_mappings->next;
+        r->grade_mappings->release(r->grade_mappings->base, r->grade_mappings->size);
+        free(r->grade_mappings);
+        r->grade_mappings = next;
+    }
+}
 
 /**
- * get_student_by_index - Get pointer to student at given index
+ * registry_init - Initialize an empty registry
  *
  * Time Complexity: O(1) - constant time
- * Space Complexity: O(1) - no extra space
+ * Space Complexity: O(1) - no allocation
  *
  * Complexity Analysis:
- * 1. Bounds check - O(1): Two comparisons
- * 2. Array access - O(1): Direct indexing
- * 3. Return address - O(1)
+ * 1. Set students pointer to NULL - O(1)
+ * 2. Set capacity to 0 - O(1)
+ * 3. Set size to 0 - O(1)
+ * 4. Clear indexes, pool, mappings, cold slabs, histograms and sort
+ *    buffers - O(1)
  *
- * Overall: O(1) - direct array access
+ * Does not free anything; use registry_free() on a registry in use.
+ * The grade pool setting and change hook are configuration and are kept.
+ *
+ * Overall: O(1) - simple initialization
  */
-Student *get_student_by_index(int idx)
+void registry_init(StudentRegistry *r)
 {
-    if (idx < 0 || idx >= students_size)
-        return NULL;
-    return &students[idx];
+    r->students = NULL;
+    r->students_capacity = r->students_size = 0;
+    r->students_dead = 0;
+    r->col_id = r->col_grade_count = NULL;
+    r->col_avg = NULL;
+    r->id_index = NULL;
+    r->id_index_capacity = 0;
+    r->grade_pool = NULL;
+    r->grade_mappings = NULL;
+    r->cold_slabs = NULL;
+    r->cold_free = NULL;
+    r->arena = NULL;
+    r->arena_used = r->arena_cap = r->arena_garbage = 0;
+    name_index_init(&r->names);
+    memset(&r->grade_hist, 0, sizeof(r->grade_hist));
+    memset(&r->avg_hist, 0, sizeof(r->avg_hist));
+    r->grade_hist_stale = false;
+    r->sort_pairs = r->sort_scratch = NULL;
+    r->sort_buf_capacity = 0;
+    r->dirty_ids = NULL;
+    r->dirty_len = r->dirty_cap = 0;
+    r->dirty_overflow = false;
+}
+
+/**
+ * notify_change - Run the change hook, if any, for one ID
+ *
+ * Time Complexity: O(1) plus the hook
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void notify_change(StudentRegistry *r, int id)
+{
+    if (r->on_change)
+        r->on_change(id, r->on_change_ctx);
+}
+
+/**
+ * mark_dirty - Set a student's dirty bit and list its ID once
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1) amortized - the ID list grows geometrically
+ *
+ * Complexity Analysis:
+ * 1. Tracking off, or bit already set - O(1): Nothing to record
+ * 2. Grow dirty_ids by doubling when full - O(d) per growth; if that
+ *    fails, fall back to dirty_overflow
+ * 3. Append the ID - O(1)
+ *
+ * Overall: O(1) amortized
+ */
+static void mark_dirty(StudentRegistry *r, Student *s)
+{
+    if (!r->track_dirty || s->dirty)
+        return;
+    s->dirty = 1;
+    if (r->dirty_overflow)
+        return;
+    if (r->dirty_len == r->dirty_cap)
+    {
+        int cap = r->dirty_cap ? r->dirty_cap * 2 : 256;
+        int *ids = realloc(r->dirty_ids, (size_t)cap * sizeof(int));
+        if (!ids)
+        {
+            r->dirty_overflow = true;
+            return;
+        }
+        r->dirty_ids = ids;
+        r->dirty_cap = cap;
+    }
+    r->dirty_ids[r->dirty_len++] = s->id;
+}
+
+/**
+ * registry_free - Free all allocated memory for students
+ *
+ * Time Complexity: O(n) where n is number of students
+ * Space Complexity: O(1) - only frees memory, doesn't allocate
+ *
+ * Complexity Analysis:
+ * 1. Loop through students - O(n): Iterate n times
+ * 2. For each live student:
+ *    - free_grades() - O(1): Free heap grades, skip pooled runs
+ * 3. grade_pool_release() - O(c): Free all pool chunks at once,
+ *    grade_mappings_release() - O(m): Unmap adopted snapshots,
+ *    cold_slabs_release() - O(n / COLD_SLAB): Names and inline grades
+ * 4. free(students) - O(1): Free main array pointer
+ * 5. free() columns - O(1): Free the columnar mirror
+ * 6. free(id_index) - O(1): Free ID hash index
+ * 7. free(sort_pairs) - O(1): Free reusable sort buffers,
+ *    name_index_reset() - O(1): Free the name index and the name arena
+ * 8. Reset variables and histograms - O(1): Set to NULL/0
+ *
+ * Overall: O(n) - must free each student's grades individually
+ */
+void registry_free(StudentRegistry *r)
+{
+    for (int i = 0; i < r->students_size; ++i)
+        if (!r->students[i].dead)
+            free_grades(&r->students[i]);
+    grade_pool_release(r);
+    grade_mappings_release(r);
+    cold_slabs_release(r);
+    free(r->students);
+    r->students = NULL;
+    r->students_capacity = r->students_size = 0;
+    r->students_dead = 0;
+    free(r->col_id);
+    free(r->col_avg);
+    free(r->col_grade_count);
+    r->col_id = r->col_grade_count = NULL;
+    r->col_avg = NULL;
+    free(r->id_index);
+    r->id_index = NULL;
+    r->id_index_capacity = 0;
+    free(r->sort_pairs);
+    r->sort_pairs = r->sort_scratch = NULL;
+    r->sort_buf_capacity = 0;
+    name_index_reset(&r->names);
+    free(r->arena);
+    r->arena = NULL;
+    r->arena_used = r->arena_cap = r->arena_garbage = 0;
+    memset(&r->grade_hist, 0, sizeof(r->grade_hist));
+    memset(&r->avg_hist, 0, sizeof(r->avg_hist));
+    r->grade_hist_stale = false;
+    free(r->dirty_ids);
+    r->dirty_ids = NULL;
+    r->dirty_len = r->dirty_cap = 0;
+    r->dirty_overflow = false;
+}
+
+/**
+ * registry_create - Allocate a new, empty registry
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1) - one StudentRegistry
+ *
+ * Complexity Analysis:
+ * 1. calloc() - O(1): Grade pool off
+ * 2. registry_init() - O(1)
+ *
+ * Overall: O(1) - returns NULL if out of memory
+ */
+StudentRegistry *registry_create(void)
+{
+    StudentRegistry *r = calloc(1, sizeof(StudentRegistry));
+    if (r)
+        registry_init(r);
+    return r;
+}
+
+/**
+ * registry_destroy - Free a registry from registry_create() and its contents
+ *
+ * Time Complexity: O(n) - see registry_free()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(n)
+ */
+void registry_destroy(StudentRegistry *r)
+{
+    if (!r)
+        return;
+    registry_free(r);
+    free(r);
+}
+
+/**
+ * default_registry - The instance used by the functions without a handle
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+StudentRegistry *default_registry(void)
+{
+    return &default_instance;
+}
+
+/**
+ * index_of_id - Find the index of a student by ID (hash lookup)
+ *
+ * Time Complexity: O(1) expected
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. Empty index check - O(1)
+ * 2. id_hash() - O(1): Compute home bucket
+ * 3. Linear probe - O(1) expected: Load factor <= 0.5
+ *    - Compare bucket's ID - O(1)
+ *    - Stop at empty bucket - O(1): ID not present
+ *
+ * Works regardless of the current order of students[].
+ *
+ * Overall: O(1) expected
+ */
+/* return index of student with id or -1 */
+static int index_of_id(StudentRegistry *r, int id)
+{
+    INSTR_INC(INSTR_ID_LOOKUP);
+    if (r->id_index_capacity == 0)
+        return -1;
+    int mask = r->id_index_capacity - 1;
+    int b = id_hash(r, id);
+    int probes = 1;
+    while (r->id_index[b].slot != -1)
+    {
+        if (r->id_index[b].id == id)
+            break;
+        b = (b + 1) & mask;
+        probes++;
+    }
+    INSTR_ADD(INSTR_ID_PROBE, probes);
+    return r->id_index[b].slot;
+}
+
+/**
+ * registry_add_student - Add a new student (no duplicate IDs allowed)
+ *
+ * Time Complexity: O(1) amortized expected
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() - O(1) expected: Check for duplicate ID
+ * 2. ensure_capacity() - Amortized O(1): Dynamic array expansion
+ * 3. Initialize student fields:
+ *    - Set id - O(1)
+ *    - cold_alloc() - O(1): Cold record with the inline grade buffer
+ *    - arena_store() - O(k) amortized where k ≤ NAME_LEN: Append the
+ *      name to the arena
+ *    - Initialize other fields - O(1)
+ * 4. Increment size - O(1)
+ * 5. id_index_put() - O(1) expected: Register new slot
+ * 6. col_store() - O(1): Mirror the new slot into the columns,
+ *    hist_add() - O(1): Count the 0 average
+ * 7. name_index_insert() - O(1): Bounded delta insert once the name
+ *    index has been built, nothing before
+ * 8. mark_dirty() + notify_change() - O(1)
+ *
+ * Overall: O(1) amortized expected
+ */
+/* Add a student (no duplicate id), initialize grade array */
+bool registry_add_student(StudentRegistry *r, int id, const char *name)
+{
+    if (index_of_id(r, id) != -1)
+        return false; /* duplicate id */
+    ensure_capacity(r);
+    Student *s = &r->students[r->students_size++];
+    s->id = id;
+    s->cold = cold_alloc(r);
+    arena_store(r, s->cold, name ? name : "");
+    s->gradeCount = 0;
+    s->dead = 0;
+    s->dirty = 0;
+    s->average = 0.0f;
+    id_index_put(r, id, r->students_size - 1);
+    col_store(r, r->students_size - 1);
+    hist_add(&r->avg_hist, 0.0f, 1);
+    name_index_insert(&r->names, id, r->arena + s->cold->name_off);
+    mark_dirty(r, s);
+    notify_change(r, id);
+    return true;
+}
+
+/**
+ * add_student_sized - Add a student with room for exactly count grades
+ *
+ * Time Complexity: O(1) amortized expected
+ * Space Complexity: O(g) for the grades array
+ *
+ * Complexity Analysis:
+ * 1. add_student() - O(1) amortized expected: Duplicate check and insert
+ * 2. resize_grades() - O(1): One exactly-sized allocation (heap or
+ *    pool), none for up to GRADE_INLINE grades
+ *
+ * The caller fills the count grades, then calls finish_student_grades().
+ * Returns NULL for a duplicate ID.
+ *
+ * Overall: O(1) amortized expected
+ */
+static Student *add_student_sized(StudentRegistry *r, int id, const char *name, int count)
+{
+    if (!registry_add_student(r, id, name))
+        return NULL;
+    Student *s = &r->students[r->students_size - 1];
+    if (count > s->cold->gradeCapacity)
+        resize_grades(r, s, count);
+    s->gradeCount = count;
+    return s;
+}
+
+/**
+ * finish_student_grades - Average and histogram a freshly filled student
+ *
+ * Time Complexity: O(g)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. recalc_average() - O(g): Average computed once per record
+ * 2. hist_count_grades() - O(g): Bucket each grade
+ *
+ * Overall: O(g)
+ */
+static void finish_student_grades(StudentRegistry *r, Student *s)
+{
+    if (s->gradeCount == 0)
+        return;
+    registry_recalc_average(r, s);
+    hist_count_grades(r, s->cold->grades, s->gradeCount, 1);
+}
+
+/**
+ * registry_add_student_with_grade_values - Add a student with grades already in stored form
+ *
+ * Time Complexity: O(g) amortized expected where g is count
+ * Space Complexity: O(g) for the grades array
+ *
+ * Complexity Analysis:
+ * 1. add_student_sized() - O(1) amortized expected
+ * 2. memcpy() - O(g): Copy grades in one block
+ * 3. finish_student_grades() - O(g)
+ *
+ * Bulk-insert path for loaders: no per-grade ID lookup, no per-grade
+ * realloc, no conversion and no per-grade average recomputation.
+ *
+ * Overall: O(g) amortized expected
+ */
+bool registry_add_student_with_grade_values(StudentRegistry *r, int id, const char *name, const GradeValue *grades,
+                                            int count)
+{
+    if (count < 0)
+        count = 0;
+    Student *s = add_student_sized(r, id, name, count);
+    if (!s)
+        return false;
+    if (count > 0)
+        memcpy(s->cold->grades, grades, count * sizeof(GradeValue));
+    finish_student_grades(r, s);
+    return true;
+}
+
+/**
+ * registry_add_student_with_grades - Add a student together with all of its grades
+ *
+ * Time Complexity: O(g) amortized expected where g is count
+ * Space Complexity: O(g) for the grades array
+ *
+ * Complexity Analysis:
+ * 1. add_student_sized() - O(1) amortized expected
+ * 2. grade_quantize() each grade into the run - O(g): A plain copy
+ *    unless built with SMS_QUANTIZED_GRADES
+ * 3. finish_student_grades() - O(g)
+ *
+ * Overall: O(g) amortized expected
+ */
+bool registry_add_student_with_grades(StudentRegistry *r, int id, const char *name, const float *grades, int count)
+{
+    if (count < 0)
+        count = 0;
+    Student *s = add_student_sized(r, id, name, count);
+    if (!s)
+        return false;
+    for (int i = 0; i < count; ++i)
+        s->cold->grades[i] = grade_quantize(grades[i]);
+    finish_student_grades(r, s);
+    return true;
+}
+
+/**
+ * registry_add_student_with_mapped_grades - Add a student whose grades stay in a snapshot
+ *
+ * Time Complexity: O(1) amortized expected
+ * Space Complexity: O(1) - the grades are not copied
+ *
+ * Complexity Analysis:
+ * 1. add_student() - O(1) amortized expected: Duplicate check and insert
+ * 2. Point grades at the caller's run - O(1): No copy, no read
+ * 3. Take the stored average - O(1): The grade pages are not touched,
+ *    so they are only faulted in once something reads them; the
+ *    grade histogram is marked for a recount on its next query
+ *
+ * The run must stay valid until registry_free(); pass its region to
+ * adopt_grade_mapping(). The first append copies it to the heap.
+ *
+ * Overall: O(1) amortized expected
+ */
+bool registry_add_student_with_mapped_grades(StudentRegistry *r, int id, const char *name, const GradeValue *grades,
+                                             int count, float average)
+{
+    if (!registry_add_student(r, id, name))
+        return false;
+    if (count <= 0)
+        return true;
+    int idx = r->students_size - 1;
+    Student *s = &r->students[idx];
+    s->cold->grades = (GradeValue *)grades;
+    s->gradeCount = s->cold->gradeCapacity = count;
+    s->cold->gradeStorage = GRADES_MAPPED;
+    s->average = average;
+#ifdef SMS_QUANTIZED_GRADES
+    s->cold->gradeSum = (uint64_t)((double)average * count * GRADE_SCALE + 0.5);
+#else
+    s->cold->gradeSum = average * (float)count;
+#endif
+    col_store(r, idx);
+    hist_move_average(r, 0.0f, average);
+    r->grade_hist_stale = true;
+    return true;
+}
+
+/**
+ * registry_delete_student - Delete a student by ID
+ *
+ * Time Complexity: O(1) amortized expected, O(log n) once the name index is built
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() - O(1) expected: Hash lookup for student
+ * 2. id_index_remove() - O(1) expected: Drop ID from index,
+ *    name_index_remove() - O(log n): Drop the name entry
+ * 3. Count the average and grades out of the histograms - O(g)
+ * 4. free_grades() + arena_release() + cold_release() - O(1): Free
+ *    grades array, leave the name as arena garbage and recycle the
+ *    cold record
+ * 5. Mark the slot dead - O(1): Nothing after it moves
+ * 6. Drop trailing tombstones - O(1) amortized: Each slot is popped once
+ * 7. compact_students() once TOMBSTONE_COMPACT_PERCENT of the slots are
+ *    dead - O(n), but at least n × TOMBSTONE_COMPACT_PERCENT / 100
+ *    deletes happen between compactions, so O(1) amortized per delete
+ * 8. mark_dirty() + notify_change() - O(1)
+ *
+ * A purge of k students costs O(k + n) instead of O(k × n).
+ *
+ * Overall: O(g) amortized expected, O(1) apart from uncounting grades
+ */
+/* Delete student by id */
+bool registry_delete_student(StudentRegistry *r, int id)
+{
+    int idx = index_of_id(r, id);
+    if (idx == -1)
+        return false;
+    id_index_remove(r, id);
+    name_index_remove(&r->names, id, r->arena + r->students[idx].cold->name_off);
+    mark_dirty(r, &r->students[idx]);
+    hist_add(&r->avg_hist, r->students[idx].average, -1);
+    hist_count_grades(r, r->students[idx].cold->grades, r->students[idx].gradeCount, -1);
+    free_grades(&r->students[idx]);
+    arena_release(r, r->students[idx].cold);
+    cold_release(r, r->students[idx].cold);
+    r->students[idx].cold = NULL;
+    r->students[idx].dead = 1;
+    r->students_dead++;
+    while (r->students_size > 0 && r->students[r->students_size - 1].dead)
+    {
+        r->students_size--;
+        r->students_dead--;
+    }
+    if (r->students_dead >= TOMBSTONE_COMPACT_MIN &&
+        (long long)r->students_dead * 100 >= (long long)r->students_size * TOMBSTONE_COMPACT_PERCENT)
+        registry_compact_students(r);
+    notify_change(r, id);
+    return true;
+}
+
+/**
+ * registry_compact_students - Pack the live students over the tombstones
+ *
+ * Time Complexity: O(n) where n is number of slots
+ * Space Complexity: O(1) - in place
+ *
+ * Complexity Analysis:
+ * 1. No tombstones - O(1): Nothing to do
+ * 2. Find the first tombstone - O(n)
+ * 3. Slide every later live student down - O(n): One 24-byte hot
+ *    record copy each, relative order is kept; cold records stay put
+ * 4. id_index_reassign() + col_store_from() - O(n): Re-point and
+ *    re-mirror the slots that moved
+ * 5. arena_compact() - O(n + a): Reclaim names of deleted and renamed
+ *    students
+ *
+ * Slot indices and name pointers held by callers are invalid afterwards.
+ *
+ * Overall: O(n)
+ */
+void registry_compact_students(StudentRegistry *r)
+{
+    if (r->students_dead == 0)
+        return;
+    int first = 0;
+    while (!r->students[first].dead)
+        first++;
+    int j = first;
+    for (int i = first + 1; i < r->students_size; ++i)
+        if (!r->students[i].dead)
+            r->students[j++] = r->students[i];
+    r->students_size = j;
+    r->students_dead = 0;
+    id_index_reassign(r, first);
+    col_store_from(r, first);
+    arena_compact(r);
+}
+
+/**
+ * registry_shrink_students_to_fit - Return unused slot capacity after a purge
+ *
+ * Time Complexity: O(n) where n is number of students
+ * Space Complexity: O(n) - the arrays shrink to exactly n
+ *
+ * Complexity Analysis:
+ * 1. compact_students() + arena_compact() - O(n + a): Also drops
+ *    names replaced by renames when no student was deleted
+ * 2. Free the sort buffers - O(1): They only ever grow
+ * 3. realloc() students[] and the columns down to n - O(n)
+ * 4. id_index_rebuild() - O(n): Table sized for the new capacity
+ *
+ * Grade runs of deleted students were freed by delete_student(),
+ * except pooled runs, which stay with the pool until registry_free().
+ *
+ * Overall: O(n)
+ */
+void registry_shrink_students_to_fit(StudentRegistry *r)
+{
+    registry_compact_students(r);
+    arena_compact(r);
+    free(r->sort_pairs);
+    r->sort_pairs = r->sort_scratch = NULL;
+    r->sort_buf_capacity = 0;
+    if (r->students_size == r->students_capacity)
+        return;
+    if (r->students_size == 0)
+    {
+        free(r->students);
+        free(r->col_id);
+        free(r->col_avg);
+        free(r->col_grade_count);
+        free(r->id_index);
+        r->students = NULL;
+        r->col_id = r->col_grade_count = NULL;
+        r->col_avg = NULL;
+        r->id_index = NULL;
+        r->students_capacity = r->id_index_capacity = 0;
+        return;
+    }
+    Student *tmp = realloc(r->students, r->students_size * sizeof(Student));
+    if (!tmp)
+        return; /* keep the larger block */
+    r->students = tmp;
+    r->students_capacity = r->students_size;
+    r->col_id = grow_column(r->col_id, r->students_capacity, sizeof(int));
+    r->col_avg = grow_column(r->col_avg, r->students_capacity, sizeof(float));
+    r->col_grade_count = grow_column(r->col_grade_count, r->students_capacity, sizeof(int));
+    id_index_rebuild(r);
+}
+
+/**
+ * registry_merge - Move every student of src into dst
+ *
+ * Time Complexity: O(n_src) expected, plus one O(n_dst) growth
+ * Space Complexity: O(n_dst + n_src) for dst's arrays and index
+ *
+ * Complexity Analysis:
+ * 1. grow_capacity() once for all incoming students - O(n_dst + n_src)
+ * 2. Splice src's cold slabs and free records onto dst's - O(n / COLD_SLAB
+ *    + f): Cold records, with their inline grades, stay put; append
+ *    src's name arena to dst's with one memcpy() - O(a_src)
+ * 3. Per live src student - O(1) expected:
+ *    - index_of_id() in dst: an ID dst already holds is dropped
+ *    - copy the hot record, which carries its cold handle along, and
+ *      shift its name offset by where src's arena landed
+ *    - id_index_put(), col_store(), name_index_insert()
+ * 4. Splice src's grade pool chunks and snapshot mappings onto dst's
+ *    lists - O(c + m): Pooled and mapped runs keep their backing
+ * 5. hist_merge() both histograms - O(HIST_BUCKETS): Dropped students
+ *    are counted back out, grades in O(g)
+ * 6. registry_free() on the emptied src - O(1) per array
+ *
+ * No grade is copied, so merging registries loaded on separate threads
+ * costs O(n) rather than a second load. src is left empty and usable;
+ * the change hook does not run and nothing is marked dirty. Returns the
+ * number of students dropped.
+ *
+ * Overall: O(n_src) expected
+ */
+int registry_merge(StudentRegistry *dst, StudentRegistry *src)
+{
+    grow_capacity(dst, dst->students_size + src->students_size - src->students_dead);
+    ColdSlab **slab = &dst->cold_slabs;
+    while (*slab)
+        slab = &(*slab)->next;
+    *slab = src->cold_slabs;
+    src->cold_slabs = NULL;
+    ColdSlot **spare = &dst->cold_free;
+    while (*spare)
+        spare = &(*spare)->next_free;
+    *spare = src->cold_free;
+    src->cold_free = NULL;
+    uint32_t base = dst->arena_used;
+    if (src->arena_used > 0)
+    {
+        arena_reserve(dst, src->arena_used);
+        memcpy(dst->arena + base, src->arena, src->arena_used);
+        dst->arena_used += src->arena_used;
+        dst->arena_garbage += src->arena_garbage;
+    }
+    hist_merge(&dst->grade_hist, &src->grade_hist);
+    hist_merge(&dst->avg_hist, &src->avg_hist);
+    dst->grade_hist_stale = dst->grade_hist_stale || src->grade_hist_stale;
+
+    int dropped = 0;
+    for (int i = 0; i < src->students_size; ++i)
+    {
+        Student *s = &src->students[i];
+        if (s->dead)
+            continue;
+        if (index_of_id(dst, s->id) != -1)
+        {
+            hist_add(&dst->avg_hist, s->average, -1);
+            hist_count_grades(dst, s->cold->grades, s->gradeCount, -1);
+            free_grades(s);
+            arena_release(dst, s->cold);
+            cold_release(dst, s->cold);
+            dropped++;
+            continue;
+        }
+        int slot = dst->students_size++;
+        dst->students[slot] = *s;
+        dst->students[slot].dirty = 0;
+        s->cold->name_off += base;
+        id_index_put(dst, s->id, slot);
+        col_store(dst, slot);
+        name_index_insert(&dst->names, s->id, dst->arena + s->cold->name_off);
+    }
+
+    GradeChunk **chunk = &dst->grade_pool;
+    while (*chunk)
+        chunk = &(*chunk)->next;
+    *chunk = src->grade_pool;
+    src->grade_pool = NULL;
+    GradeMapping **map = &dst->grade_mappings;
+    while (*map)
+        map = &(*map)->next;
+    *map = src->grade_mappings;
+    src->grade_mappings = NULL;
+
+    src->students_size = src->students_dead = 0;
+    registry_free(src);
+    return dropped;
+}
+
+/**
+ * registry_clone - Copy src's live students into a new registry
+ *
+ * Time Complexity: O(n + G) where G is the grades not in a mapping
+ * Space Complexity: O(n + G) for the copy
+ *
+ * Complexity Analysis:
+ * 1. registry_create() and grow_capacity() for the live count - O(n)
+ * 2. Count the grades to copy that do not fit inline - O(n)
+ * 3. grade_pool_alloc() them as one run - O(1): A single chunk backs
+ *    every copied grade, so the copy costs one malloc() not n
+ * 4. memcpy() the name arena as is - O(a): Name offsets stay valid
+ * 5. Per live student - O(1 + g):
+ *    - copy the hot record and cold_alloc() a copy of the cold one;
+ *      tombstones are left behind
+ *    - memcpy() short runs inline, longer heap and pooled runs into
+ *      the shared run
+ *    - id_index_put(), col_store()
+ * 6. Copy the dirty ID list - O(d): The clone can be saved
+ *    incrementally; dirty bits come along with the structs
+ * 7. Copy both histograms - O(HIST_BUCKETS)
+ *
+ * Mapped runs are shared, not copied: src keeps the mapping until its
+ * registry_free(), so the clone must be destroyed first. The clone has
+ * no change hook, no grade pool setting, no dirty tracking and an
+ * unbuilt name index, and
+ * never aliases a grade array src may resize or free. Returns NULL if
+ * out of memory.
+ *
+ * Overall: O(n + G) - memcpy() speed, no formatting or hashing of grades
+ */
+StudentRegistry *registry_clone(StudentRegistry *src)
+{
+    StudentRegistry *r = registry_create();
+    if (!r)
+        return NULL;
+    grow_capacity(r, src->students_size - src->students_dead);
+    size_t total = 0;
+    for (int i = 0; i < src->students_size; ++i)
+    {
+        const Student *s = &src->students[i];
+        if (!s->dead && s->cold->gradeStorage != GRADES_MAPPED && s->gradeCount > GRADE_INLINE)
+            total += (size_t)s->gradeCount;
+    }
+    GradeValue *run = total > 0 ? grade_pool_alloc(r, (int)total) : NULL;
+    if (src->arena_used > 0)
+    {
+        arena_reserve(r, src->arena_used);
+        memcpy(r->arena, src->arena, src->arena_used);
+        r->arena_used = src->arena_used;
+        r->arena_garbage = src->arena_garbage;
+    }
+    for (int i = 0; i < src->students_size; ++i)
+    {
+        const Student *s = &src->students[i];
+        if (s->dead)
+            continue;
+        int slot = r->students_size++;
+        Student *c = &r->students[slot];
+        *c = *s;
+        c->cold = cold_alloc(r);
+        *c->cold = *s->cold;
+        bool mapped = s->cold->gradeStorage == GRADES_MAPPED; /* shared with src */
+        if (!mapped && s->gradeCount <= GRADE_INLINE)
+        {
+            c->cold->grades = c->cold->inline_grades;
+            c->cold->gradeCapacity = GRADE_INLINE;
+            c->cold->gradeStorage = GRADES_INLINE;
+            memcpy(c->cold->inline_grades, s->cold->grades, (size_t)s->gradeCount * sizeof(GradeValue));
+        }
+        else if (!mapped)
+        {
+            c->cold->grades = run;
+            c->cold->gradeCapacity = s->gradeCount;
+            c->cold->gradeStorage = GRADES_POOLED;
+            memcpy(run, s->cold->grades, (size_t)s->gradeCount * sizeof(GradeValue));
+            run += s->gradeCount;
+        }
+        id_index_put(r, c->id, slot);
+        col_store(r, slot);
+    }
+    r->grade_hist = src->grade_hist;
+    r->avg_hist = src->avg_hist;
+    r->grade_hist_stale = src->grade_hist_stale;
+    r->dirty_overflow = src->dirty_overflow;
+    if (src->dirty_len > 0 && !r->dirty_overflow)
+    {
+        r->dirty_ids = malloc((size_t)src->dirty_len * sizeof(int));
+        if (r->dirty_ids)
+        {
+            memcpy(r->dirty_ids, src->dirty_ids, (size_t)src->dirty_len * sizeof(int));
+            r->dirty_len = r->dirty_cap = src->dirty_len;
+        }
+        else
+            r->dirty_overflow = true;
+    }
+    return r;
+}
+
+/**
+ * registry_set_dirty_tracking - Start or stop recording changed students
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * While on, each successful add, delete, rename and grade append sets
+ * the student's dirty bit and lists its ID once, for incremental saves.
+ * Like the change hook this is configuration and survives
+ * registry_free(); students loaded before tracking starts are clean.
+ *
+ * Overall: O(1)
+ */
+void registry_set_dirty_tracking(StudentRegistry *r, bool enabled)
+{
+    r->track_dirty = enabled;
+}
+
+/**
+ * registry_dirty_ids - IDs changed since the last registry_clear_dirty()
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1) - points at the registry's own list
+ *
+ * Order is first change first. A deleted ID stays listed (it no longer
+ * resolves), and an ID deleted and added again may appear twice.
+ * Returns -1 when the list overflowed and every student must be
+ * treated as dirty. The list is valid until the next change.
+ *
+ * Overall: O(1)
+ */
+int registry_dirty_ids(StudentRegistry *r, const int **ids)
+{
+    *ids = r->dirty_ids;
+    return r->dirty_overflow ? -1 : r->dirty_len;
+}
+
+/**
+ * registry_clear_dirty - Forget recorded changes after they were saved
+ *
+ * Time Complexity: O(d) expected where d is listed IDs; O(n) after an
+ *                  overflow
+ * Space Complexity: O(1) - the list keeps its capacity
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() per listed ID - O(1) expected: Clear the live
+ *    student's bit; deleted IDs have nothing to clear
+ * 2. After an overflow, clear every slot's bit instead - O(n)
+ *
+ * Overall: O(d) expected
+ */
+void registry_clear_dirty(StudentRegistry *r)
+{
+    if (r->dirty_overflow)
+    {
+        for (int i = 0; i < r->students_size; ++i)
+            r->students[i].dirty = 0;
+    }
+    else
+    {
+        for (int i = 0; i < r->dirty_len; ++i)
+        {
+            int idx = index_of_id(r, r->dirty_ids[i]);
+            if (idx != -1)
+                r->students[idx].dirty = 0;
+        }
+    }
+    r->dirty_len = 0;
+    r->dirty_overflow = false;
+}
+
+/**
+ * registry_update_student_name - Update a student's name
+ *
+ * Time Complexity: O(log n) amortized expected
+ * Space Complexity: O(k) - the new name's arena bytes
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() - O(1) expected: Hash lookup for student
+ * 2. arena_release() + arena_store() - O(k) amortized where k ≤ NAME_LEN:
+ *    The new name is appended; the old one becomes garbage
+ * 3. name_index_remove() + name_index_insert() - O(log n): Re-key the
+ *    name entry
+ * 4. arena_compact() once garbage is half the arena (and at least
+ *    ARENA_GARBAGE_MIN bytes) - O(n + a), but only after renames
+ *    replaced that many bytes, so O(k) amortized
+ * 5. mark_dirty() + notify_change() - O(1)
+ *
+ * Overall: O(log n) amortized expected
+ */
+/* Update name */
+bool registry_update_student_name(StudentRegistry *r, int id, const char *newname)
+{
+    int idx = index_of_id(r, id);
+    if (idx == -1)
+        return false;
+    StudentCold *c = r->students[idx].cold;
+    name_index_remove(&r->names, id, r->arena + c->name_off);
+    arena_release(r, c);
+    arena_store(r, c, newname);
+    name_index_insert(&r->names, id, r->arena + c->name_off);
+    if (r->arena_garbage >= ARENA_GARBAGE_MIN && r->arena_garbage * 2 >= r->arena_used)
+        arena_compact(r);
+    mark_dirty(r, &r->students[idx]);
+    notify_change(r, id);
+    return true;
+}
+
+/**
+ * registry_add_grades_to_student - Append a run of grades to one student
+ *
+ * Time Complexity: O(c) amortized expected where c is count
+ * Space Complexity: O(g) for storing grades
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() - O(1) expected: One hash lookup for the whole run
+ * 2. reserve_grades() - Amortized O(1): At most one geometric growth
+ * 3. Append grades - O(c): Assign values
+ * 4. Update running sum - O(c): Kahan-compensated addition keeps the
+ *    float error bounded independent of g; quantized builds add the
+ *    integer hundredths, which is exact
+ * 5. Update average - O(1): gradeSum / gradeCount, once per run
+ * 6. col_store() - O(1): Mirror the new count and average
+ * 7. Histograms - O(c): Bucket the new grades, move the average
+ * 8. mark_dirty() + notify_change() - O(1)
+ *
+ * Overall: O(c) amortized expected
+ */
+bool registry_add_grades_to_student(StudentRegistry *r, int id, const float *grades, int count)
+{
+    int idx = index_of_id(r, id);
+    if (idx == -1)
+        return false;
+    if (count <= 0)
+        return true;
+    Student *s = &r->students[idx];
+    reserve_grades(r, s, s->gradeCount + count);
+    StudentCold *c = s->cold;
+    float old_avg = s->average;
+    for (int i = 0; i < count; ++i)
+    {
+#ifdef SMS_QUANTIZED_GRADES
+        GradeValue grade = grade_quantize(grades[i]);
+        c->grades[s->gradeCount++] = grade;
+        c->gradeSum += grade; /* exact: no rounding to carry */
+#else
+        float grade = grades[i];
+        c->grades[s->gradeCount++] = grade;
+        /* Kahan step: carry the rounding error of each addition forward */
+        float y = grade - c->gradeSumComp;
+        float t = c->gradeSum + y;
+        c->gradeSumComp = (t - c->gradeSum) - y;
+        c->gradeSum = t;
+#endif
+    }
+    s->average = grade_average(c->gradeSum, s->gradeCount);
+    col_store(r, idx);
+    hist_count_grades(r, c->grades + s->gradeCount - count, count, 1);
+    hist_move_average(r, old_avg, s->average);
+    mark_dirty(r, s);
+    notify_change(r, id);
+    return true;
+}
+
+/**
+ * registry_add_grade_to_student - Add a grade to a student and recalculate average
+ *
+ * Time Complexity: O(1) amortized expected
+ * Space Complexity: O(g) for storing grades
+ *
+ * Complexity Analysis:
+ * 1. add_grades_to_student() with a run of one - O(1) amortized expected:
+ *    Hash lookup, geometric growth, Kahan update of the running sum
+ *
+ * Overall: O(1) amortized expected - building g grades costs O(g)
+ */
+/* Add grade to student (grows the grade array geometrically) */
+bool registry_add_grade_to_student(StudentRegistry *r, int id, float grade)
+{
+    return registry_add_grades_to_student(r, id, &grade, 1);
+}
+
+/**
+ * sum_grades_recursive - Recursively sum grades using divide and conquer
+ *
+ * Time Complexity: O(g) where g is number of grades
+ * Space Complexity: O(log g) for recursion stack
+ *
+ * Complexity Analysis:
+ * 1. Base cases (n ≤ 1) - O(1): Direct return
+ * 2. Divide step:
+ *    - Calculate mid - O(1)
+ *    - Recursive calls on two halves - T(g/2) each
+ * 3. Conquer step:
+ *    - Add two sums - O(1)
+ *
+ * Recurrence relation: T(g) = 2T(g/2) + O(1)
+ * Solution by Master Theorem: T(g) = O(g)
+ *
+ * Recursion depth: log₂(g)
+ * Stack space per level: O(1)
+ * Total stack space: O(log g)
+ *
+ * Overall: O(g) time, O(log g) space
+ */
+/* Recursive sum of grades (reference for sum_grades(), not on any hot path) */
+float sum_grades_recursive(const float *grades, int n)
+{
+    if (n <= 0)
+        return 0.0f;
+    if (n == 1)
+        return grades[0];
+    /* divide and conquer to avoid deep tail recursion for long arrays */
+    int mid = n / 2;
+    float left = sum_grades_recursive(grades, mid);
+    float right = sum_grades_recursive(grades + mid, n - mid);
+    return left + right;
+}
+
+/**
+ * sum_block - Flat SIMD sum of at most SUM_BLOCK grades
+ *
+ * Time Complexity: O(n) where n ≤ SUM_BLOCK
+ * Space Complexity: O(1) - SUM_LANES accumulators
+ *
+ * Complexity Analysis:
+ * 1. Vector loop - O(n / SUM_LANES): Two independent vector
+ *    accumulators (AVX: 2 × 8 floats, SSE/NEON: 4 × 4 floats, portable:
+ *    16 scalar lanes) so consecutive adds do not wait on each other
+ * 2. Spill lanes and reduce as a balanced tree - O(SUM_LANES)
+ * 3. Scalar tail - O(SUM_LANES)
+ *
+ * Each lane adds at most SUM_BLOCK / SUM_LANES values in sequence,
+ * which bounds the rounding error of the leaf.
+ *
+ * Overall: O(n)
+ */
+#define SUM_BLOCK 128 /* grades per leaf of the pairwise tree */
+#define SUM_LANES 16  /* floats accumulated side by side */
+static float sum_block(const float *g, int n)
+{
+    float lanes[SUM_LANES];
+    int i = 0;
+#if defined(__AVX__)
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16)
+    {
+        a0 = _mm256_add_ps(a0, _mm256_loadu_ps(g + i));
+        a1 = _mm256_add_ps(a1, _mm256_loadu_ps(g + i + 8));
+    }
+    _mm256_storeu_ps(lanes, a0);
+    _mm256_storeu_ps(lanes + 8, a1);
+#elif defined(__SSE__)
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+    for (; i + 16 <= n; i += 16)
+    {
+        a0 = _mm_add_ps(a0, _mm_loadu_ps(g + i));
+        a1 = _mm_add_ps(a1, _mm_loadu_ps(g + i + 4));
+        a2 = _mm_add_ps(a2, _mm_loadu_ps(g + i + 8));
+        a3 = _mm_add_ps(a3, _mm_loadu_ps(g + i + 12));
+    }
+    _mm_storeu_ps(lanes, a0);
+    _mm_storeu_ps(lanes + 4, a1);
+    _mm_storeu_ps(lanes + 8, a2);
+    _mm_storeu_ps(lanes + 12, a3);
+#elif defined(__ARM_NEON)
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    float32x4_t a2 = vdupq_n_f32(0.0f), a3 = vdupq_n_f32(0.0f);
+    for (; i + 16 <= n; i += 16)
+    {
+        a0 = vaddq_f32(a0, vld1q_f32(g + i));
+        a1 = vaddq_f32(a1, vld1q_f32(g + i + 4));
+        a2 = vaddq_f32(a2, vld1q_f32(g + i + 8));
+        a3 = vaddq_f32(a3, vld1q_f32(g + i + 12));
+    }
+    vst1q_f32(lanes, a0);
+    vst1q_f32(lanes + 4, a1);
+    vst1q_f32(lanes + 8, a2);
+    vst1q_f32(lanes + 12, a3);
+#else
+    for (int l = 0; l < SUM_LANES; ++l)
+        lanes[l] = 0.0f;
+    for (; i + SUM_LANES <= n; i += SUM_LANES)
+        for (int l = 0; l < SUM_LANES; ++l)
+            lanes[l] += g[i + l];
+#endif
+    for (int w = SUM_LANES / 2; w > 0; w /= 2)
+        for (int l = 0; l < w; ++l)
+            lanes[l] += lanes[l + w];
+    float tail = 0.0f;
+    for (; i < n; ++i)
+        tail += g[i];
+    return lanes[0] + tail;
+}
+
+/**
+ * sum_grades - Iterative pairwise sum of grades over SIMD leaf blocks
+ *
+ * Time Complexity: O(g) where g is number of grades
+ * Space Complexity: O(1) - fixed stack of partial sums
+ *
+ * Complexity Analysis:
+ * 1. Short runs (g ≤ SUM_BLOCK) - O(g): One sum_block() call
+ * 2. Longer runs - O(g): sum_block() per leaf of SUM_BLOCK grades
+ *    - Leaf sums are combined like a binary counter: after leaf b,
+ *      one merge per trailing 1-bit of b, so partial[k] always holds
+ *      the sum of 2^k leaves - O(1) amortized per leaf
+ * 3. Fold the remaining partials, smallest first - O(log g)
+ *
+ * Same tree shape as pairwise summation above the leaves, so the
+ * rounding error grows with log(g) like sum_grades_recursive(), with
+ * no function call per grade.
+ *
+ * Overall: O(g) time, O(1) space
+ */
+float sum_grades(const float *grades, int n)
+{
+    if (n <= 0)
+        return 0.0f;
+    if (n <= SUM_BLOCK)
+        return sum_block(grades, n);
+
+    float partial[32]; /* log2(INT_MAX / SUM_BLOCK) + 1 levels at most */
+    int depth = 0;
+    for (int b = 0, i = 0; i < n; ++b, i += SUM_BLOCK)
+    {
+        float s = sum_block(grades + i, n - i < SUM_BLOCK ? n - i : SUM_BLOCK);
+        for (int k = b; k & 1; k >>= 1)
+            s = partial[--depth] + s;
+        partial[depth++] = s;
+    }
+    float total = partial[--depth];
+    while (depth > 0)
+        total = partial[--depth] + total;
+    return total;
+}
+
+#ifdef SMS_QUANTIZED_GRADES
+/**
+ * sum_grade_values - Exact sum of quantized grades, in hundredths
+ *
+ * Time Complexity: O(g) where g is number of grades
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Blocks of SUM_VALUE_BLOCK grades - O(g): Eight 32-bit lanes each,
+ *    widened from 16 bits with SSE2 unpacks (or a plain lane loop); a
+ *    block cannot overflow a lane
+ * 2. Reduce the lanes into a 64-bit total per block - O(8)
+ *
+ * Integer addition is associative, so no pairwise tree or compensation
+ * is needed: the result is exact and independent of lane order.
+ *
+ * Overall: O(g)
+ */
+#define SUM_VALUE_BLOCK 65536 /* 65536 × UINT16_MAX still fits 32 bits */
+uint64_t sum_grade_values(const GradeValue *grades, int n)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < n; i += SUM_VALUE_BLOCK)
+    {
+        const GradeValue *g = grades + i;
+        int m = n - i < SUM_VALUE_BLOCK ? n - i : SUM_VALUE_BLOCK;
+        uint32_t lanes[8] = {0};
+        int j = 0;
+#if defined(__SSE2__)
+        __m128i zero = _mm_setzero_si128(), a0 = zero, a1 = zero;
+        for (; j + 8 <= m; j += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(g + j));
+            a0 = _mm_add_epi32(a0, _mm_unpacklo_epi16(v, zero));
+            a1 = _mm_add_epi32(a1, _mm_unpackhi_epi16(v, zero));
+        }
+        _mm_storeu_si128((__m128i *)lanes, a0);
+        _mm_storeu_si128((__m128i *)(lanes + 4), a1);
+#else
+        for (; j + 8 <= m; j += 8)
+            for (int l = 0; l < 8; ++l)
+                lanes[l] += g[j + l];
+#endif
+        for (; j < m; ++j)
+            lanes[0] += g[j];
+        for (int l = 0; l < 8; ++l)
+            total += lanes[l];
+    }
+    return total;
+}
+#endif
+
+/**
+ * registry_recalc_average - Recalculate a student's average grade
+ *
+ * Time Complexity: O(g) where g is number of grades
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. Null check - O(1)
+ * 2. grade_sum_refresh() - O(g): Vectorized pairwise sum of all g
+ *    grades, or the exact integer sum in quantized builds
+ * 3. grade_average() - O(1): Calculate average, 0 without grades
+ * 4. Assignment - O(1): Store result
+ *
+ * Also resets the running sum used by add_grade_to_student(), so
+ * this is the full recompute done on load and by verify_averages().
+ * Students stored in the registry have their columns and average
+ * bucket refreshed.
+ *
+ * Overall: O(g) time, O(1) space
+ */
+void registry_recalc_average(StudentRegistry *r, Student *s)
+{
+    if (!s || !s->cold)
+        return;
+    StudentCold *c = s->cold;
+    float old_avg = s->average;
+    grade_sum_refresh(c, s->gradeCount);
+    s->average = grade_average(c->gradeSum, s->gradeCount);
+    if (s >= r->students && s < r->students + r->students_size)
+    {
+        col_store(r, (int)(s - r->students));
+        hist_move_average(r, old_avg, s->average);
+    }
+}
+
+/**
+ * registry_verify_averages - Recompute every average from scratch and count drift
+ *
+ * Time Complexity: O(n + G) where G is total grades
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. Loop through students - O(n): Tombstones are skipped
+ * 2. For each student:
+ *    - Save running average - O(1)
+ *    - recalc_average() - O(g): Full vectorized recompute
+ *    - Compare against AVERAGE_DRIFT_TOLERANCE - O(1)
+ *
+ * Replaces every running sum with the recomputed one.
+ *
+ * Overall: O(n + G) - returns number of students that had drifted
+ */
+int registry_verify_averages(StudentRegistry *r)
+{
+    int drifted = 0;
+    for (int i = 0; i < r->students_size; ++i)
+    {
+        if (r->students[i].dead)
+            continue;
+        float before = r->students[i].average;
+        registry_recalc_average(r, &r->students[i]);
+        float diff = before - r->students[i].average;
+        if (diff > AVERAGE_DRIFT_TOLERANCE || diff < -AVERAGE_DRIFT_TOLERANCE)
+            drifted++;
+    }
+    return drifted;
+}
+
+/**
+ * clamp_page - Clip [first, first + count) to the registry
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Returns the end of the page; count ≤ 0 means "to the end". Pages
+ * count slots, so a page may show fewer rows while tombstones remain.
+ *
+ * Overall: O(1)
+ */
+static int clamp_page(StudentRegistry *r, int *first, int count)
+{
+    if (*first < 0)
+        *first = 0;
+    if (*first > r->students_size)
+        *first = r->students_size;
+    if (count <= 0 || count > r->students_size - *first)
+        return r->students_size;
+    return *first + count;
+}
+
+/**
+ * registry_display_students_page - Display the summary rows of one page of students
+ *
+ * Time Complexity: O(p) where p is rows on the page
+ * Space Complexity: O(1) - one output buffer
+ *
+ * Complexity Analysis:
+ * 1. Empty check - O(1)
+ * 2. Print header - O(1): Fixed output
+ * 3. clamp_page() - O(1)
+ * 4. For each row on the page - O(1):
+ *    - Skip tombstones
+ *    - ob_int(), ob_pad(), ob_fixed2() - no format string parsing
+ * 5. ob_finish() - O(p): Rows reach stdout in large fwrite() calls
+ *
+ * Overall: O(p) - independent of registry size
+ */
+/* Display functions */
+void registry_display_students_page(StudentRegistry *r, int first, int count)
+{
+    if (r->students_size == r->students_dead)
+    {
+        puts("No students.");
+        return;
+    }
+    int end = clamp_page(r, &first, count);
+    OutBuf out;
+    ob_init(&out, stdout);
+    ob_puts(&out, "ID\tName\t\tAvg\t#grades\n");
+    ob_puts(&out, "-----------------------------------------\n");
+    for (int i = first; i < end; ++i)
+    {
+        Student *s = &r->students[i];
+        if (s->dead)
+            continue;
+        ob_int(&out, s->id);
+        ob_putc(&out, '\t');
+        ob_pad(&out, registry_student_name(r, s), 15);
+        ob_putc(&out, '\t');
+        ob_fixed2(&out, s->average);
+        ob_putc(&out, '\t');
+        ob_int(&out, s->gradeCount);
+        ob_putc(&out, '\n');
+    }
+    ob_finish(&out);
+}
+
+/**
+ * registry_display_all_students - Display summary of all students
+ *
+ * Time Complexity: O(n) where n is number of students
+ * Space Complexity: O(1) - one output buffer
+ *
+ * Complexity Analysis:
+ * 1. display_students_page() over the whole registry - O(n)
+ *
+ * Overall: O(n) - linear in number of students
+ */
+void registry_display_all_students(StudentRegistry *r)
+{
+    registry_display_students_page(r, 0, 0);
+}
+
+/**
+ * registry_display_grade_matrix_page - Display the grade rows of one page of students
+ *
+ * Time Complexity: O(p × g) where p is rows on the page, g is avg grades
+ * Space Complexity: O(1) - one output buffer
+ *
+ * Complexity Analysis:
+ * 1. Empty check - O(1)
+ * 2. Print header - O(1)
+ * 3. clamp_page() - O(1)
+ * 4. For each row on the page:
+ *    - Skip tombstones
+ *    - Print student info - O(1)
+ *    - Inner loop - O(g): ob_fixed2() per grade
+ * 5. ob_finish() - O(p × g): Large fwrite() calls to stdout
+ *
+ * Overall: O(p × g) where g varies per student
+ */
+void registry_display_grade_matrix_page(StudentRegistry *r, int first, int count)
+{
+    if (r->students_size == r->students_dead)
+    {
+        puts("No students.");
+        return;
+    }
+    int end = clamp_page(r, &first, count);
+    OutBuf out;
+    ob_init(&out, stdout);
+    ob_puts(&out, "Grades Matrix (each row = student):\n");
+    for (int i = first; i < end; ++i)
+    {
+        Student *s = &r->students[i];
+        if (s->dead)
+            continue;
+        ob_putc(&out, '[');
+        ob_int(&out, i);
+        ob_puts(&out, "] ");
+        ob_int(&out, s->id);
+        ob_putc(&out, ' ');
+        ob_pad(&out, registry_student_name(r, s), 12);
+        ob_puts(&out, " | ");
+        if (s->gradeCount == 0)
+        {
+            ob_puts(&out, "(no grades)");
+        }
+        else
+        {
+            for (int j = 0; j < s->gradeCount; ++j)
+            {
+                ob_fixed2(&out, student_grade(s, j));
+                if (j + 1 < s->gradeCount)
+                    ob_write(&out, ", ", 2);
+            }
+            ob_puts(&out, "  (avg: ");
+            ob_fixed2(&out, s->average);
+            ob_putc(&out, ')');
+        }
+        ob_putc(&out, '\n');
+    }
+    ob_finish(&out);
+}
+
+/**
+ * registry_display_grade_matrix - Display detailed grade matrix for all students
+ *
+ * Time Complexity: O(n × g) where n is students, g is avg grades per student
+ * Space Complexity: O(1) - one output buffer
+ *
+ * Complexity Analysis:
+ * 1. display_grade_matrix_page() over the whole registry - O(n × g)
+ *
+ * Overall: O(n × g) where g varies per student
+ */
+/* 2D-like grade matrix */
+void registry_display_grade_matrix(StudentRegistry *r)
+{
+    registry_display_grade_matrix_page(r, 0, 0);
+}
+
+/**
+ * cmp_students - Compare two students by specified key
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. Check key type - O(1): Simple comparison
+ * 2. If SORT_BY_ID:
+ *    - Integer subtraction - O(1)
+ * 3. If SORT_BY_AVG:
+ *    - Float comparisons - O(1) each
+ *
+ * Overall: O(1) - simple comparison operation
+ */
+/* comparator by key: return <0 if a < b, 0 equal, >0 if a > b */
+static int cmp_students(const Student *a, const Student *b, SortKey key)
+{
+    if (key == SORT_BY_ID)
+    {
+        return (a->id - b->id);
+    }
+    else
+    {
+        if (a->average < b->average)
+            return -1;
+        if (a->average > b->average)
+            return 1;
+        return 0;
+    }
+}
+
+/**
+ * swap_students - Swap two students in the array
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - uses temporary Student struct
+ *
+ * Complexity Analysis:
+ * 1. Copy student a to temp - O(1): Struct assignment
+ * 2. Copy student b to a - O(1): Struct assignment
+ * 3. Copy temp to b - O(1): Struct assignment
+ *
+ * Note: Student is the 24-byte hot record (the name and grades stay
+ * in the cold record it points to), so copying is O(1) constant time
+ *
+ * Overall: O(1) - three struct copies
+ */
+/* swap */
+static void swap_students(Student *a, Student *b)
+{
+    Student tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * bubble_sort - Sort students using bubble sort algorithm
+ *
+ * Time Complexity: O(n²) where n is number of students
+ * Space Complexity: O(1) - in-place sorting
+ *
+ * Complexity Analysis:
+ * 1. Outer loop - runs (n-1) times
+ * 2. Inner loop - runs (n-1-i) times for iteration i
+ * 3. For each inner iteration:
+ *    - cmp_students() - O(1)
+ *    - swap_students() if needed - O(1)
+ *
+ * Total comparisons:
+ * (n-1) + (n-2) + ... + 1 = n(n-1)/2 = O(n²)
+ *
+ * Best case: O(n) - already sorted (early exit with swapped flag)
+ * Average case: O(n²)
+ * Worst case: O(n²) - reverse sorted
+ *
+ * Overall: O(n²) time, O(1) space - stable sort
+ */
+/* Bubble sort (stable) */
+static void bubble_sort(StudentRegistry *r, SortKey key)
+{
+    uint64_t compares = 0;
+    for (int i = 0; i < r->students_size - 1; ++i)
+    {
+        bool swapped = false;
+        for (int j = 0; j < r->students_size - 1 - i; ++j)
+        {
+            compares++;
+            if (cmp_students(&r->students[j], &r->students[j + 1], key) > 0)
+            {
+                swap_students(&r->students[j], &r->students[j + 1]);
+                swapped = true;
+            }
+        }
+        if (!swapped)
+            break;
+    }
+    INSTR_ADD(INSTR_SORT_COMPARE, compares);
+}
+
+/**
+ * insertion_sort - Sort students using insertion sort algorithm
+ *
+ * Time Complexity: O(n²) where n is number of students
+ * Space Complexity: O(1) - in-place sorting
+ *
+ * Complexity Analysis:
+ * 1. Outer loop - runs from index 1 to n-1 (n-1 iterations)
+ * 2. For each iteration i:
+ *    - Store current student - O(1)
+ *    - Inner while loop - runs up to i times
+ *    - Each comparison - O(1)
+ *    - Each shift - O(1)
+ *
+ * Total comparisons and shifts:
+ * Worst case: 1 + 2 + 3 + ... + (n-1) = n(n-1)/2 = O(n²)
+ *
+ * Best case: O(n) - already sorted (only comparisons, no shifts)
+ * Average case: O(n²)
+ * Worst case: O(n²) - reverse sorted
+ *
+ * Overall: O(n²) time, O(1) space - stable sort
+ */
+/* Insertion sort */
+static void insertion_sort(StudentRegistry *r, SortKey key)
+{
+    uint64_t compares = 0;
+    for (int i = 1; i < r->students_size; ++i)
+    {
+        Student keyStudent = r->students[i];
+        int j = i - 1;
+        while (j >= 0 && (compares++, cmp_students(&r->students[j], &keyStudent, key) > 0))
+        {
+            r->students[j + 1] = r->students[j];
+            j--;
+        }
+        r->students[j + 1] = keyStudent;
+    }
+    INSTR_ADD(INSTR_SORT_COMPARE, compares);
+}
+
+/**
+ * sort_key_of - Encode a student's sort key as an order-preserving uint32
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. SORT_BY_ID - O(1): Flip the sign bit so signed order becomes
+ *    unsigned order
+ * 2. SORT_BY_AVG - O(1): IEEE-754 trick, flip all bits of negatives and
+ *    only the sign bit of non-negatives (-0.0 folded into +0.0)
+ *
+ * Overall: O(1)
+ */
+static uint32_t sort_key_of(const Student *s, SortKey key)
+{
+    if (key == SORT_BY_ID)
+        return (uint32_t)s->id ^ 0x80000000u;
+    float f = s->average == 0.0f ? 0.0f : s->average;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/**
+ * reserve_sort_buffers - Make sure the pair and scratch buffers hold n pairs
+ *
+ * Time Complexity: O(1), O(n) when growing
+ * Space Complexity: O(n) - two SortPair buffers in one allocation
+ *
+ * Overall: O(1) amortized over repeated sorts
+ */
+static void reserve_sort_buffers(StudentRegistry *r, int n)
+{
+    if (n <= r->sort_buf_capacity)
+        return;
+    SortPair *tmp = realloc(r->sort_pairs, 2 * (size_t)n * sizeof(SortPair));
+    if (!tmp)
+    {
+        fprintf(stderr, "Memory allocation failed in sort.\n");
+        exit(EXIT_FAILURE);
+    }
+    r->sort_pairs = tmp;
+    r->sort_scratch = tmp + n;
+    r->sort_buf_capacity = n;
+}
+
+/**
+ * merge_pairs - Stable merge of two adjacent sorted runs of pairs
+ *
+ * Time Complexity: O(n) where n = right - left
+ * Space Complexity: O(1) - writes into the caller's destination buffer
+ *
+ * Complexity Analysis:
+ * 1. Merge loop - O(n): One key comparison per output pair
+ *    - Ties take the left run first, so the merge is stable
+ * 2. Copy the leftover run - O(n)
+ *
+ * Returns the number of key comparisons made.
+ *
+ * Overall: O(n) time, no allocation
+ */
+static int merge_pairs(const SortPair *src, SortPair *dst, int left, int mid, int right)
+{
+    int i = left, j = mid, k = left;
+    while (i < mid && j < right)
+    {
+        if (src[j].key < src[i].key)
+            dst[k++] = src[j++];
+        else
+            dst[k++] = src[i++];
+    }
+    int compares = k - left;
+    while (i < mid)
+        dst[k++] = src[i++];
+    while (j < right)
+        dst[k++] = src[j++];
+    return compares;
+}
+
+/**
+ * merge_sort_pairs - Bottom-up iterative merge sort over n pairs
+ *
+ * Time Complexity: O(n log n)
+ * Space Complexity: O(1) beyond the two preallocated buffers
+ *
+ * Complexity Analysis:
+ * 1. Passes - O(log n): Run width 1, 2, 4, ... until >= n
+ * 2. Each pass - O(n): merge_pairs() over every pair of runs,
+ *    ping-ponging between the two buffers
+ * 3. No recursion and no per-merge allocation
+ *
+ * Returns whichever buffer holds the sorted result.
+ *
+ * Overall: O(n log n) time, stable
+ */
+static SortPair *merge_sort_pairs(SortPair *a, SortPair *b, int n)
+{
+    uint64_t compares = 0;
+    for (int width = 1; width < n; width *= 2)
+    {
+        for (int left = 0; left < n; left += 2 * width)
+        {
+            int mid = left + width < n ? left + width : n;
+            int right = left + 2 * width < n ? left + 2 * width : n;
+            compares += (uint64_t)merge_pairs(a, b, left, mid, right);
+        }
+        SortPair *t = a;
+        a = b;
+        b = t;
+    }
+    INSTR_ADD(INSTR_SORT_COMPARE, compares);
+    return a;
+}
+
+/**
+ * apply_permutation - Reorder students[] so slot i gets student order[i].idx
+ *
+ * Time Complexity: O(n)
+ * Space Complexity: O(1) - one temporary Student
+ *
+ * Complexity Analysis:
+ * 1. Walk each permutation cycle once - O(n)
+ * 2. Each student is moved exactly once - O(1) per move
+ * 3. Visited slots are marked by setting order[j].idx = j
+ *
+ * Overall: O(n) struct moves instead of O(n log n)
+ */
+static void apply_permutation(StudentRegistry *r, SortPair *order, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        if (order[i].idx == i)
+            continue;
+        Student tmp = r->students[i];
+        int j = i;
+        while (1)
+        {
+            int k = order[j].idx;
+            order[j].idx = j;
+            if (k == i)
+            {
+                r->students[j] = tmp;
+                break;
+            }
+            r->students[j] = r->students[k];
+            j = k;
+        }
+    }
+}
+
+/**
+ * set_sort_threads - Configure the thread count for parallel merge sort
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * 0 selects one thread per online CPU, 1 disables the parallel path.
+ *
+ * Overall: O(1)
+ */
+void set_sort_threads(int threads)
+{
+    sort_threads = threads < 0 ? 0 : threads;
+}
+
+/**
+ * effective_sort_threads - Resolve the configured thread count
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static int effective_sort_threads(void)
+{
+    int t = sort_threads;
+    if (t == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        t = cpus > 0 ? (int)cpus : 1;
+    }
+    return t > MAX_SORT_THREADS ? MAX_SORT_THREADS : t;
+}
+
+/* One parallel step: tasks [0, ntasks) split round-robin over threads */
+typedef struct
+{
+    void (*fn)(void *ctx, int task);
+    void *ctx;
+    int ntasks;
+    int stride;
+    int first;
+} ParallelShare;
+
+/**
+ * parallel_share_run - Thread body: run every stride-th task
+ *
+ * Time Complexity: O(ntasks / stride) task invocations
+ * Space Complexity: O(1)
+ *
+ * Overall: O(ntasks / stride)
+ */
+static void *parallel_share_run(void *arg)
+{
+    ParallelShare *sh = arg;
+    for (int t = sh->first; t < sh->ntasks; t += sh->stride)
+        sh->fn(sh->ctx, t);
+    return NULL;
+}
+
+/**
+ * run_parallel - Run ntasks tasks on up to nthreads threads and wait
+ *
+ * Time Complexity: O(ntasks / nthreads) task invocations per thread
+ * Space Complexity: O(nthreads) - thread handles on the stack
+ *
+ * Complexity Analysis:
+ * 1. Spawn nthreads - 1 workers - O(nthreads)
+ * 2. Caller runs share 0 itself - no idle thread while waiting
+ * 3. pthread_join() each worker - O(nthreads)
+ * 4. A share whose thread could not be created runs on the caller
+ *
+ * Overall: O(ntasks / nthreads) wall time per task cost
+ */
+static void run_parallel(void (*fn)(void *, int), void *ctx, int ntasks, int nthreads)
+{
+    if (ntasks <= 0)
+        return;
+    if (nthreads < 1)
+        nthreads = 1;
+    if (nthreads > ntasks)
+        nthreads = ntasks;
+    if (nthreads > MAX_SORT_THREADS)
+        nthreads = MAX_SORT_THREADS;
+    ParallelShare shares[MAX_SORT_THREADS];
+    pthread_t tids[MAX_SORT_THREADS];
+    bool started[MAX_SORT_THREADS];
+    for (int t = 0; t < nthreads; ++t)
+    {
+        shares[t] = (ParallelShare){fn, ctx, ntasks, nthreads, t};
+        started[t] = t > 0 && pthread_create(&tids[t], NULL, parallel_share_run, &shares[t]) == 0;
+    }
+    parallel_share_run(&shares[0]);
+    for (int t = 1; t < nthreads; ++t)
+    {
+        if (started[t])
+            pthread_join(tids[t], NULL);
+        else
+            parallel_share_run(&shares[t]);
+    }
+}
+
+/* Shared state for one parallel merge sort */
+typedef struct
+{
+    SortPair *src;
+    SortPair *dst;
+    int bounds[MAX_SORT_THREADS + 1]; /* sorted run i is [bounds[i], bounds[i+1]) */
+    int runs;
+    int parts_per_merge;
+} ParallelSort;
+
+/**
+ * parallel_sort_chunk - Task: sort one chunk of the pair array
+ *
+ * Time Complexity: O(c log c) where c is chunk size
+ * Space Complexity: O(1) - uses the matching range of the scratch buffer
+ *
+ * Complexity Analysis:
+ * 1. merge_sort_pairs() on the chunk - O(c log c)
+ * 2. Copy back into src if the result landed in dst - O(c)
+ *
+ * Overall: O(c log c)
+ */
+static void parallel_sort_chunk(void *ctx, int task)
+{
+    ParallelSort *ps = ctx;
+    int lo = ps->bounds[task];
+    int n = ps->bounds[task + 1] - lo;
+    SortPair *out = merge_sort_pairs(ps->src + lo, ps->dst + lo, n);
+    if (out != ps->src + lo)
+        memcpy(ps->src + lo, out, n * sizeof(SortPair));
+}
+
+/**
+ * co_rank - Split point for a stable merge of a (len m) and b (len l)
+ *
+ * Time Complexity: O(log min(m, l))
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Binary search for i, the number of elements taken from a among
+ *    the first k outputs of merge_pairs() (ties come from a first)
+ *
+ * Overall: O(log min(m, l))
+ */
+static int co_rank(int k, const SortPair *a, int m, const SortPair *b, int l)
+{
+    int lo = k > l ? k - l : 0;
+    int hi = k < m ? k : m;
+    while (1)
+    {
+        int i = lo + (hi - lo) / 2;
+        int j = k - i;
+        if (i < m && j > 0 && a[i].key <= b[j - 1].key)
+            lo = i + 1;
+        else if (i > 0 && j < l && b[j].key < a[i - 1].key)
+            hi = i - 1;
+        else
+            return i;
+    }
+}
+
+/**
+ * parallel_merge_part - Task: produce one slice of one pairwise merge
+ *
+ * Time Complexity: O(s + log n) where s is the slice length
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Locate the merge (runs 2q, 2q+1) and slice this task owns - O(1)
+ * 2. co_rank() for the slice start and end - O(log n)
+ * 3. merge_pairs() on the two sub-runs - O(s), or a plain copy when
+ *    the run has no partner this round
+ *
+ * Every slice is written by exactly one task, so no locking is needed.
+ *
+ * Overall: O(s + log n)
+ */
+static void parallel_merge_part(void *ctx, int task)
+{
+    ParallelSort *ps = ctx;
+    int q = task / ps->parts_per_merge;
+    int part = task % ps->parts_per_merge;
+    int left = ps->bounds[2 * q];
+    int mid = ps->bounds[2 * q + 1];
+    int right = (2 * q + 2 <= ps->runs) ? ps->bounds[2 * q + 2] : mid;
+    int total = right - left;
+    int k0 = (int)((long long)total * part / ps->parts_per_merge);
+    int k1 = (int)((long long)total * (part + 1) / ps->parts_per_merge);
+    if (k0 == k1)
+        return;
+    if (right == mid)
+    {
+        memcpy(ps->dst + left + k0, ps->src + left + k0, (k1 - k0) * sizeof(SortPair));
+        return;
+    }
+    const SortPair *a = ps->src + left;
+    const SortPair *b = ps->src + mid;
+    int m = mid - left, l = right - mid;
+    int i0 = co_rank(k0, a, m, b, l), i1 = co_rank(k1, a, m, b, l);
+    int j0 = k0 - i0, j1 = k1 - i1;
+    /* merge a[i0, i1) with b[j0, j1) into dst[left + k0, left + k1) */
+    SortPair *out = ps->dst + left + k0;
+    int i = i0, j = j0;
+    while (i < i1 && j < j1)
+    {
+        if (b[j].key < a[i].key)
+            *out++ = b[j++];
+        else
+            *out++ = a[i++];
+    }
+    INSTR_ADD(INSTR_SORT_COMPARE, (i - i0) + (j - j0));
+    while (i < i1)
+        *out++ = a[i++];
+    while (j < j1)
+        *out++ = b[j++];
+}
+
+/**
+ * parallel_merge_sort_pairs - Multi-threaded stable merge sort of n pairs
+ *
+ * Time Complexity: O((n log n) / T + n log T) work on T threads
+ * Space Complexity: O(1) beyond the two preallocated buffers
+ *
+ * Complexity Analysis:
+ * 1. Chunk phase - O((n/T) log(n/T)) wall time:
+ *    T equal chunks sorted concurrently with merge_sort_pairs()
+ * 2. Merge rounds - O(log T) rounds, O(n/T + log n) wall time each:
+ *    Adjacent runs merged pairwise; every merge is cut into slices
+ *    with co_rank() so all T threads stay busy even in the last round
+ * 3. Ping-pong between the buffers like merge_sort_pairs()
+ *
+ * Equal keys never change relative order, so the result is identical
+ * to the sequential stable merge sort.
+ *
+ * Overall: O(n log n) work, ~T× faster wall time
+ */
+static SortPair *parallel_merge_sort_pairs(SortPair *a, SortPair *b, int n, int threads)
+{
+    ParallelSort ps;
+    ps.src = a;
+    ps.dst = b;
+    ps.runs = threads;
+    for (int t = 0; t <= threads; ++t)
+        ps.bounds[t] = (int)((long long)n * t / threads);
+    run_parallel(parallel_sort_chunk, &ps, threads, threads);
+
+    while (ps.runs > 1)
+    {
+        int merges = (ps.runs + 1) / 2;
+        ps.parts_per_merge = (threads + merges - 1) / merges;
+        run_parallel(parallel_merge_part, &ps, merges * ps.parts_per_merge, threads);
+        for (int q = 0; q <= merges; ++q)
+            ps.bounds[q] = ps.bounds[2 * q <= ps.runs ? 2 * q : ps.runs];
+        ps.runs = merges;
+        SortPair *t = ps.src;
+        ps.src = ps.dst;
+        ps.dst = t;
+    }
+    return ps.src;
+}
+
+/**
+ * radix_sort_pairs - Stable LSD radix sort of n pairs on their 32-bit key
+ *
+ * Time Complexity: O(n) - four passes of 8 bits each
+ * Space Complexity: O(1) beyond the two preallocated buffers
+ *
+ * Complexity Analysis:
+ * 1. For each of the 4 key bytes (least significant first):
+ *    - Histogram - O(n): Count pairs per byte value
+ *    - Skip the pass if every key has the same byte - O(1)
+ *    - Prefix sums - O(256): Starting offset per byte value
+ *    - Scatter - O(n): Copy pairs in order, which keeps it stable
+ * 2. Ping-pong between the buffers like merge_sort_pairs()
+ *
+ * Returns whichever buffer holds the sorted result.
+ *
+ * Overall: O(4 × (n + 256)) = O(n), stable
+ */
+static SortPair *radix_sort_pairs(SortPair *a, SortPair *b, int n)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        int count[256] = {0};
+        for (int i = 0; i < n; ++i)
+            count[(a[i].key >> shift) & 0xFF]++;
+        if (count[(a[0].key >> shift) & 0xFF] == n)
+            continue; /* this byte is identical for every key */
+        int offset = 0;
+        for (int d = 0; d < 256; ++d)
+        {
+            int c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (int i = 0; i < n; ++i)
+            b[count[(a[i].key >> shift) & 0xFF]++] = a[i];
+        SortPair *t = a;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * pair_sort_students - Sort students through key-index pairs
+ *
+ * Time Complexity: O(n log n) for MERGE, O(n) for RADIX
+ * Space Complexity: O(n) for the pair buffers (reused across sorts)
+ *
+ * Complexity Analysis:
+ * 1. reserve_sort_buffers() - O(1) amortized
+ * 2. Build (key, index) pairs - O(n): sort_key_of() per student
+ * 3. merge_sort_pairs() O(n log n) or radix_sort_pairs() O(n):
+ *    Sorts 8-byte pairs, not Students. MERGE switches to
+ *    parallel_merge_sort_pairs() at PARALLEL_SORT_THRESHOLD pairs
+ *    when more than one sort thread is available
+ * 4. apply_permutation() - O(n): One move per Student
+ *
+ * Overall: O(n log n) or O(n) time, O(n) space - stable sort
+ */
+static void pair_sort_students(StudentRegistry *r, SortMethod method, SortKey key)
+{
+    int n = r->students_size;
+    reserve_sort_buffers(r, n);
+    for (int i = 0; i < n; ++i)
+    {
+        r->sort_pairs[i].key = sort_key_of(&r->students[i], key);
+        r->sort_pairs[i].idx = i;
+    }
+    SortPair *sorted;
+    int threads = effective_sort_threads();
+    if (method == RADIX)
+        sorted = radix_sort_pairs(r->sort_pairs, r->sort_scratch, n);
+    else if (n >= PARALLEL_SORT_THRESHOLD && threads > 1)
+        sorted = parallel_merge_sort_pairs(r->sort_pairs, r->sort_scratch, n, threads);
+    else
+        sorted = merge_sort_pairs(r->sort_pairs, r->sort_scratch, n);
+    apply_permutation(r, sorted, n);
+}
+
+/**
+ * registry_sort_students - Sort students using specified method and key
+ *
+ * Time Complexity: O(n²), O(n log n) or O(n) depending on method
+ * Space Complexity: O(1) or O(n) depending on method
+ *
+ * Complexity Analysis:
+ * 1. compact_students() - O(n): Only when tombstones exist; the sort
+ *    moves every slot anyway
+ * 2. Check for trivial case - O(1)
+ * 3. Switch on method - O(1) dispatch
+ * 4. Call appropriate sort:
+ *    - BUBBLE: O(n²) time, O(1) space
+ *    - INSERTION: O(n²) time, O(1) space
+ *    - MERGE: O(n log n) time, O(n) space - key-index pairs
+ *    - RADIX: O(n) time, O(n) space - LSD radix on the same pairs
+ * 5. id_index_reassign(0) - O(n): Re-point every slot in the ID index
+ * 6. col_store_from(0) - O(n): Refresh the columns in the new order
+ *
+ * Overall: Depends on chosen method
+ */
+void registry_sort_students(StudentRegistry *r, SortMethod method, SortKey key)
+{
+    INSTR_INC(INSTR_SORT);
+    registry_compact_students(r);
+    if (r->students_size <= 1)
+        return;
+    INSTR_TIMER_START(t0);
+    switch (method)
+    {
+    case BUBBLE:
+        bubble_sort(r, key);
+        break;
+    case INSERTION:
+        insertion_sort(r, key);
+        break;
+    case RADIX:
+        pair_sort_students(r, RADIX, key);
+        break;
+    case MERGE:
+    default:
+        pair_sort_students(r, MERGE, key);
+        break;
+    }
+    id_index_reassign(r, 0);
+    col_store_from(r, 0);
+    INSTR_TIMER_STOP(INSTR_T_SORT, t0);
+}
+
+/**
+ * registry_binary_search_by_id_recursive - Recursively search for student by ID
+ *
+ * Time Complexity: O(log n) where n is number of students
+ * Space Complexity: O(log n) for recursion stack
+ *
+ * Complexity Analysis:
+ * 1. Base case (left > right) - O(1): Not found
+ * 2. Calculate mid - O(1): Arithmetic operation
+ * 3. Compare with target - O(1):
+ *    - If match: return immediately - O(1)
+ *    - If greater: recurse on left half - T(n/2)
+ *    - If less: recurse on right half - T(n/2)
+ *
+ * Recurrence relation: T(n) = T(n/2) + O(1)
+ * Solution by Master Theorem: T(n) = O(log n)
+ *
+ * Search space halves each iteration:
+ * n → n/2 → n/4 → ... → 1
+ * Number of steps: log₂(n)
+ *
+ * Stack depth: O(log n)
+ *
+ * Prerequisite: Array MUST be sorted by ID. Tombstones keep their ID
+ * and position, so the order still holds; a hit on one means deleted.
+ *
+ * Overall: O(log n) time, O(log n) space
+ */
+/* Binary search by ID (recursive) - array must be sorted by ID */
+int registry_binary_search_by_id_recursive(StudentRegistry *r, int target_id, int left, int right)
+{
+    INSTR_INC(INSTR_BSEARCH_STEP);
+    if (left > right)
+        return -1;
+    int mid = left + (right - left) / 2;
+    if (r->students[mid].id == target_id)
+        return r->students[mid].dead ? -1 : mid;
+    if (r->students[mid].id > target_id)
+        return registry_binary_search_by_id_recursive(r, target_id, left, mid - 1);
+    return registry_binary_search_by_id_recursive(r, target_id, mid + 1, right);
+}
+
+/**
+ * registry_find_student_index - Find a student's current index by ID
+ *
+ * Time Complexity: O(1) expected
+ * Space Complexity: O(1) - constant extra space
+ *
+ * Complexity Analysis:
+ * 1. index_of_id() - O(1) expected: Hash index lookup
+ *
+ * Unlike binary_search_by_id_recursive() this has no ordering
+ * prerequisite, so callers never need to re-sort students[].
+ *
+ * Overall: O(1) expected - returns -1 if not found
+ */
+int registry_find_student_index(StudentRegistry *r, int id)
+{
+    INSTR_INC(INSTR_SEARCH);
+    return index_of_id(r, id);
+}
+
+/**
+ * registry_search_by_name_prefix - IDs of students whose name starts with prefix
+ *
+ * Time Complexity: O(log n + k), plus O(n log n) when the name index
+ *                  has to be (re)built
+ * Space Complexity: O(n) for the name index
+ *
+ * Complexity Analysis:
+ * 1. name_index_search() on r's index - O(log n + k)
+ *
+ * Overall: O(log n + k)
+ */
+int registry_search_by_name_prefix(StudentRegistry *r, const char *prefix, int *ids, int max)
+{
+    return name_index_search(&r->names, r, prefix, ids, max);
+}
+
+/**
+ * registry_reads_ready - Whether queries on r will only read until the next change
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. No tombstones - O(1): Sorted-order and column queries would
+ *    otherwise compact first
+ * 2. Name index built - O(1): A prefix search would otherwise build it
+ * 3. Grade histogram counted - O(1): A query would otherwise recount it
+ *
+ * Overall: O(1)
+ */
+bool registry_reads_ready(StudentRegistry *r)
+{
+    return r->students_dead == 0 && r->names.built && !r->grade_hist_stale;
+}
+
+/**
+ * registry_prepare_reads - Do the deferred work queries would otherwise do
+ *
+ * Time Complexity: O(n log n) when the name index must be rebuilt,
+ *                  O(n) when only tombstones are pending, else O(1)
+ * Space Complexity: O(n) for the name index
+ *
+ * Complexity Analysis:
+ * 1. registry_compact_students() - O(n) only when tombstones exist
+ * 2. name_index_build() - O(n log n) only when the index was dropped
+ * 3. grade_hist_recount() - O(n + G) only after unread mapped grades
+ *    were added
+ *
+ * Afterwards registry_reads_ready() holds until the next add, rename or
+ * delete, so concurrent readers sharing a lock never write.
+ *
+ * Overall: O(n log n) worst case, O(1) when already prepared
+ */
+void registry_prepare_reads(StudentRegistry *r)
+{
+    registry_compact_students(r);
+    if (!r->names.built)
+        name_index_build(&r->names, r);
+    if (r->grade_hist_stale)
+        grade_hist_recount(r);
+}
+
+/* Ranked candidate for top-k queries: average with its slot */
+typedef struct
+{
+    float avg;
+    int idx;
+} RankEntry;
+
+/**
+ * rank_before - Whether a ranks ahead of b in a top-k or bottom-k list
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no allocation
+ *
+ * Complexity Analysis:
+ * 1. Compare averages - O(1): Higher first, or lower first for bottom-k
+ * 2. Tie-break on slot - O(1): Earlier student first, so results match
+ *    a stable sort of the current order
+ *
+ * Overall: O(1)
+ */
+static bool rank_before(RankEntry a, RankEntry b, bool highest)
+{
+    if (a.avg != b.avg)
+        return highest ? a.avg > b.avg : a.avg < b.avg;
+    return a.idx < b.idx;
+}
+
+/**
+ * rank_sift_down - Restore the heap below position i
+ *
+ * Time Complexity: O(log k) where k is heap size
+ * Space Complexity: O(1) - in place
+ *
+ * Complexity Analysis:
+ * 1. Walk down one level per iteration - O(log k)
+ *    - Pick the child that ranks last - O(1)
+ *    - Swap if it ranks after the parent's entry - O(1)
+ *
+ * The root holds the entry that ranks last, the one evicted first.
+ *
+ * Overall: O(log k)
+ */
+static void rank_sift_down(RankEntry *heap, int k, int i, bool highest)
+{
+    for (;;)
+    {
+        int worst = i, l = 2 * i + 1, r = l + 1;
+        if (l < k && rank_before(heap[worst], heap[l], highest))
+            worst = l;
+        if (r < k && rank_before(heap[worst], heap[r], highest))
+            worst = r;
+        if (worst == i)
+            return;
+        RankEntry t = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = t;
+        i = worst;
+    }
+}
+
+/**
+ * rank_select - Collect the k best-ranked students with a bounded heap
+ *
+ * Time Complexity: O(n log k) where n is number of students
+ * Space Complexity: O(k) for the heap
+ *
+ * Complexity Analysis:
+ * 1. compact_students() - O(n) only when tombstones exist
+ * 2. Clamp k to n - O(1)
+ * 3. Heapify the first k entries - O(k)
+ * 4. Scan the remaining averages - O(n log k):
+ *    - Compare with the heap root - O(1): Most candidates stop here
+ *    - Replace root and sift down - O(log k)
+ * 5. Pop the heap into out[] back to front - O(k log k)
+ *
+ * Reads only the average column; students[] is not reordered.
+ *
+ * Overall: O(n log k)
+ */
+static int rank_select(StudentRegistry *r, int k, bool highest, int *out)
+{
+    registry_compact_students(r);
+    if (k > r->students_size)
+        k = r->students_size;
+    if (k <= 0)
+        return 0;
+    RankEntry *heap = malloc((size_t)k * sizeof(RankEntry));
+    if (!heap)
+    {
+        fprintf(stderr, "Memory allocation failed in top-k query.\n");
+        return 0;
+    }
+    for (int i = 0; i < k; ++i)
+        heap[i] = (RankEntry){r->col_avg[i], i};
+    for (int i = k / 2 - 1; i >= 0; --i)
+        rank_sift_down(heap, k, i, highest);
+    for (int i = k; i < r->students_size; ++i)
+    {
+        RankEntry e = {r->col_avg[i], i};
+        if (rank_before(e, heap[0], highest))
+        {
+            heap[0] = e;
+            rank_sift_down(heap, k, 0, highest);
+        }
+    }
+    for (int n = k; n > 0; --n)
+    {
+        out[n - 1] = heap[0].idx;
+        heap[0] = heap[n - 1];
+        rank_sift_down(heap, n - 1, 0, highest);
+    }
+    free(heap);
+    return k;
+}
+
+/**
+ * registry_top_k_by_average - Slots of the k students with the highest averages
+ *
+ * Time Complexity: O(n log k)
+ * Space Complexity: O(k)
+ *
+ * Complexity Analysis:
+ * 1. rank_select(highest) - O(n log k)
+ *
+ * Writes min(k, n) slots to out, best first; ties keep the current
+ * order. Returns the number written.
+ *
+ * Overall: O(n log k)
+ */
+int registry_top_k_by_average(StudentRegistry *r, int k, int *out)
+{
+    return rank_select(r, k, true, out);
+}
+
+/**
+ * registry_bottom_k_by_average - Slots of the k students with the lowest averages
+ *
+ * Time Complexity: O(n log k)
+ * Space Complexity: O(k)
+ *
+ * Complexity Analysis:
+ * 1. rank_select(lowest) - O(n log k)
+ *
+ * Writes min(k, n) slots to out, lowest first. Returns the number written.
+ *
+ * Overall: O(n log k)
+ */
+int registry_bottom_k_by_average(StudentRegistry *r, int k, int *out)
+{
+    return rank_select(r, k, false, out);
+}
+
+/**
+ * cmp_float - qsort() comparator for ascending floats
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static int cmp_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * swap_float - Swap two floats in place
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+static void swap_float(float *a, float *b)
+{
+    float t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+ * introselect - Move the k-th smallest value of v[0..n) to v[k]
+ *
+ * Time Complexity: O(n) expected, O(n log n) worst case
+ * Space Complexity: O(1) - in place, iterative
+ *
+ * Complexity Analysis:
+ * 1. Quickselect loop - O(n) expected:
+ *    - Median-of-three pivot - O(1)
+ *    - Hoare partition of [lo, hi] - O(hi - lo)
+ *    - Continue only in the side holding k
+ * 2. Depth budget of 2·log2(n) partitions - O(1) check per round:
+ *    when exhausted, qsort() the remaining range, bounding the worst
+ *    case at O(n log n)
+ *
+ * Afterwards v[0..k) ≤ v[k] ≤ v(k..n).
+ *
+ * Overall: O(n) expected
+ */
+static void introselect(float *v, int n, int k)
+{
+    int lo = 0, hi = n - 1;
+    int budget = 0;
+    for (int m = n; m > 1; m /= 2)
+        budget += 2;
+    while (hi > lo)
+    {
+        if (budget-- == 0)
+        {
+            qsort(v + lo, (size_t)(hi - lo + 1), sizeof(float), cmp_float);
+            return;
+        }
+        int mid = lo + (hi - lo) / 2;
+        if (v[mid] < v[lo])
+            swap_float(&v[mid], &v[lo]);
+        if (v[hi] < v[lo])
+            swap_float(&v[hi], &v[lo]);
+        if (v[hi] < v[mid])
+            swap_float(&v[hi], &v[mid]);
+        float pivot = v[mid];
+        int i = lo, j = hi;
+        while (i <= j)
+        {
+            while (v[i] < pivot)
+                i++;
+            while (v[j] > pivot)
+                j--;
+            if (i <= j)
+                swap_float(&v[i++], &v[j--]);
+        }
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            return; /* j < k < i: v[k] equals the pivot */
+    }
+}
+
+/**
+ * registry_kth_smallest_average - The k-th smallest average (0-based) by selection
+ *
+ * Time Complexity: O(n) expected
+ * Space Complexity: O(n) for a scratch copy of the average column
+ *
+ * Complexity Analysis:
+ * 1. compact_students() - O(n) only when tombstones exist; range check
+ * 2. memcpy() the average column - O(n): One contiguous copy
+ * 3. introselect() - O(n) expected on the copy
+ *
+ * students[] and its columns are left untouched.
+ *
+ * Overall: O(n) expected
+ */
+bool registry_kth_smallest_average(StudentRegistry *r, int k, float *out)
+{
+    registry_compact_students(r);
+    if (k < 0 || k >= r->students_size)
+        return false;
+    float *v = malloc((size_t)r->students_size * sizeof(float));
+    if (!v)
+    {
+        fprintf(stderr, "Memory allocation failed in selection query.\n");
+        return false;
+    }
+    memcpy(v, r->col_avg, (size_t)r->students_size * sizeof(float));
+    introselect(v, r->students_size, k);
+    *out = v[k];
+    free(v);
+    return true;
+}
+
+/**
+ * registry_average_percentile - Percentile of the averages by selection
+ *
+ * Time Complexity: O(n) expected
+ * Space Complexity: O(n) for a scratch copy of the average column
+ *
+ * Complexity Analysis:
+ * 1. compact_students() - O(n) only when tombstones exist
+ * 2. Clamp pct to [0, 100], position p = pct/100 · (n - 1) - O(1)
+ * 3. memcpy() the average column - O(n)
+ * 4. introselect() floor(p) - O(n) expected
+ * 5. Minimum of the right side for the next rank - O(n): Everything
+ *    past floor(p) is already ≥ it, so no second selection is needed
+ * 6. Linear interpolation between the two ranks - O(1)
+ *
+ * pct = 50 is the median (mean of the two middle values for even n).
+ *
+ * Overall: O(n) expected
+ */
+bool registry_average_percentile(StudentRegistry *r, float pct, float *out)
+{
+    registry_compact_students(r);
+    if (r->students_size == 0)
+        return false;
+    if (pct < 0.0f)
+        pct = 0.0f;
+    if (pct > 100.0f)
+        pct = 100.0f;
+    int n = r->students_size;
+    float *v = malloc((size_t)n * sizeof(float));
+    if (!v)
+    {
+        fprintf(stderr, "Memory allocation failed in selection query.\n");
+        return false;
+    }
+    memcpy(v, r->col_avg, (size_t)n * sizeof(float));
+    double pos = (double)pct / 100.0 * (n - 1);
+    int k = (int)pos;
+    introselect(v, n, k);
+    float result = v[k];
+    if (k + 1 < n)
+    {
+        float next = v[k + 1];
+        for (int i = k + 2; i < n; ++i)
+            if (v[i] < next)
+                next = v[i];
+        result += (float)(pos - k) * (next - result);
+    }
+    *out = result;
+    free(v);
+    return true;
+}
+
+/**
+ * registry_grade_histogram - Distribution of every grade in r
+ *
+ * Time Complexity: O(1); O(n + G) on the first query after unread
+ *                  mapped grades were added
+ * Space Complexity: O(1) - points at the registry's own buckets
+ *
+ * Complexity Analysis:
+ * 1. grade_hist_recount() only while the histogram is stale - O(n + G)
+ * 2. Return the buckets - O(1): Kept current by every add, grade
+ *    append and delete, so no pass over the students
+ *
+ * Overall: O(1) amortized
+ */
+const Histogram *registry_grade_histogram(StudentRegistry *r)
+{
+    if (r->grade_hist_stale)
+        grade_hist_recount(r);
+    return &r->grade_hist;
+}
+
+/**
+ * registry_average_histogram - Distribution of every student's average in r
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1) - points at the registry's own buckets
+ *
+ * Ungraded students count at 0, as in the average column.
+ *
+ * Overall: O(1)
+ */
+const Histogram *registry_average_histogram(StudentRegistry *r)
+{
+    return &r->avg_hist;
+}
+
+/**
+ * registry_students_count - Get the current number of live students
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no extra space
+ *
+ * Complexity Analysis:
+ * 1. Slots minus tombstones - O(1)
+ *
+ * Overall: O(1) - simple accessor
+ */
+/* Accessors */
+int registry_students_count(StudentRegistry *r) { return r->students_size - r->students_dead; }
+
+/**
+ * registry_student_slots - Get the number of slots, tombstones included
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no extra space
+ *
+ * Loops over get_student_by_index() run to this bound and skip NULL.
+ *
+ * Overall: O(1) - simple accessor
+ */
+int registry_student_slots(StudentRegistry *r) { return r->students_size; }
+
+/**
+ * registry_get_student_by_index - Get pointer to student at given index
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - no extra space
+ *
+ * Complexity Analysis:
+ * 1. Bounds check - O(1): Two comparisons
+ * 2. Array access - O(1): Direct indexing
+ * 3. Return address, or NULL for a tombstone - O(1)
+ *
+ * Overall: O(1) - direct array access
+ */
+Student *registry_get_student_by_index(StudentRegistry *r, int idx)
+{
+    if (idx < 0 || idx >= r->students_size || r->students[idx].dead)
+        return NULL;
+    return &r->students[idx];
+}
+
+/**
+ * registry_student_name - A live student's name in r's arena
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * The pointer is valid until the next add, rename or delete on r.
+ *
+ * Overall: O(1)
+ */
+const char *registry_student_name(StudentRegistry *r, const Student *s)
+{
+    return r->arena + s->cold->name_off;
+}
+
+/**
+ * registry_name_arena - The name arena as a byte block
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1) - points at the registry's own buffer
+ *
+ * Overall: O(1) - NULL when no name was ever stored
+ */
+const char *registry_name_arena(StudentRegistry *r, uint32_t *used, uint32_t *garbage)
+{
+    *used = r->arena_used;
+    *garbage = r->arena_garbage;
+    return r->arena;
+}
+
+/**
+ * registry_student_id_column - Contiguous view of every student's ID
+ *
+ * Time Complexity: O(1), O(n) when tombstones must be compacted first
+ * Space Complexity: O(1) - no extra space
+ *
+ * Element i mirrors get_student_by_index(i)->id. The pointer is
+ * invalidated by the next insertion or delete.
+ *
+ * Overall: O(1) amortized
+ */
+const int *registry_student_id_column(StudentRegistry *r)
+{
+    registry_compact_students(r);
+    return r->col_id;
+}
+
+/**
+ * registry_student_average_column - Contiguous view of every student's average
+ *
+ * Time Complexity: O(1), O(n) when tombstones must be compacted first
+ * Space Complexity: O(1) - no extra space
+ *
+ * Element i mirrors get_student_by_index(i)->average.
+ *
+ * Overall: O(1) amortized
+ */
+const float *registry_student_average_column(StudentRegistry *r)
+{
+    registry_compact_students(r);
+    return r->col_avg;
+}
+
+/**
+ * registry_student_grade_count_column - Contiguous view of every student's grade count
+ *
+ * Time Complexity: O(1), O(n) when tombstones must be compacted first
+ * Space Complexity: O(1) - no extra space
+ *
+ * Element i mirrors get_student_by_index(i)->gradeCount.
+ *
+ * Overall: O(1) amortized
+ */
+const int *registry_student_grade_count_column(StudentRegistry *r)
+{
+    registry_compact_students(r);
+    return r->col_grade_count;
+}
+
+/* Default-instance API: each function is its registry_ counterpart on
+ * default_registry(), with the same complexity. */
+
+/**
+ * init_students - registry_init() on the default registry
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void init_students(void) { registry_init(&default_instance); }
+
+/**
+ * free_students - registry_free() on the default registry
+ *
+ * Time Complexity: O(n)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(n)
+ */
+void free_students(void) { registry_free(&default_instance); }
+
+/**
+ * set_grade_pool_enabled - registry_set_grade_pool_enabled() on the default registry
+ *
+ * Time Complexity: see registry_set_grade_pool_enabled()
+ * Space Complexity: see registry_set_grade_pool_enabled()
+ *
+ * Overall: same as registry_set_grade_pool_enabled()
+ */
+void set_grade_pool_enabled(bool enabled)
+{
+    registry_set_grade_pool_enabled(&default_instance, enabled);
+}
+
+/**
+ * add_student - registry_add_student() on the default registry
+ *
+ * Time Complexity: see registry_add_student()
+ * Space Complexity: see registry_add_student()
+ *
+ * Overall: same as registry_add_student()
+ */
+bool add_student(int id, const char *name)
+{
+    return registry_add_student(&default_instance, id, name);
+}
+
+/**
+ * add_student_with_grades - registry_add_student_with_grades() on the default registry
+ *
+ * Time Complexity: see registry_add_student_with_grades()
+ * Space Complexity: see registry_add_student_with_grades()
+ *
+ * Overall: same as registry_add_student_with_grades()
+ */
+bool add_student_with_grades(int id, const char *name, const float *grades, int count)
+{
+    return registry_add_student_with_grades(&default_instance, id, name, grades, count);
+}
+
+/**
+ * add_student_with_grade_values - registry_add_student_with_grade_values() on the default registry
+ *
+ * Time Complexity: see registry_add_student_with_grade_values()
+ * Space Complexity: see registry_add_student_with_grade_values()
+ *
+ * Overall: same as registry_add_student_with_grade_values()
+ */
+bool add_student_with_grade_values(int id, const char *name, const GradeValue *grades, int count)
+{
+    return registry_add_student_with_grade_values(&default_instance, id, name, grades, count);
+}
+
+/**
+ * add_student_with_mapped_grades - registry_add_student_with_mapped_grades() on the default registry
+ *
+ * Time Complexity: see registry_add_student_with_mapped_grades()
+ * Space Complexity: see registry_add_student_with_mapped_grades()
+ *
+ * Overall: same as registry_add_student_with_mapped_grades()
+ */
+bool add_student_with_mapped_grades(int id, const char *name, const GradeValue *grades, int count, float average)
+{
+    return registry_add_student_with_mapped_grades(&default_instance, id, name, grades, count, average);
+}
+
+/**
+ * adopt_grade_mapping - registry_adopt_grade_mapping() on the default registry
+ *
+ * Time Complexity: see registry_adopt_grade_mapping()
+ * Space Complexity: see registry_adopt_grade_mapping()
+ *
+ * Overall: same as registry_adopt_grade_mapping()
+ */
+void adopt_grade_mapping(void *base, size_t size, void (*release)(void *base, size_t size))
+{
+    registry_adopt_grade_mapping(&default_instance, base, size, release);
+}
+
+/**
+ * reserve_students - registry_reserve_students() on the default registry
+ *
+ * Time Complexity: see registry_reserve_students()
+ * Space Complexity: see registry_reserve_students()
+ *
+ * Overall: same as registry_reserve_students()
+ */
+void reserve_students(int count)
+{
+    registry_reserve_students(&default_instance, count);
+}
+
+/**
+ * delete_student - registry_delete_student() on the default registry
+ *
+ * Time Complexity: see registry_delete_student()
+ * Space Complexity: see registry_delete_student()
+ *
+ * Overall: same as registry_delete_student()
+ */
+bool delete_student(int id)
+{
+    return registry_delete_student(&default_instance, id);
+}
+
+/**
+ * compact_students - registry_compact_students() on the default registry
+ *
+ * Time Complexity: see registry_compact_students()
+ * Space Complexity: see registry_compact_students()
+ *
+ * Overall: same as registry_compact_students()
+ */
+void compact_students(void)
+{
+    registry_compact_students(&default_instance);
+}
+
+/**
+ * shrink_students_to_fit - registry_shrink_students_to_fit() on the default registry
+ *
+ * Time Complexity: see registry_shrink_students_to_fit()
+ * Space Complexity: see registry_shrink_students_to_fit()
+ *
+ * Overall: same as registry_shrink_students_to_fit()
+ */
+void shrink_students_to_fit(void)
+{
+    registry_shrink_students_to_fit(&default_instance);
+}
+
+/**
+ * update_student_name - registry_update_student_name() on the default registry
+ *
+ * Time Complexity: see registry_update_student_name()
+ * Space Complexity: see registry_update_student_name()
+ *
+ * Overall: same as registry_update_student_name()
+ */
+bool update_student_name(int id, const char *newname)
+{
+    return registry_update_student_name(&default_instance, id, newname);
+}
+
+/**
+ * add_grade_to_student - registry_add_grade_to_student() on the default registry
+ *
+ * Time Complexity: see registry_add_grade_to_student()
+ * Space Complexity: see registry_add_grade_to_student()
+ *
+ * Overall: same as registry_add_grade_to_student()
+ */
+bool add_grade_to_student(int id, float grade)
+{
+    return registry_add_grade_to_student(&default_instance, id, grade);
+}
+
+/**
+ * add_grades_to_student - registry_add_grades_to_student() on the default registry
+ *
+ * Time Complexity: see registry_add_grades_to_student()
+ * Space Complexity: see registry_add_grades_to_student()
+ *
+ * Overall: same as registry_add_grades_to_student()
+ */
+bool add_grades_to_student(int id, const float *grades, int count)
+{
+    return registry_add_grades_to_student(&default_instance, id, grades, count);
+}
+
+/**
+ * recalc_average - registry_recalc_average() on the default registry
+ *
+ * Time Complexity: see registry_recalc_average()
+ * Space Complexity: see registry_recalc_average()
+ *
+ * Overall: same as registry_recalc_average()
+ */
+void recalc_average(Student *s)
+{
+    registry_recalc_average(&default_instance, s);
+}
+
+/**
+ * verify_averages - registry_verify_averages() on the default registry
+ *
+ * Time Complexity: see registry_verify_averages()
+ * Space Complexity: see registry_verify_averages()
+ *
+ * Overall: same as registry_verify_averages()
+ */
+int verify_averages(void)
+{
+    return registry_verify_averages(&default_instance);
+}
+
+/**
+ * display_all_students - registry_display_all_students() on the default registry
+ *
+ * Time Complexity: see registry_display_all_students()
+ * Space Complexity: see registry_display_all_students()
+ *
+ * Overall: same as registry_display_all_students()
+ */
+void display_all_students(void)
+{
+    registry_display_all_students(&default_instance);
+}
+
+/**
+ * display_grade_matrix - registry_display_grade_matrix() on the default registry
+ *
+ * Time Complexity: see registry_display_grade_matrix()
+ * Space Complexity: see registry_display_grade_matrix()
+ *
+ * Overall: same as registry_display_grade_matrix()
+ */
+void display_grade_matrix(void)
+{
+    registry_display_grade_matrix(&default_instance);
+}
+
+/**
+ * display_students_page - registry_display_students_page() on the default registry
+ *
+ * Time Complexity: see registry_display_students_page()
+ * Space Complexity: see registry_display_students_page()
+ *
+ * Overall: same as registry_display_students_page()
+ */
+void display_students_page(int first, int count)
+{
+    registry_display_students_page(&default_instance, first, count);
+}
+
+/**
+ * display_grade_matrix_page - registry_display_grade_matrix_page() on the default registry
+ *
+ * Time Complexity: see registry_display_grade_matrix_page()
+ * Space Complexity: see registry_display_grade_matrix_page()
+ *
+ * Overall: same as registry_display_grade_matrix_page()
+ */
+void display_grade_matrix_page(int first, int count)
+{
+    registry_display_grade_matrix_page(&default_instance, first, count);
+}
+
+/**
+ * sort_students - registry_sort_students() on the default registry
+ *
+ * Time Complexity: see registry_sort_students()
+ * Space Complexity: see registry_sort_students()
+ *
+ * Overall: same as registry_sort_students()
+ */
+void sort_students(SortMethod method, SortKey key)
+{
+    registry_sort_students(&default_instance, method, key);
+}
+
+/**
+ * binary_search_by_id_recursive - registry_binary_search_by_id_recursive() on the default registry
+ *
+ * Time Complexity: see registry_binary_search_by_id_recursive()
+ * Space Complexity: see registry_binary_search_by_id_recursive()
+ *
+ * Overall: same as registry_binary_search_by_id_recursive()
+ */
+int binary_search_by_id_recursive(int target_id, int left, int right)
+{
+    return registry_binary_search_by_id_recursive(&default_instance, target_id, left, right);
+}
+
+/**
+ * find_student_index - registry_find_student_index() on the default registry
+ *
+ * Time Complexity: see registry_find_student_index()
+ * Space Complexity: see registry_find_student_index()
+ *
+ * Overall: same as registry_find_student_index()
+ */
+int find_student_index(int id)
+{
+    return registry_find_student_index(&default_instance, id);
+}
+
+/**
+ * search_by_name_prefix - registry_search_by_name_prefix() on the default registry
+ *
+ * Time Complexity: see registry_search_by_name_prefix()
+ * Space Complexity: see registry_search_by_name_prefix()
+ *
+ * Overall: same as registry_search_by_name_prefix()
+ */
+int search_by_name_prefix(const char *prefix, int *ids, int max)
+{
+    return registry_search_by_name_prefix(&default_instance, prefix, ids, max);
+}
+
+/**
+ * student_reads_ready - registry_reads_ready() on the default registry
+ *
+ * Time Complexity: see registry_reads_ready()
+ * Space Complexity: see registry_reads_ready()
+ *
+ * Overall: same as registry_reads_ready()
+ */
+bool student_reads_ready(void)
+{
+    return registry_reads_ready(&default_instance);
+}
+
+/**
+ * prepare_student_reads - registry_prepare_reads() on the default registry
+ *
+ * Time Complexity: see registry_prepare_reads()
+ * Space Complexity: see registry_prepare_reads()
+ *
+ * Overall: same as registry_prepare_reads()
+ */
+void prepare_student_reads(void)
+{
+    registry_prepare_reads(&default_instance);
+}
+
+/**
+ * top_k_by_average - registry_top_k_by_average() on the default registry
+ *
+ * Time Complexity: see registry_top_k_by_average()
+ * Space Complexity: see registry_top_k_by_average()
+ *
+ * Overall: same as registry_top_k_by_average()
+ */
+int top_k_by_average(int k, int *out)
+{
+    return registry_top_k_by_average(&default_instance, k, out);
+}
+
+/**
+ * bottom_k_by_average - registry_bottom_k_by_average() on the default registry
+ *
+ * Time Complexity: see registry_bottom_k_by_average()
+ * Space Complexity: see registry_bottom_k_by_average()
+ *
+ * Overall: same as registry_bottom_k_by_average()
+ */
+int bottom_k_by_average(int k, int *out)
+{
+    return registry_bottom_k_by_average(&default_instance, k, out);
+}
+
+/**
+ * kth_smallest_average - registry_kth_smallest_average() on the default registry
+ *
+ * Time Complexity: see registry_kth_smallest_average()
+ * Space Complexity: see registry_kth_smallest_average()
+ *
+ * Overall: same as registry_kth_smallest_average()
+ */
+bool kth_smallest_average(int k, float *out)
+{
+    return registry_kth_smallest_average(&default_instance, k, out);
+}
+
+/**
+ * average_percentile - registry_average_percentile() on the default registry
+ *
+ * Time Complexity: see registry_average_percentile()
+ * Space Complexity: see registry_average_percentile()
+ *
+ * Overall: same as registry_average_percentile()
+ */
+bool average_percentile(float pct, float *out)
+{
+    return registry_average_percentile(&default_instance, pct, out);
+}
+
+/**
+ * grade_histogram - registry_grade_histogram() on the default registry
+ *
+ * Time Complexity: see registry_grade_histogram()
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1) amortized
+ */
+const Histogram *grade_histogram(void)
+{
+    return registry_grade_histogram(&default_instance);
+}
+
+/**
+ * average_histogram - registry_average_histogram() on the default registry
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+const Histogram *average_histogram(void)
+{
+    return registry_average_histogram(&default_instance);
+}
+
+/**
+ * students_count - registry_students_count() on the default registry
+ *
+ * Time Complexity: see registry_students_count()
+ * Space Complexity: see registry_students_count()
+ *
+ * Overall: same as registry_students_count()
+ */
+int students_count(void)
+{
+    return registry_students_count(&default_instance);
+}
+
+/**
+ * student_slots - registry_student_slots() on the default registry
+ *
+ * Time Complexity: see registry_student_slots()
+ * Space Complexity: see registry_student_slots()
+ *
+ * Overall: same as registry_student_slots()
+ */
+int student_slots(void)
+{
+    return registry_student_slots(&default_instance);
+}
+
+/**
+ * get_student_by_index - registry_get_student_by_index() on the default registry
+ *
+ * Time Complexity: see registry_get_student_by_index()
+ * Space Complexity: see registry_get_student_by_index()
+ *
+ * Overall: same as registry_get_student_by_index()
+ */
+Student *get_student_by_index(int idx)
+{
+    return registry_get_student_by_index(&default_instance, idx);
+}
+
+/**
+ * student_name - registry_student_name() on the default registry
+ *
+ * Time Complexity: O(1)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+const char *student_name(const Student *s)
+{
+    return registry_student_name(&default_instance, s);
+}
+
+/**
+ * student_id_column - registry_student_id_column() on the default registry
+ *
+ * Time Complexity: see registry_student_id_column()
+ * Space Complexity: see registry_student_id_column()
+ *
+ * Overall: same as registry_student_id_column()
+ */
+const int *student_id_column(void)
+{
+    return registry_student_id_column(&default_instance);
+}
+
+/**
+ * student_average_column - registry_student_average_column() on the default registry
+ *
+ * Time Complexity: see registry_student_average_column()
+ * Space Complexity: see registry_student_average_column()
+ *
+ * Overall: same as registry_student_average_column()
+ */
+const float *student_average_column(void)
+{
+    return registry_student_average_column(&default_instance);
+}
+
+/**
+ * student_grade_count_column - registry_student_grade_count_column() on the default registry
+ *
+ * Time Complexity: see registry_student_grade_count_column()
+ * Space Complexity: see registry_student_grade_count_column()
+ *
+ * Overall: same as registry_student_grade_count_column()
+ */
+const int *student_grade_count_column(void)
+{
+    return registry_student_grade_count_column(&default_instance);
 }
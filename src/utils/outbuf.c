@@ -0,0 +1,244 @@
+#include "outbuf.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * ob_init - Start an empty buffer, optionally bound to a FILE
+ *
+ * Time Complexity: O(1) - constant time
+ * Space Complexity: O(1) - storage is allocated on first write
+ *
+ * Overall: O(1)
+ */
+void ob_init(OutBuf *b, FILE *fp)
+{
+    b->fp = fp;
+    b->data = NULL;
+    b->len = b->cap = 0;
+    b->failed = false;
+}
+
+/**
+ * ob_flush - Hand buffered bytes to the bound FILE
+ *
+ * Time Complexity: O(len) - one fwrite()
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. No FILE or nothing buffered - O(1)
+ * 2. fwrite() the whole buffer - O(len)
+ *
+ * Overall: O(len)
+ */
+bool ob_flush(OutBuf *b)
+{
+    if (b->fp && b->len > 0)
+    {
+        if (fwrite(b->data, 1, b->len, b->fp) != b->len)
+            b->failed = true;
+        b->len = 0;
+    }
+    return !b->failed;
+}
+
+/**
+ * ob_finish - Flush and release the buffer
+ *
+ * Time Complexity: O(len)
+ * Space Complexity: O(1)
+ *
+ * Returns false if any allocation or write failed along the way.
+ * Does not close the FILE.
+ *
+ * Overall: O(len)
+ */
+bool ob_finish(OutBuf *b)
+{
+    bool ok = ob_flush(b);
+    free(b->data);
+    b->data = NULL;
+    b->len = b->cap = 0;
+    return ok;
+}
+
+/**
+ * ob_reserve - Make room for n more bytes
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(len + n)
+ *
+ * Complexity Analysis:
+ * 1. Bound buffer past OUTBUF_FLUSH_SIZE - ob_flush() first
+ * 2. Grow geometrically when still short - amortized O(1)
+ *
+ * Returns NULL (and marks the buffer failed) if memory runs out.
+ *
+ * Overall: O(1) amortized
+ */
+static char *ob_reserve(OutBuf *b, size_t n)
+{
+    if (b->fp && b->len + n > OUTBUF_FLUSH_SIZE)
+        ob_flush(b);
+    if (b->len + n > b->cap)
+    {
+        size_t newcap = b->cap ? b->cap : (b->fp ? OUTBUF_FLUSH_SIZE : 256);
+        while (newcap < b->len + n)
+            newcap *= 2;
+        char *tmp = realloc(b->data, newcap);
+        if (!tmp)
+        {
+            b->failed = true;
+            return NULL;
+        }
+        b->data = tmp;
+        b->cap = newcap;
+    }
+    return b->data + b->len;
+}
+
+/**
+ * ob_write - Append n raw bytes
+ *
+ * Time Complexity: O(n) amortized
+ * Space Complexity: O(n)
+ *
+ * Overall: O(n)
+ */
+void ob_write(OutBuf *b, const void *src, size_t n)
+{
+    char *out = ob_reserve(b, n);
+    if (!out)
+        return;
+    memcpy(out, src, n);
+    b->len += n;
+}
+
+/**
+ * ob_puts - Append a NUL-terminated string (no newline added)
+ *
+ * Time Complexity: O(k) where k is string length
+ * Space Complexity: O(k)
+ *
+ * Overall: O(k)
+ */
+void ob_puts(OutBuf *b, const char *s)
+{
+    ob_write(b, s, strlen(s));
+}
+
+/**
+ * ob_putc - Append one byte
+ *
+ * Time Complexity: O(1) amortized
+ * Space Complexity: O(1)
+ *
+ * Overall: O(1)
+ */
+void ob_putc(OutBuf *b, char c)
+{
+    char *out = ob_reserve(b, 1);
+    if (!out)
+        return;
+    *out = c;
+    b->len++;
+}
+
+/**
+ * ob_pad - Append s left-aligned in a field of width bytes, like "%-*s"
+ *
+ * Time Complexity: O(k + width)
+ * Space Complexity: O(k + width)
+ *
+ * Overall: O(k + width)
+ */
+void ob_pad(OutBuf *b, const char *s, int width)
+{
+    size_t n = strlen(s);
+    ob_write(b, s, n);
+    for (size_t i = n; i < (size_t)(width > 0 ? width : 0); ++i)
+        ob_putc(b, ' ');
+}
+
+/**
+ * ob_uint - Append an unsigned decimal integer
+ *
+ * Time Complexity: O(d) where d ≤ 20 digits
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Emit digits backwards into a stack buffer - O(d)
+ * 2. One ob_write() - O(d)
+ *
+ * Overall: O(d)
+ */
+void ob_uint(OutBuf *b, unsigned long long v)
+{
+    char tmp[20];
+    int i = (int)sizeof(tmp);
+    do
+    {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    ob_write(b, tmp + i, sizeof(tmp) - (size_t)i);
+}
+
+/**
+ * ob_int - Append a signed decimal integer
+ *
+ * Time Complexity: O(d)
+ * Space Complexity: O(1)
+ *
+ * Overall: O(d)
+ */
+void ob_int(OutBuf *b, long long v)
+{
+    if (v < 0)
+    {
+        ob_putc(b, '-');
+        ob_uint(b, 0ull - (unsigned long long)v);
+    }
+    else
+        ob_uint(b, (unsigned long long)v);
+}
+
+/**
+ * ob_fixed2 - Append v with exactly two decimals, same digits as "%.2f"
+ *
+ * Time Complexity: O(d)
+ * Space Complexity: O(1)
+ *
+ * Complexity Analysis:
+ * 1. Scale by 100 - O(1): Exact in double for any float input
+ * 2. Split into floor and remainder - O(1): Remainder is exact, so
+ *    ties are detected exactly and rounded to even like printf
+ * 3. ob_uint() integer part + two digits - O(d)
+ *
+ * Values too large for the integer path, NaN and infinities fall back
+ * to snprintf().
+ *
+ * Overall: O(d)
+ */
+void ob_fixed2(OutBuf *b, double v)
+{
+    if (!(fabs(v) < 1e15))
+    {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.2f", v);
+        ob_write(b, tmp, n > 0 ? (size_t)n : 0);
+        return;
+    }
+    bool neg = signbit(v);
+    double x = fabs(v) * 100.0;
+    double whole = floor(x);
+    double rem = x - whole;
+    unsigned long long h = (unsigned long long)whole;
+    if (rem > 0.5 || (rem == 0.5 && (h & 1)))
+        h++;
+    if (neg)
+        ob_putc(b, '-');
+    ob_uint(b, h / 100);
+    char frac[3] = {'.', (char)('0' + h / 10 % 10), (char)('0' + h % 10)};
+    ob_write(b, frac, sizeof(frac));
+}